@@ -4,6 +4,7 @@ import QtQuick.Controls 2.15
 import QtQuick.Controls.Material 2.0
 import Qt.labs.settings 1.0
 import QtWebView 1.1
+import QtWebSockets 1.1
 
 ColumnLayout {
     signal popupclose()
@@ -12,12 +13,52 @@ ColumnLayout {
     anchors.fill: parent
     Settings {
         id: settings
+        property string studio_gateway_url: ""
     }
+
+    // in a studio the leaderboard comes from the local gateway, ws://<gateway>:4890
+    property bool studioLeaderboard: settings.studio_gateway_url.length > 0
+
+    WebSocket {
+        id: leaderboardSocket
+        url: settings.studio_gateway_url
+        active: studioLeaderboard
+        onTextMessageReceived: {
+            var m = JSON.parse(message);
+            if (m.msg === "leaderboard")
+                leaderboardView.model = m.content;
+        }
+        onStatusChanged: {
+            if (status === WebSocket.Error)
+                console.error(errorString);
+        }
+    }
+
+    ListView {
+        id: leaderboardView
+        visible: studioLeaderboard
+        Layout.fillWidth: true
+        Layout.fillHeight: true
+        clip: true
+        delegate: RowLayout {
+            width: leaderboardView.width
+            spacing: 10
+            Label {
+                text: (index + 1) + ". " + modelData.name
+                font.bold: index === 0
+                Layout.fillWidth: true
+            }
+            Label { text: modelData.connected ? Math.round(modelData.watt) + " W" : "-" }
+            Label { text: modelData.connected ? Math.round(modelData.kj) + " kJ" : "" }
+            Label { text: modelData.connected ? Math.round(modelData.heart) + " bpm" : "" }
+        }
+    }
+
     WebView {
         id: webView
         anchors.fill: parent
-        url: "http://80.211.67.253:3001/qz-classifica"
-        visible: true
+        url: studioLeaderboard ? "about:blank" : "http://80.211.67.253:3001/qz-classifica"
+        visible: !studioLeaderboard
         onLoadingChanged: {
             if (loadRequest.errorString)
                 console.error(loadRequest.errorString);
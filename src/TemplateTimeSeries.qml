@@ -0,0 +1,64 @@
+import QtQuick 2.12
+import QtQuick.Layouts 1.3
+import QtQuick.Controls 2.15
+import QtQuick.Controls.Material 2.0
+import Qt.labs.settings 1.0
+
+ColumnLayout {
+    id: rootElement
+    property string templateId: ""
+    property Settings settings
+
+    TemplateTcpClient {
+        templateId: rootElement.templateId
+        settings: rootElement.settings
+        Layout.fillWidth: true
+    }
+    RowLayout {
+        spacing: 10
+        Label {
+            text: qsTr(rootElement.templateId + " Format:")
+            Layout.fillWidth: true
+        }
+        ComboBox {
+            id: comboTimeSeriesFormat
+            model: [ "influx", "ndjson" ]
+            displayText: settings.value("template_"+rootElement.templateId+"_format", "influx")
+            Layout.alignment: Qt.AlignRight | Qt.AlignVCenter
+            onActivated: {
+                console.log("Saving format for "+rootElement.templateId + " "+ currentValue);
+                settings.setValue("template_"+rootElement.templateId+"_format", currentValue);
+                displayText = currentValue;
+            }
+        }
+    }
+    RowLayout {
+        spacing: 10
+        id: batchRow
+        Label {
+            text: qsTr(rootElement.templateId + " Samples per write:")
+            Layout.fillWidth: true
+        }
+        function doSaveBatch(text) {
+            let batch = parseInt(text);
+            console.log("Saving batch for "+rootElement.templateId + " "+ text + " converted "+batch);
+            if (!isNaN(batch) && batch > 0)
+                settings.setValue("template_"+rootElement.templateId+"_batch", batch);
+        }
+
+        TextField {
+            id: textTimeSeriesBatch
+            text: settings.value("template_"+rootElement.templateId+"_batch",10) + "";
+            horizontalAlignment: Text.AlignRight
+            Layout.fillHeight: false
+            Layout.alignment: Qt.AlignRight | Qt.AlignVCenter
+            inputMethodHints: Qt.ImhDigitsOnly
+            onAccepted: batchRow.doSaveBatch(text)
+        }
+        Button {
+            text: "OK"
+            Layout.alignment: Qt.AlignRight | Qt.AlignVCenter
+            onClicked: batchRow.doSaveBatch(textTimeSeriesBatch.text)
+        }
+    }
+}
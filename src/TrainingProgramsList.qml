@@ -1,5 +1,4 @@
 import QtQuick 2.7
-import Qt.labs.folderlistmodel 2.15
 import QtQuick.Layouts 1.3
 import QtQuick.Controls 2.15
 import QtQuick.Controls.Material 2.0
@@ -22,6 +21,23 @@ ColumnLayout {
         }
     }
 
+    RowLayout {
+        Label {
+            text: qsTr("Sort by")
+        }
+        ComboBox {
+            id: sortBy
+            property var keys: ["name", "duration", "tss", "intensity", "distance"]
+            model: [qsTr("Name"), qsTr("Duration"), qsTr("TSS"), qsTr("Intensity"), qsTr("Distance")]
+            onActivated: list.reload()
+        }
+        BusyIndicator {
+            running: workoutLibrary.indexing
+            visible: running
+            Layout.preferredHeight: sortBy.height
+        }
+    }
+
     AccordionElement {
         title: qsTr("Application Training folder")
         indicatRectColor: Material.color(Material.Grey)
@@ -31,26 +47,62 @@ ColumnLayout {
             ListView {
                 id: list
                 anchors.fill: parent
-                FolderListModel {
-                    id: folderModel
-                    nameFilters: ["*.xml", "*.zwo"]
-                    folder: "file://" + rootItem.getWritableAppDir() + 'training'
-                    showDotAndDotDot: false
-                    showDirs: true
+                // the workouts come from the index, parsed once in background
+                function reload() {
+                    model = workoutLibrary.workouts(sortBy.keys[sortBy.currentIndex], sortBy.currentIndex > 0)
+                }
+                function duration(seconds) {
+                    var h = Math.floor(seconds / 3600)
+                    var m = Math.floor(seconds / 60) % 60
+                    var s = seconds % 60
+                    return h + ":" + (m < 10 ? "0" : "") + m + ":" + (s < 10 ? "0" : "") + s
+                }
+                Component.onCompleted: reload()
+                Connections {
+                    target: workoutLibrary
+                    function onWorkoutsChanged() { list.reload() }
                 }
-                model: folderModel
                 delegate: Component {
                     Rectangle {
                         property alias textColor: fileTextBox.color
                         width: parent.width
-                        height: 40
+                        height: 60
                         color: Material.backgroundColor
                         z: 1
                         Text {
                             id: fileTextBox
                             color: Material.color(Material.Grey)
                             font.pixelSize: Qt.application.font.pixelSize * 1.6
-                            text: fileName.substring(0, fileName.length-4)
+                            text: modelData.name
+                        }
+                        Text {
+                            id: detailsTextBox
+                            anchors.top: fileTextBox.bottom
+                            color: Material.color(Material.Grey)
+                            font.pixelSize: Qt.application.font.pixelSize
+                            text: list.duration(modelData.duration) +
+                                  (modelData.distance > 0 ? " " + modelData.distance.toFixed(1) + " km" : "") +
+                                  (modelData.tss >= 0 ? " TSS " + Math.round(modelData.tss) +
+                                                        " IF " + modelData.intensity.toFixed(2) : "")
+                        }
+                        Row {
+                            id: profile
+                            anchors.right: parent.right
+                            anchors.bottom: parent.bottom
+                            height: parent.height - 10
+                            width: parent.width * 0.3
+                            property real peak: Math.max.apply(null, modelData.profile.concat([modelData.power ? 1.2 : 0.1]))
+                            Repeater {
+                                id: bars
+                                model: modelData.profile
+                                Rectangle {
+                                    anchors.bottom: parent.bottom
+                                    width: profile.width / bars.count
+                                    height: profile.height * modelData / profile.peak
+                                    color: Material.color(Material.Green)
+                                    opacity: 0.6
+                                }
+                            }
                         }
                         MouseArea {
                             anchors.fill: parent
@@ -58,7 +110,7 @@ ColumnLayout {
                             onClicked: {
                                 console.log('onclicked ' + index+ " count "+list.count);
                                 if (index == list.currentIndex) {
-                                    let fileUrl = folderModel.get(list.currentIndex, 'fileUrl') || folderModel.get(list.currentIndex, 'fileURL');
+                                    let fileUrl = list.model[list.currentIndex].url;
                                     if (fileUrl) {
                                         trainprogram_open_clicked(fileUrl);
                                         popup.open()
@@ -87,7 +139,7 @@ ColumnLayout {
                 }
                 focus: true
                 onCurrentItemChanged: {
-                    let fileUrl = folderModel.get(list.currentIndex, 'fileUrl') || folderModel.get(list.currentIndex, 'fileURL');
+                    let fileUrl = list.currentIndex >= 0 && list.model[list.currentIndex] ? list.model[list.currentIndex].url : undefined;
                     if (fileUrl) {
                         list.currentItem.textColor = Material.color(Material.Yellow)
                         console.log(fileUrl + ' selected');
@@ -0,0 +1,384 @@
+#include "activitystore.h"
+#include "appdir.h"
+#include "qdebugfixup.h"
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+
+activitystore *activitystore::instance() {
+    static activitystore *store = nullptr;
+    if (!store) {
+        store = new activitystore(appdir::getWritableAppDir() + QStringLiteral("activities.sqlite"),
+                                  QCoreApplication::instance());
+    }
+    return store;
+}
+
+activitystore::activitystore(const QString &filename, QObject *parent) : QObject(parent), m_filename(filename) {
+    m_connection = QStringLiteral("activitystore");
+    worker = new QObject();
+    worker->moveToThread(&thread);
+    connect(&thread, &QThread::finished, worker, &QObject::deleteLater);
+    thread.setObjectName(QStringLiteral("activitystore"));
+    thread.start(QThread::LowPriority);
+    runOnWorker([this]() { open(); }, false);
+}
+
+activitystore::~activitystore() {
+    // the pending additions are processed before closing the database
+    runOnWorker(
+        [this]() {
+            QSqlDatabase::database(m_connection, false).close();
+            QSqlDatabase::removeDatabase(m_connection);
+        },
+        true);
+    thread.quit();
+    thread.wait();
+}
+
+void activitystore::runOnWorker(const std::function<void()> &f, bool wait) {
+    if (QThread::currentThread() == &thread) {
+        f();
+        return;
+    }
+    QMetaObject::invokeMethod(worker, f, wait ? Qt::BlockingQueuedConnection : Qt::QueuedConnection);
+}
+
+bool activitystore::open() {
+    QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), m_connection);
+    db.setDatabaseName(m_filename);
+    if (!db.open()) {
+        qDebug() << QStringLiteral("activitystore: unable to open") << m_filename << db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery q(db);
+    q.exec(QStringLiteral("PRAGMA journal_mode=WAL"));
+    q.exec(QStringLiteral("PRAGMA synchronous=NORMAL"));
+    const QStringList schema = {
+        QStringLiteral("CREATE TABLE IF NOT EXISTS sessions (id INTEGER PRIMARY KEY AUTOINCREMENT, "
+                       "start INTEGER NOT NULL, type INTEGER, duration INTEGER, distance REAL, calories REAL, "
+                       "avg_watt REAL, max_watt INTEGER, avg_heart REAL, max_heart INTEGER, avg_speed REAL, "
+                       "max_speed REAL, avg_cadence REAL, elevation REAL, file TEXT)"),
+        QStringLiteral("CREATE INDEX IF NOT EXISTS sessions_start ON sessions(start)"),
+        QStringLiteral("CREATE TABLE IF NOT EXISTS series (session_id INTEGER PRIMARY KEY, step INTEGER, data BLOB)"),
+        QStringLiteral("CREATE TABLE IF NOT EXISTS bests (session_id INTEGER, duration INTEGER, watt REAL, "
+                       "PRIMARY KEY(session_id, duration))"),
+        QStringLiteral("CREATE INDEX IF NOT EXISTS bests_duration ON bests(duration, watt)"),
+        QStringLiteral("CREATE TABLE IF NOT EXISTS weekly (week INTEGER PRIMARY KEY, sessions INTEGER, "
+                       "duration INTEGER, distance REAL, calories REAL)"),
+        QStringLiteral("CREATE TABLE IF NOT EXISTS records (duration INTEGER PRIMARY KEY, watt REAL, "
+                       "session_id INTEGER, start INTEGER)"),
+    };
+    for (const QString &s : schema) {
+        if (!q.exec(s)) {
+            qDebug() << QStringLiteral("activitystore: schema error") << q.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+void activitystore::addSession(const QList<SessionLine> &session, bluetoothdevice::BLUETOOTH_TYPE type,
+                               const QString &file) {
+    if (session.count() < 2) {
+        return;
+    }
+    runOnWorker(
+        [this, session, type, file]() {
+            qint64 id = insertSession(session, type, file);
+            if (id >= 0) {
+                emit sessionAdded(id);
+            }
+        },
+        false);
+}
+
+qint64 activitystore::insertSession(const QList<SessionLine> &session, bluetoothdevice::BLUETOOTH_TYPE type,
+                                    const QString &file) {
+    QSqlDatabase db = QSqlDatabase::database(m_connection);
+    if (!db.isOpen()) {
+        return -1;
+    }
+
+    const SessionLine &first = session.constFirst();
+    const SessionLine &last = session.constLast();
+    const int n = session.count();
+    double totWatt = 0, totHeart = 0, totSpeed = 0, totCadence = 0, maxSpeed = 0;
+    int maxWatt = 0, maxHeart = 0, heartLines = 0;
+    // the work done up to every line: each line holds its power since the previous one, so the best efforts follow
+    // the elapsed time whatever the rate of the session and its gaps
+    QVector<qint64> elapsed;
+    QVector<double> work;
+    elapsed.reserve(n);
+    work.reserve(n);
+    for (const SessionLine &s : session) {
+        totWatt += s.watt;
+        totSpeed += s.speed;
+        totCadence += s.cadence;
+        maxWatt = qMax(maxWatt, int(s.watt));
+        maxSpeed = qMax(maxSpeed, s.speed);
+        if (s.heart) {
+            totHeart += s.heart;
+            maxHeart = qMax(maxHeart, int(s.heart));
+            heartLines++;
+        }
+        const qint64 t = qMax<qint64>(s.elapsedTime, elapsed.isEmpty() ? 0 : elapsed.constLast());
+        work.append(work.isEmpty() ? 0 : work.constLast() + s.watt * double(t - elapsed.constLast()));
+        elapsed.append(t);
+    }
+
+    const qint64 start = first.time.toSecsSinceEpoch();
+    const int duration = qMax(int(last.elapsedTime), int(first.time.secsTo(last.time)));
+    const double distance = last.distance - first.distance;
+
+    db.transaction();
+    QSqlQuery q(db);
+    // every statement is part of the session: one failing leaves the database as it was
+    auto failed = [&db, &q](const char *what) {
+        qDebug() << QStringLiteral("activitystore:") << what << QStringLiteral("error") << q.lastError().text();
+        db.rollback();
+        return -1;
+    };
+    q.prepare(QStringLiteral("INSERT INTO sessions (start, type, duration, distance, calories, avg_watt, max_watt, "
+                             "avg_heart, max_heart, avg_speed, max_speed, avg_cadence, elevation, file) "
+                             "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"));
+    q.addBindValue(start);
+    q.addBindValue(int(type));
+    q.addBindValue(duration);
+    q.addBindValue(distance);
+    q.addBindValue(last.calories);
+    q.addBindValue(totWatt / n);
+    q.addBindValue(maxWatt);
+    q.addBindValue(heartLines ? totHeart / heartLines : 0.0);
+    q.addBindValue(maxHeart);
+    q.addBindValue(totSpeed / n);
+    q.addBindValue(maxSpeed);
+    q.addBindValue(totCadence / n);
+    q.addBindValue(last.elevationGain);
+    q.addBindValue(file);
+    if (!q.exec()) {
+        return failed("session");
+    }
+    const qint64 id = q.lastInsertId().toLongLong();
+
+    // series: 6 bytes every seriesStep seconds of elapsed time, like the best efforts, compressed. A bucket without
+    // lines (a gap of the session) is zero, so the elapsed time of a bucket is always its index * seriesStep
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out.setByteOrder(QDataStream::LittleEndian);
+    for (int i = 0, bucket = 1; i < n; bucket++) {
+        const qint64 end = elapsed.constFirst() + qint64(bucket) * seriesStep;
+        double w = 0, h = 0, c = 0, s = 0;
+        int count = 0;
+        for (; i < n && elapsed.at(i) < end; i++, count++) {
+            const SessionLine &l = session.at(i);
+            w += l.watt;
+            h += l.heart;
+            c += l.cadence;
+            s += l.speed;
+        }
+        count = qMax(count, 1);
+        out << quint16(qRound(w / count)) << quint8(qRound(h / count)) << quint8(qRound(c / count))
+            << quint16(qRound(s / count * 10.0));
+    }
+    q.prepare(QStringLiteral("INSERT INTO series (session_id, step, data) VALUES (?, ?, ?)"));
+    q.addBindValue(id);
+    q.addBindValue(int(seriesStep));
+    q.addBindValue(qCompress(data));
+    if (!q.exec()) {
+        return failed("series");
+    }
+
+    // best average powers: for every line, the shortest window of at least d seconds ending there
+    for (int d : bestDurations()) {
+        if (elapsed.constLast() - elapsed.constFirst() < d) {
+            break;
+        }
+        double best = 0;
+        for (int i = 0, j = 0; i < n; i++) {
+            while (j + 1 < i && elapsed.at(i) - elapsed.at(j + 1) >= d) {
+                j++;
+            }
+            const qint64 span = elapsed.at(i) - elapsed.at(j);
+            if (span >= d) {
+                best = qMax(best, (work.at(i) - work.at(j)) / span);
+            }
+        }
+        q.prepare(QStringLiteral("INSERT INTO bests (session_id, duration, watt) VALUES (?, ?, ?)"));
+        q.addBindValue(id);
+        q.addBindValue(d);
+        q.addBindValue(best);
+        if (!q.exec()) {
+            return failed("bests");
+        }
+
+        q.prepare(QStringLiteral("INSERT INTO records (duration, watt, session_id, start) VALUES (?, ?, ?, ?) "
+                                 "ON CONFLICT(duration) DO UPDATE SET watt = excluded.watt, "
+                                 "session_id = excluded.session_id, start = excluded.start "
+                                 "WHERE excluded.watt > records.watt"));
+        q.addBindValue(d);
+        q.addBindValue(best);
+        q.addBindValue(id);
+        q.addBindValue(start);
+        if (!q.exec()) {
+            return failed("records");
+        }
+    }
+
+    const QDate day = first.time.date();
+    q.prepare(QStringLiteral("INSERT INTO weekly (week, sessions, duration, distance, calories) VALUES (?, 1, ?, ?, ?) "
+                             "ON CONFLICT(week) DO UPDATE SET sessions = sessions + 1, "
+                             "duration = duration + excluded.duration, distance = distance + excluded.distance, "
+                             "calories = calories + excluded.calories"));
+    q.addBindValue(day.addDays(1 - day.dayOfWeek()).toJulianDay());
+    q.addBindValue(duration);
+    q.addBindValue(distance);
+    q.addBindValue(last.calories);
+    if (!q.exec()) {
+        return failed("weekly");
+    }
+
+    if (!db.commit()) {
+        qDebug() << QStringLiteral("activitystore: commit error") << db.lastError().text();
+        db.rollback();
+        return -1;
+    }
+    qDebug() << QStringLiteral("activitystore: session added") << id;
+    return id;
+}
+
+QVariantList activitystore::sessions(const QDateTime &from, const QDateTime &to) {
+    QVariantList list;
+    runOnWorker(
+        [&]() {
+            QSqlQuery q(QSqlDatabase::database(m_connection));
+            q.prepare(QStringLiteral("SELECT id, start, type, duration, distance, calories, avg_watt, max_watt, "
+                                     "avg_heart, max_heart, avg_speed, max_speed, avg_cadence, elevation, file "
+                                     "FROM sessions WHERE start BETWEEN ? AND ? ORDER BY start DESC"));
+            q.addBindValue(from.toSecsSinceEpoch());
+            q.addBindValue(to.toSecsSinceEpoch());
+            if (!q.exec()) {
+                return;
+            }
+            while (q.next()) {
+                QVariantMap m;
+                m[QStringLiteral("id")] = q.value(0);
+                m[QStringLiteral("start")] = QDateTime::fromSecsSinceEpoch(q.value(1).toLongLong());
+                m[QStringLiteral("type")] = q.value(2);
+                m[QStringLiteral("duration")] = q.value(3);
+                m[QStringLiteral("distance")] = q.value(4);
+                m[QStringLiteral("calories")] = q.value(5);
+                m[QStringLiteral("avg_watt")] = q.value(6);
+                m[QStringLiteral("max_watt")] = q.value(7);
+                m[QStringLiteral("avg_heart")] = q.value(8);
+                m[QStringLiteral("max_heart")] = q.value(9);
+                m[QStringLiteral("avg_speed")] = q.value(10);
+                m[QStringLiteral("max_speed")] = q.value(11);
+                m[QStringLiteral("avg_cadence")] = q.value(12);
+                m[QStringLiteral("elevation")] = q.value(13);
+                m[QStringLiteral("file")] = q.value(14);
+                list.append(m);
+            }
+        },
+        true);
+    return list;
+}
+
+QVariantList activitystore::weeklyTotals(int weeks) {
+    QVariantList list;
+    runOnWorker(
+        [&]() {
+            QSqlQuery q(QSqlDatabase::database(m_connection));
+            q.prepare(QStringLiteral("SELECT week, sessions, duration, distance, calories FROM weekly "
+                                     "ORDER BY week DESC LIMIT ?"));
+            q.addBindValue(weeks);
+            if (!q.exec()) {
+                return;
+            }
+            while (q.next()) {
+                QVariantMap m;
+                m[QStringLiteral("week")] = QDate::fromJulianDay(q.value(0).toLongLong());
+                m[QStringLiteral("sessions")] = q.value(1);
+                m[QStringLiteral("duration")] = q.value(2);
+                m[QStringLiteral("distance")] = q.value(3);
+                m[QStringLiteral("calories")] = q.value(4);
+                list.append(m);
+            }
+        },
+        true);
+    return list;
+}
+
+double activitystore::bestPower(int seconds, const QDateTime &from, const QDateTime &to) {
+    double watt = 0;
+    runOnWorker(
+        [&]() {
+            QSqlQuery q(QSqlDatabase::database(m_connection));
+            q.prepare(QStringLiteral("SELECT MAX(b.watt) FROM sessions s JOIN bests b ON b.session_id = s.id "
+                                     "WHERE s.start BETWEEN ? AND ? AND b.duration = ?"));
+            q.addBindValue(from.toSecsSinceEpoch());
+            q.addBindValue(to.toSecsSinceEpoch());
+            q.addBindValue(seconds);
+            if (q.exec() && q.next()) {
+                watt = q.value(0).toDouble();
+            }
+        },
+        true);
+    return watt;
+}
+
+QVariantList activitystore::personalRecords() {
+    QVariantList list;
+    runOnWorker(
+        [&]() {
+            QSqlQuery q(QSqlDatabase::database(m_connection));
+            if (!q.exec(QStringLiteral("SELECT duration, watt, session_id, start FROM records ORDER BY duration"))) {
+                return;
+            }
+            while (q.next()) {
+                QVariantMap m;
+                m[QStringLiteral("duration")] = q.value(0);
+                m[QStringLiteral("watt")] = q.value(1);
+                m[QStringLiteral("session")] = q.value(2);
+                m[QStringLiteral("start")] = QDateTime::fromSecsSinceEpoch(q.value(3).toLongLong());
+                list.append(m);
+            }
+        },
+        true);
+    return list;
+}
+
+QVariantList activitystore::series(qint64 sessionId) {
+    QVariantList list;
+    runOnWorker(
+        [&]() {
+            QSqlQuery q(QSqlDatabase::database(m_connection));
+            q.prepare(QStringLiteral("SELECT step, data FROM series WHERE session_id = ?"));
+            q.addBindValue(sessionId);
+            if (!q.exec() || !q.next()) {
+                return;
+            }
+            const int step = q.value(0).toInt();
+            QDataStream in(qUncompress(q.value(1).toByteArray()));
+            in.setByteOrder(QDataStream::LittleEndian);
+            quint16 watt, speed;
+            quint8 heart, cadence;
+            int elapsed = 0;
+            while (!in.atEnd()) {
+                in >> watt >> heart >> cadence >> speed;
+                QVariantMap m;
+                m[QStringLiteral("elapsed")] = elapsed;
+                m[QStringLiteral("watt")] = watt;
+                m[QStringLiteral("heart")] = heart;
+                m[QStringLiteral("cadence")] = cadence;
+                m[QStringLiteral("speed")] = speed / 10.0;
+                list.append(m);
+                elapsed += step;
+            }
+        },
+        true);
+    return list;
+}
@@ -0,0 +1,57 @@
+#ifndef ACTIVITYSTORE_H
+#define ACTIVITYSTORE_H
+
+#include "bluetoothdevice.h"
+#include "sessionline.h"
+#include <QDateTime>
+#include <QList>
+#include <QObject>
+#include <QThread>
+#include <QVariantList>
+#include <QVector>
+#include <functional>
+
+// Local history of the workouts, stored in a SQLite database in the app folder.
+// Every session is added once, when it ends: its summary, a 5 seconds downsampled series, the best powers over
+// the bestDurations() and the weekly totals and personal records, updated incrementally in the same transaction.
+// So the history queries never look at the samples and they stay fast also with thousands of sessions.
+// All the database work happens on a dedicated thread; the queries wait for it, the additions don't.
+class activitystore : public QObject {
+    Q_OBJECT
+  public:
+    static activitystore *instance();
+    ~activitystore();
+
+    void addSession(const QList<SessionLine> &session, bluetoothdevice::BLUETOOTH_TYPE type, const QString &file);
+
+    // every session is a map with id, start, type, duration, distance, calories, avg/max watt, heart and speed
+    Q_INVOKABLE QVariantList sessions(const QDateTime &from, const QDateTime &to);
+    // last weeks first, every week is a map with week (the monday), sessions, duration, distance and calories
+    Q_INVOKABLE QVariantList weeklyTotals(int weeks);
+    Q_INVOKABLE double bestPower(int seconds, const QDateTime &from, const QDateTime &to);
+    // a map with duration, watt, session and start for every one of the bestDurations()
+    Q_INVOKABLE QVariantList personalRecords();
+    // the downsampled series of a session: a list of maps with elapsed, watt, heart, cadence and speed
+    Q_INVOKABLE QVariantList series(qint64 sessionId);
+
+    static QVector<int> bestDurations() { return {5, 60, 300, 1200, 3600}; }
+    static const int seriesStep = 5;
+
+  signals:
+    void sessionAdded(qint64 id);
+
+  private:
+    explicit activitystore(const QString &filename, QObject *parent = nullptr);
+
+    QThread thread;
+    QObject *worker = nullptr;
+    QString m_filename;
+    QString m_connection;
+
+    void runOnWorker(const std::function<void()> &f, bool wait);
+    bool open();
+    qint64 insertSession(const QList<SessionLine> &session, bluetoothdevice::BLUETOOTH_TYPE type,
+                         const QString &file);
+};
+
+#endif // ACTIVITYSTORE_H
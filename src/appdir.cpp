@@ -0,0 +1,53 @@
+#include "appdir.h"
+#include <QStandardPaths>
+
+#if defined(Q_OS_ANDROID)
+#include <QAndroidJniEnvironment>
+#include <QtAndroid>
+#endif
+
+QString appdir::getWritableAppDir() {
+    QString path = QLatin1String("");
+#if defined(Q_OS_ANDROID)
+    path = getAndroidDataAppDir() + "/";
+#elif defined(Q_OS_MACOS) || defined(Q_OS_OSX)
+    path = QStandardPaths::writableLocation(QStandardPaths::DownloadLocation) + "/";
+#elif defined(Q_OS_IOS)
+    path = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation) + "/";
+#endif
+    return path;
+}
+
+#if defined(Q_OS_ANDROID)
+QString appdir::getAndroidDataAppDir() {
+    static QString path = "";
+
+    if (path.length()) {
+        return path;
+    }
+
+    QAndroidJniObject filesArr = QtAndroid::androidActivity().callObjectMethod(
+        "getExternalFilesDirs", "(Ljava/lang/String;)[Ljava/io/File;", nullptr);
+    jobjectArray dataArray = filesArr.object<jobjectArray>();
+    QString out;
+    if (dataArray) {
+        QAndroidJniEnvironment env;
+        jsize dataSize = env->GetArrayLength(dataArray);
+        if (dataSize) {
+            QAndroidJniObject mediaPath;
+            QAndroidJniObject file;
+            for (int i = 0; i < dataSize; i++) {
+                file = env->GetObjectArrayElement(dataArray, i);
+                jboolean val = QAndroidJniObject::callStaticMethod<jboolean>(
+                    "android/os/Environment", "isExternalStorageRemovable", "(Ljava/io/File;)Z", file.object());
+                mediaPath = file.callObjectMethod("getAbsolutePath", "()Ljava/lang/String;");
+                out = mediaPath.toString();
+                if (!val)
+                    break;
+            }
+        }
+    }
+    path = out;
+    return out;
+}
+#endif
@@ -0,0 +1,15 @@
+#ifndef APPDIR_H
+#define APPDIR_H
+
+#include <QString>
+
+// Folders of the app, without any UI dependency: the headless bridge build uses them too.
+class appdir {
+  public:
+    static QString getWritableAppDir();
+#if defined(Q_OS_ANDROID)
+    static QString getAndroidDataAppDir();
+#endif
+};
+
+#endif // APPDIR_H
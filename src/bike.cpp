@@ -87,7 +87,36 @@ metric bike::pelotonResistance() { return m_pelotonResistance; }
 int bike::pelotonToBikeResistance(int pelotonResistance) { return pelotonResistance; }
 uint8_t bike::resistanceFromPowerRequest(uint16_t power) { return power / 10; } // in order to have something
 void bike::cadenceSensor(uint8_t cadence) { Cadence.setValue(cadence); }
-void bike::powerSensor(uint16_t power) { m_watt.setValue(power); }
+void bike::powerSensor(uint16_t power) {
+    m_watt.setValue(power);
+
+    QSettings settings;
+    if (!settings.value(QStringLiteral("power_calibration"), false).toBool() || paused)
+        return;
+
+    powerCalibrationReady();
+    // saving once a minute is enough, and it keeps the QSettings writes away from every notification
+    if (m_powerCalibration.addSample(Cadence.value(), Resistance.value(), power) &&
+        m_powerCalibration.samples() % 60 == 0) {
+        m_powerCalibration.save(bluetoothDevice.name());
+    }
+}
+
+bool bike::powerCalibrationReady() {
+    if (!m_powerCalibrationLoaded && bluetoothDevice.isValid()) {
+        m_powerCalibration.load(bluetoothDevice.name());
+        m_powerCalibrationLoaded = true;
+    }
+    return m_powerCalibration.isReady();
+}
+
+double bike::calibratedWatts(double watts) {
+    QSettings settings;
+    if (settings.value(QStringLiteral("power_calibration"), false).toBool() && powerCalibrationReady()) {
+        return m_powerCalibration.predict(Cadence.value(), Resistance.value());
+    }
+    return watts;
+}
 
 bluetoothdevice::BLUETOOTH_TYPE bike::deviceType() { return bluetoothdevice::BIKE; }
 
@@ -103,6 +132,8 @@ void bike::clearStats() {
     elevationAcc = 0;
     m_watt.clear(false);
     WeightLoss.clear(false);
+    m_load.reset();
+    m_samples.clear();
 
     RequestedPelotonResistance.clear(false);
     RequestedResistance.clear(false);
@@ -117,6 +148,7 @@ void bike::clearStats() {
 void bike::setPaused(bool p) {
 
     paused = p;
+    m_watchdog->setArmed(!p);
     moving.setPaused(p);
     elapsed.setPaused(p);
     Speed.setPaused(p);
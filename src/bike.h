@@ -2,6 +2,7 @@
 #define BIKE_H
 
 #include "bluetoothdevice.h"
+#include "powercalibration.h"
 #include <QObject>
 
 class bike : public bluetoothdevice {
@@ -73,6 +74,12 @@ class bike : public bluetoothdevice {
     metric m_pelotonResistance;
 
     metric m_steeringAngle;
+
+    // learnt from the external power meter, see powercalibration
+    powercalibration m_powerCalibration;
+    bool m_powerCalibrationLoaded = false;
+    bool powerCalibrationReady();
+    double calibratedWatts(double watts) override;
 };
 
 #endif // BIKE_H
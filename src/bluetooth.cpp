@@ -1,5 +1,64 @@
 #include "bluetooth.h"
-#include "homeform.h"
+#include "appdir.h"
+#include "activiotreadmill.h"
+#include "bhfitnesselliptical.h"
+#include "bowflextreadmill.h"
+#include "chronobike.h"
+#include "concept2skierg.h"
+#include "cscbike.h"
+#include "domyosbike.h"
+#include "domyoselliptical.h"
+#include "domyosrower.h"
+#include "domyostreadmill.h"
+#include "driverregistry.h"
+#include "echelonconnectsport.h"
+#include "echelonrower.h"
+#include "echelonstride.h"
+#include "eliterizer.h"
+#include "elitesterzosmart.h"
+#include "fakebike.h"
+#include "fitmetria_fanfit.h"
+#include "fitplusbike.h"
+#include "fitshowtreadmill.h"
+#include "flywheelbike.h"
+#include "ftmsbike.h"
+#include "ftmsrower.h"
+#include "heartratebelt.h"
+#include "horizongr7bike.h"
+#include "horizontreadmill.h"
+#include "iconceptbike.h"
+#include "inspirebike.h"
+#include "kingsmithr1protreadmill.h"
+#include "kingsmithr2treadmill.h"
+#include "m3ibike.h"
+#include "nautilusbike.h"
+#include "nautiluselliptical.h"
+#include "npecablebike.h"
+#include "pafersbike.h"
+#include "paferstreadmill.h"
+#include "proformbike.h"
+#include "proformelliptical.h"
+#include "proformrower.h"
+#include "proformtreadmill.h"
+#include "proformwifibike.h"
+#include "renphobike.h"
+#include "schwinnic4bike.h"
+#include "shuaa5treadmill.h"
+#include "smartrowrower.h"
+#include "snodebike.h"
+#include "solebike.h"
+#include "soleelliptical.h"
+#include "solef80treadmill.h"
+#include "spirittreadmill.h"
+#include "stagesbike.h"
+#include "strydrunpowersensor.h"
+#include "tacxneo2.h"
+#include "technogymmyruntreadmill.h"
+#include "technogymmyruntreadmillrfcomm.h"
+#include "toorxtreadmill.h"
+#include "trxappgateusbbike.h"
+#include "trxappgateusbtreadmill.h"
+#include "wahookickrsnapbike.h"
 #include <QBluetoothLocalDevice>
 #include <QDateTime>
 #include <QFile>
@@ -13,7 +72,7 @@
 
 bluetooth::bluetooth(bool logs, const QString &deviceName, bool noWriteResistance, bool noHeartService,
                      uint32_t pollDeviceTime, bool noConsole, bool testResistance, uint8_t bikeResistanceOffset,
-                     double bikeResistanceGain) {
+                     double bikeResistanceGain, int gatewaySlot) {
     QSettings settings;
     bool trx_route_key = settings.value(QStringLiteral("trx_route_key"), false).toBool();
     bool bh_spada_2 = settings.value(QStringLiteral("bh_spada_2"), false).toBool();
@@ -30,10 +89,13 @@ bluetooth::bluetooth(bool logs, const QString &deviceName, bool noWriteResistanc
     this->logs = logs;
     this->bikeResistanceGain = bikeResistanceGain;
     this->bikeResistanceOffset = bikeResistanceOffset;
-    QString path = homeform::getWritableAppDir() + QStringLiteral("QZTemplates");
+    this->gatewaySlot = gatewaySlot;
+    // every rider of the studio gateway has its own template context
+    QString slotId = gatewaySlot >= 0 ? QString::number(gatewaySlot) : QLatin1String("");
+    QString path = appdir::getWritableAppDir() + QStringLiteral("QZTemplates");
     this->userTemplateManager = TemplateInfoSenderBuilder::getInstance(
-        QStringLiteral("user"), QStringList({path, QStringLiteral(":/templates/")}), this);
-    QString innerId = QStringLiteral("inner");
+        QStringLiteral("user") + slotId, QStringList({path, QStringLiteral(":/templates/")}), this);
+    QString innerId = QStringLiteral("inner") + slotId;
     QString sKey = QStringLiteral("template_") + innerId + QStringLiteral("_" TEMPLATE_PRIVATE_WEBSERVER_ID "_");
     settings.setValue(sKey + QStringLiteral("enabled"), true);
     settings.setValue(sKey + QStringLiteral("type"), TEMPLATE_TYPE_WEBSERVER);
@@ -69,6 +131,27 @@ bluetooth::bluetooth(bool logs, const QString &deviceName, bool noWriteResistanc
         // Start a discovery
         discoveryAgent->setLowEnergyDiscoveryTimeout(10000);
 
+        // the studio gateway riders don't scan: the agent is kept only because the drivers stop it on connection
+        connect(this, &bluetooth::deviceConnected, this, [this](const QBluetoothDeviceInfo &b) {
+            if (this->gatewaySlot >= 0 && device()) {
+                device()->setGatewaySlot(this->gatewaySlot);
+            } else if (!b.name().isEmpty()) {
+                // the cache of the fast reconnect
+                QSettings settings;
+                settings.setValue(QStringLiteral("fast_reconnect_name"), b.name());
+#ifndef Q_OS_IOS
+                settings.setValue(QStringLiteral("fast_reconnect_address"), b.address().toString());
+#else
+                settings.setValue(QStringLiteral("fast_reconnect_address"), b.deviceUuid().toString());
+#endif
+                settings.setValue(QStringLiteral("fast_reconnect_classic"),
+                                  !(b.coreConfigurations() & QBluetoothDeviceInfo::LowEnergyCoreConfiguration));
+            }
+        });
+        if (gatewaySlot >= 0) {
+            return;
+        }
+
 #ifdef Q_OS_IOS
         // Schwinn bikes on iOS allows to be connected to several instances, so in this way
         // QZ will remember the address and will try to connect to it
@@ -98,14 +181,23 @@ bluetooth::bluetooth(bool logs, const QString &deviceName, bool noWriteResistanc
 #endif
 
 #ifndef Q_OS_IOS
-        if (!trx_route_key && !bh_spada_2 && !technogym_myrun_treadmill_experimental)
-#endif
-            discoveryAgent->start(QBluetoothDeviceDiscoveryAgent::LowEnergyMethod);
-#ifndef Q_OS_IOS
-        else
-            discoveryAgent->start(QBluetoothDeviceDiscoveryAgent::ClassicMethod |
-                                  QBluetoothDeviceDiscoveryAgent::LowEnergyMethod);
+        const bool classic = trx_route_key || bh_spada_2 || technogym_myrun_treadmill_experimental;
+#else
+        const bool classic = false;
 #endif
+        // deferred, as the results of a discovery: the deviceConnected of a fast reconnect has to reach homeform
+        // and the main window, that are created after this object
+        QTimer::singleShot(0, this, [this, classic]() {
+            if (fastReconnectStart() && !accessoriesMissing()) {
+                return;
+            }
+
+            if (!classic)
+                discoveryAgent->start(QBluetoothDeviceDiscoveryAgent::LowEnergyMethod);
+            else
+                discoveryAgent->start(QBluetoothDeviceDiscoveryAgent::ClassicMethod |
+                                      QBluetoothDeviceDiscoveryAgent::LowEnergyMethod);
+        });
     }
 }
 
@@ -120,6 +212,10 @@ bluetooth::~bluetooth() {
 void bluetooth::finished() {
     debug(QStringLiteral("BTLE scanning finished"));
 
+    if (fastReconnect && device() && !accessoriesMissing()) {
+        return;
+    }
+
     QSettings settings;
     QString heartRateBeltName =
         settings.value(QStringLiteral("heart_rate_belt_name"), QStringLiteral("Disabled")).toString();
@@ -370,9 +466,18 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device) {
     if (onlyDiscover)
         return;
 
+    // the machine is already there (fast reconnect): the scan is only for the accessories still missing
+    if (this->device()) {
+        connectAccessories();
+        if (!accessoriesMissing()) {
+            discoveryAgent->stop();
+        }
+        return;
+    }
+
     if ((heartRateBeltFound && ftmsAccessoryFound && cscFound && powerSensorFound && eliteRizerFound &&
          eliteSterzoSmartFound) ||
-        forceHeartBeltOffForTimeout) {
+        forceHeartBeltOffForTimeout || fastReconnect) {
         for (const QBluetoothDeviceInfo &b : qAsConst(devices)) {
 
             bool filter = true;
@@ -1074,50 +1179,6 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device) {
                 schwinnIC4Bike->deviceDiscovered(b);
                 userTemplateManager->start(schwinnIC4Bike);
                 innerTemplateManager->start(schwinnIC4Bike);
-            } else if (b.name().toUpper().startsWith(QStringLiteral("EW-BK")) && !sportsTechBike && filter) {
-                discoveryAgent->stop();
-                sportsTechBike = new sportstechbike(noWriteResistance, noHeartService);
-                // stateFileRead();
-                emit deviceConnected(b);
-                connect(sportsTechBike, &bluetoothdevice::connectedAndDiscovered, this,
-                        &bluetooth::connectedAndDiscovered);
-                // connect(echelonConnectSport, SIGNAL(disconnected()), this, SLOT(restart()));
-                connect(sportsTechBike, &sportstechbike::debug, this, &bluetooth::debug);
-                // connect(echelonConnectSport, SIGNAL(speedChanged(double)), this, SLOT(speedChanged(double)));
-                // connect(echelonConnectSport, SIGNAL(inclinationChanged(double)), this,
-                // SLOT(inclinationChanged(double)));
-                sportsTechBike->deviceDiscovered(b);
-                userTemplateManager->start(sportsTechBike);
-                innerTemplateManager->start(sportsTechBike);
-            } else if (b.name().toUpper().startsWith(QStringLiteral("CARDIOFIT")) && !sportsPlusBike && filter) {
-                discoveryAgent->stop();
-                sportsPlusBike = new sportsplusbike(noWriteResistance, noHeartService);
-                // stateFileRead();
-                emit deviceConnected(b);
-                connect(sportsPlusBike, &bluetoothdevice::connectedAndDiscovered, this,
-                        &bluetooth::connectedAndDiscovered);
-                // connect(sportsPlusBike, SIGNAL(disconnected()), this, SLOT(restart()));
-                connect(sportsPlusBike, &sportsplusbike::debug, this, &bluetooth::debug);
-                // connect(sportsPlusBike, SIGNAL(speedChanged(double)), this, SLOT(speedChanged(double)));
-                // connect(sportsPlusBike, SIGNAL(inclinationChanged(double)), this,
-                // SLOT(inclinationChanged(double)));
-                sportsPlusBike->deviceDiscovered(b);
-                userTemplateManager->start(sportsPlusBike);
-                innerTemplateManager->start(sportsPlusBike);
-            } else if (b.name().startsWith(QStringLiteral("YESOUL")) && !yesoulBike && filter) {
-                discoveryAgent->stop();
-                yesoulBike = new yesoulbike(noWriteResistance, noHeartService);
-                // stateFileRead();
-                emit deviceConnected(b);
-                connect(yesoulBike, &bluetoothdevice::connectedAndDiscovered, this, &bluetooth::connectedAndDiscovered);
-                // connect(yesoulBike, SIGNAL(disconnected()), this, SLOT(restart()));
-                connect(yesoulBike, &yesoulbike::debug, this, &bluetooth::debug);
-                // connect(echelonConnectSport, SIGNAL(speedChanged(double)), this, SLOT(speedChanged(double)));
-                // connect(echelonConnectSport, SIGNAL(inclinationChanged(double)), this,
-                // SLOT(inclinationChanged(double)));
-                yesoulBike->deviceDiscovered(b);
-                userTemplateManager->start(yesoulBike);
-                innerTemplateManager->start(yesoulBike);
             } else if ((b.name().startsWith(QStringLiteral("I_EB")) || b.name().startsWith(QStringLiteral("I_SB"))) &&
                        !proformBike && filter) {
                 discoveryAgent->stop();
@@ -1149,21 +1210,6 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device) {
                 proformTreadmill->deviceDiscovered(b);
                 userTemplateManager->start(proformTreadmill);
                 innerTemplateManager->start(proformTreadmill);
-            } else if (b.name().toUpper().startsWith(QStringLiteral("ESLINKER")) && !eslinkerTreadmill && filter) {
-                discoveryAgent->stop();
-                eslinkerTreadmill = new eslinkertreadmill(this->pollDeviceTime, noConsole, noHeartService);
-                // stateFileRead();
-                emit deviceConnected(b);
-                connect(eslinkerTreadmill, &bluetoothdevice::connectedAndDiscovered, this,
-                        &bluetooth::connectedAndDiscovered);
-                // connect(proformtreadmill, SIGNAL(disconnected()), this, SLOT(restart()));
-                connect(eslinkerTreadmill, &eslinkertreadmill::debug, this, &bluetooth::debug);
-                // connect(proformtreadmill, SIGNAL(speedChanged(double)), this, SLOT(speedChanged(double)));
-                // connect(proformtreadmill, SIGNAL(inclinationChanged(double)), this,
-                // SLOT(inclinationChanged(double)));
-                eslinkerTreadmill->deviceDiscovered(b);
-                userTemplateManager->start(eslinkerTreadmill);
-                innerTemplateManager->start(eslinkerTreadmill);
             } else if (b.name().toUpper().startsWith(QStringLiteral("PAFERS_")) && !pafersTreadmill &&
                        pafers_treadmill && filter) {
                 discoveryAgent->stop();
@@ -1180,37 +1226,6 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device) {
                 pafersTreadmill->deviceDiscovered(b);
                 userTemplateManager->start(pafersTreadmill);
                 innerTemplateManager->start(pafersTreadmill);
-            } else if (b.name().toUpper().startsWith(QStringLiteral("BOWFLEX T216")) && !bowflexT216Treadmill &&
-                       filter) {
-                discoveryAgent->stop();
-                bowflexT216Treadmill = new bowflext216treadmill(this->pollDeviceTime, noConsole, noHeartService);
-                // stateFileRead();
-                emit deviceConnected(b);
-                connect(bowflexT216Treadmill, &bluetoothdevice::connectedAndDiscovered, this,
-                        &bluetooth::connectedAndDiscovered);
-                // connect(bowflexTreadmill, SIGNAL(disconnected()), this, SLOT(restart()));
-                connect(bowflexT216Treadmill, &bowflext216treadmill::debug, this, &bluetooth::debug);
-                // connect(bowflexTreadmill, SIGNAL(speedChanged(double)), this, SLOT(speedChanged(double)));
-                // connect(bowflexTreadmill, SIGNAL(inclinationChanged(double)), this,
-                // SLOT(inclinationChanged(double)));
-                bowflexT216Treadmill->deviceDiscovered(b);
-                userTemplateManager->start(bowflexT216Treadmill);
-                innerTemplateManager->start(bowflexT216Treadmill);
-            } else if (b.name().toUpper().startsWith(QStringLiteral("NAUTILUS T")) && !nautilusTreadmill && filter) {
-                discoveryAgent->stop();
-                nautilusTreadmill = new nautilustreadmill(this->pollDeviceTime, noConsole, noHeartService);
-                // stateFileRead();
-                emit deviceConnected(b);
-                connect(nautilusTreadmill, &bluetoothdevice::connectedAndDiscovered, this,
-                        &bluetooth::connectedAndDiscovered);
-                // connect(nautilusTreadmill, SIGNAL(disconnected()), this, SLOT(restart()));
-                connect(nautilusTreadmill, &nautilustreadmill::debug, this, &bluetooth::debug);
-                // connect(nautilusTreadmill, SIGNAL(speedChanged(double)), this, SLOT(speedChanged(double)));
-                // connect(nautilusTreadmill, SIGNAL(inclinationChanged(double)), this,
-                // SLOT(inclinationChanged(double)));
-                nautilusTreadmill->deviceDiscovered(b);
-                userTemplateManager->start(nautilusTreadmill);
-                innerTemplateManager->start(nautilusTreadmill);
             } else if ((b.name().startsWith(QStringLiteral("Flywheel")) ||
                         // BIKE 1, BIKE 2, BIKE 3...
                         (b.name().toUpper().startsWith(QStringLiteral("BIKE")) && flywheel_life_fitness_ic8 == true &&
@@ -1230,20 +1245,6 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device) {
                 flywheelBike->deviceDiscovered(b);
                 userTemplateManager->start(flywheelBike);
                 innerTemplateManager->start(flywheelBike);
-            } else if ((b.name().toUpper().startsWith(QStringLiteral("MCF-"))) && !mcfBike && filter) {
-                discoveryAgent->stop();
-                mcfBike = new mcfbike(noWriteResistance, noHeartService, bikeResistanceOffset, bikeResistanceGain);
-                // stateFileRead();
-                emit deviceConnected(b);
-                connect(mcfBike, &bluetoothdevice::connectedAndDiscovered, this, &bluetooth::connectedAndDiscovered);
-                // connect(mcfBike, SIGNAL(disconnected()), this, SLOT(restart()));
-                // connect(mcfBike, &mcfbike::debug, this, &bluetooth::debug);
-                // connect(mcfBike, SIGNAL(speedChanged(double)), this, SLOT(speedChanged(double)));
-                // connect(mcfBike, SIGNAL(inclinationChanged(double)), this,
-                // SLOT(inclinationChanged(double)));
-                mcfBike->deviceDiscovered(b);
-                userTemplateManager->start(mcfBike);
-                innerTemplateManager->start(mcfBike);
             } else if ((b.name().startsWith(QStringLiteral("TRX ROUTE KEY"))) && !toorx && filter) {
                 discoveryAgent->stop();
                 toorx = new toorxtreadmill();
@@ -1327,28 +1328,6 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device) {
                 trxappgateusbBike->deviceDiscovered(b);
                 userTemplateManager->start(trxappgateusbBike);
                 innerTemplateManager->start(trxappgateusbBike);
-            } else if ((b.name().toUpper().startsWith(QStringLiteral("X-BIKE"))) && !ultraSportBike && filter) {
-                discoveryAgent->stop();
-                ultraSportBike =
-                    new ultrasportbike(noWriteResistance, noHeartService, bikeResistanceOffset, bikeResistanceGain);
-                emit deviceConnected(b);
-                connect(ultraSportBike, &bluetoothdevice::connectedAndDiscovered, this,
-                        &bluetooth::connectedAndDiscovered);
-                // connect(ultraSportBike, SIGNAL(disconnected()), this, SLOT(restart()));
-                // connect(ultraSportBike, &solebike::debug, this, &bluetooth::debug);
-                ultraSportBike->deviceDiscovered(b);
-                userTemplateManager->start(ultraSportBike);
-                innerTemplateManager->start(ultraSportBike);
-            } else if ((b.name().toUpper().startsWith(QStringLiteral("KEEP_BIKE_"))) && !keepBike && filter) {
-                discoveryAgent->stop();
-                keepBike = new keepbike(noWriteResistance, noHeartService, bikeResistanceOffset, bikeResistanceGain);
-                emit deviceConnected(b);
-                connect(keepBike, &bluetoothdevice::connectedAndDiscovered, this, &bluetooth::connectedAndDiscovered);
-                // connect(keepBike, SIGNAL(disconnected()), this, SLOT(restart()));
-                // connect(keepBike, &solebike::debug, this, &bluetooth::debug);
-                keepBike->deviceDiscovered(b);
-                userTemplateManager->start(keepBike);
-                innerTemplateManager->start(keepBike);
             } else if ((b.name().toUpper().startsWith(QStringLiteral("LCB")) ||
                         b.name().toUpper().startsWith(QStringLiteral("R92"))) &&
                        !soleBike && filter) {
@@ -1361,18 +1340,6 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device) {
                 soleBike->deviceDiscovered(b);
                 userTemplateManager->start(soleBike);
                 innerTemplateManager->start(soleBike);
-            } else if (b.name().toUpper().startsWith(QStringLiteral("BFCP")) && !skandikaWiriBike && filter) {
-                discoveryAgent->stop();
-                skandikaWiriBike =
-                    new skandikawiribike(noWriteResistance, noHeartService, bikeResistanceOffset, bikeResistanceGain);
-                emit deviceConnected(b);
-                connect(skandikaWiriBike, &bluetoothdevice::connectedAndDiscovered, this,
-                        &bluetooth::connectedAndDiscovered);
-                // connect(skandikaWiriBike, SIGNAL(disconnected()), this, SLOT(restart()));
-                connect(skandikaWiriBike, &skandikawiribike::debug, this, &bluetooth::debug);
-                skandikaWiriBike->deviceDiscovered(b);
-                userTemplateManager->start(skandikaWiriBike);
-                innerTemplateManager->start(skandikaWiriBike);
             } else if (((b.name().toUpper().startsWith("RQ") && b.name().length() == 5) ||
                         (b.name().toUpper().startsWith("SCH130")) || // not a renpho bike an FTMS one
                         ((b.name().startsWith(QStringLiteral("TOORX"))) && toorx_ftms)) &&
@@ -1482,6 +1449,31 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device) {
                 if (!discoveryAgent->isActive()) {
                     emit searchingStop();
                 }
+            } else if (!registryDevice && filter) {
+                const driverregistry::entry *driver = driverregistry::match(b);
+                if (!driver) {
+                    continue;
+                }
+                discoveryAgent->stop();
+                driverparams params;
+                params.noWriteResistance = noWriteResistance;
+                params.noHeartService = noHeartService;
+                params.noConsole = noConsole;
+                params.pollDeviceTime = pollDeviceTime;
+                params.bikeResistanceOffset = bikeResistanceOffset;
+                params.bikeResistanceGain = bikeResistanceGain;
+                registryDevice = driver->create(params);
+                debug(QStringLiteral("driver from the registry: ") + QLatin1String(driver->name));
+                emit deviceConnected(b);
+                connect(registryDevice, &bluetoothdevice::connectedAndDiscovered, this,
+                        &bluetooth::connectedAndDiscovered);
+                // not every driver has the debug signal
+                if (driver->connectDebug && registryDevice->metaObject()->indexOfSignal("debug(QString)") != -1) {
+                    connect(registryDevice, SIGNAL(debug(QString)), this, SLOT(debug(QString)));
+                }
+                driver->deviceDiscovered(registryDevice, b);
+                userTemplateManager->start(registryDevice);
+                innerTemplateManager->start(registryDevice);
             }
         }
     }
@@ -1493,18 +1485,6 @@ void bluetooth::connectedAndDiscovered() {
     QSettings settings;
     QString heartRateBeltName =
         settings.value(QStringLiteral("heart_rate_belt_name"), QStringLiteral("Disabled")).toString();
-    QString ftmsAccessoryName =
-        settings.value(QStringLiteral("ftms_accessory_name"), QStringLiteral("Disabled")).toString();
-    bool csc_as_bike = settings.value(QStringLiteral("cadence_sensor_as_bike"), false).toBool();
-    QString cscName = settings.value(QStringLiteral("cadence_sensor_name"), QStringLiteral("Disabled")).toString();
-    bool power_as_bike = settings.value(QStringLiteral("power_sensor_as_bike"), false).toBool();
-    bool power_as_treadmill = settings.value(QStringLiteral("power_sensor_as_treadmill"), false).toBool();
-    QString powerSensorName =
-        settings.value(QStringLiteral("power_sensor_name"), QStringLiteral("Disabled")).toString();
-    QString eliteRizerName = settings.value(QStringLiteral("elite_rizer_name"), QStringLiteral("Disabled")).toString();
-    QString eliteSterzoSmartName =
-        settings.value(QStringLiteral("elite_sterzo_smart_name"), QStringLiteral("Disabled")).toString();
-    bool fitmetriaFanfitEnabled = settings.value(QStringLiteral("fitmetria_fanfit_enable"), false).toBool();
 
     // only at the first very connection, setting the user default resistance
     if (device() && firstConnected && device()->deviceType() == bluetoothdevice::BIKE &&
@@ -1526,27 +1506,76 @@ void bluetooth::connectedAndDiscovered() {
         }
     }
 
-    if (this->device() != nullptr) {
-
 #ifdef Q_OS_IOS
-        if (settings.value(QStringLiteral("ios_cache_heart_device"), true).toBool()) {
-            QString heartRateBeltName = settings.value("heart_rate_belt_name", "Disabled").toString();
-            QString b = settings.value("hrm_lastdevice_name", "").toString();
-            qDebug() << "last hrm name" << b;
-            if (!b.compare(heartRateBeltName) && b.length()) {
+    if (this->device() != nullptr && settings.value(QStringLiteral("ios_cache_heart_device"), true).toBool()) {
+        QString heartRateBeltName = settings.value("heart_rate_belt_name", "Disabled").toString();
+        QString b = settings.value("hrm_lastdevice_name", "").toString();
+        qDebug() << "last hrm name" << b;
+        if (!b.compare(heartRateBeltName) && b.length()) {
 
-                heartRateBelt = new heartratebelt();
-                // connect(heartRateBelt, SIGNAL(disconnected()), this, SLOT(restart()));
+            heartRateBelt = new heartratebelt();
+            // connect(heartRateBelt, SIGNAL(disconnected()), this, SLOT(restart()));
 
-                connect(heartRateBelt, SIGNAL(debug(QString)), this, SLOT(debug(QString)));
-                connect(heartRateBelt, SIGNAL(heartRate(uint8_t)), this->device(), SLOT(heartRate(uint8_t)));
-                QBluetoothDeviceInfo bt;
-                bt.setDeviceUuid(QBluetoothUuid(settings.value("hrm_lastdevice_address", "").toString()));
-                qDebug() << "UUID" << bt.deviceUuid();
-                heartRateBelt->deviceDiscovered(bt);
-            }
+            connect(heartRateBelt, SIGNAL(debug(QString)), this, SLOT(debug(QString)));
+            connect(heartRateBelt, SIGNAL(heartRate(uint8_t)), this->device(), SLOT(heartRate(uint8_t)));
+            QBluetoothDeviceInfo bt;
+            bt.setDeviceUuid(QBluetoothUuid(settings.value("hrm_lastdevice_address", "").toString()));
+            qDebug() << "UUID" << bt.deviceUuid();
+            heartRateBelt->deviceDiscovered(bt);
         }
+    }
 #endif
+
+    connectAccessories();
+
+#ifdef Q_OS_ANDROID
+    if (settings.value(QStringLiteral("ant_cadence"), false).toBool() ||
+        settings.value(QStringLiteral("ant_heart"), false).toBool()) {
+        QAndroidJniObject activity = QAndroidJniObject::callStaticObjectMethod("org/qtproject/qt5/android/QtNative",
+                                                                               "activity", "()Landroid/app/Activity;");
+        KeepAwakeHelper::antObject(true)->callMethod<void>(
+            "antStart", "(Landroid/app/Activity;ZZZ)V", activity.object<jobject>(),
+            settings.value(QStringLiteral("ant_cadence"), false).toBool(),
+            settings.value(QStringLiteral("ant_heart"), false).toBool(),
+            settings.value(QStringLiteral("ant_garmin"), false).toBool());
+    }
+#endif
+
+#ifdef Q_OS_IOS
+    // in order to allow to populate the tiles with the IC BIKE auto connect feature
+    if (firstConnected) {
+        QBluetoothDeviceInfo bt;
+        QString b = settings.value("bluetooth_lastdevice_name", "").toString();
+        bt.setDeviceUuid(QBluetoothUuid(settings.value("bluetooth_lastdevice_address", "").toString()));
+        // set name method doesn't exist
+        emit(deviceConnected(bt));
+    }
+#endif
+
+    firstConnected = false;
+    fastReconnect = false;
+    fastReconnectFailed = false;
+}
+
+void bluetooth::connectAccessories() {
+
+    QSettings settings;
+    QString heartRateBeltName =
+        settings.value(QStringLiteral("heart_rate_belt_name"), QStringLiteral("Disabled")).toString();
+    QString ftmsAccessoryName =
+        settings.value(QStringLiteral("ftms_accessory_name"), QStringLiteral("Disabled")).toString();
+    bool csc_as_bike = settings.value(QStringLiteral("cadence_sensor_as_bike"), false).toBool();
+    QString cscName = settings.value(QStringLiteral("cadence_sensor_name"), QStringLiteral("Disabled")).toString();
+    bool power_as_bike = settings.value(QStringLiteral("power_sensor_as_bike"), false).toBool();
+    bool power_as_treadmill = settings.value(QStringLiteral("power_sensor_as_treadmill"), false).toBool();
+    QString powerSensorName =
+        settings.value(QStringLiteral("power_sensor_name"), QStringLiteral("Disabled")).toString();
+    QString eliteRizerName = settings.value(QStringLiteral("elite_rizer_name"), QStringLiteral("Disabled")).toString();
+    QString eliteSterzoSmartName =
+        settings.value(QStringLiteral("elite_sterzo_smart_name"), QStringLiteral("Disabled")).toString();
+    bool fitmetriaFanfitEnabled = settings.value(QStringLiteral("fitmetria_fanfit_enable"), false).toBool();
+
+    if (this->device() != nullptr) {
         for (const QBluetoothDeviceInfo &b : qAsConst(devices)) {
             if (((b.name().startsWith(heartRateBeltName))) && !heartRateBelt &&
                 !heartRateBeltName.startsWith(QStringLiteral("Disabled"))) {
@@ -1714,32 +1743,81 @@ void bluetooth::connectedAndDiscovered() {
             break;
         }
     }
+}
 
-#ifdef Q_OS_ANDROID
-    if (settings.value(QStringLiteral("ant_cadence"), false).toBool() ||
-        settings.value(QStringLiteral("ant_heart"), false).toBool()) {
-        QAndroidJniObject activity = QAndroidJniObject::callStaticObjectMethod("org/qtproject/qt5/android/QtNative",
-                                                                               "activity", "()Landroid/app/Activity;");
-        KeepAwakeHelper::antObject(true)->callMethod<void>(
-            "antStart", "(Landroid/app/Activity;ZZZ)V", activity.object<jobject>(),
-            settings.value(QStringLiteral("ant_cadence"), false).toBool(),
-            settings.value(QStringLiteral("ant_heart"), false).toBool(),
-            settings.value(QStringLiteral("ant_garmin"), false).toBool());
-    }
-#endif
+bool bluetooth::accessoriesMissing() {
 
-#ifdef Q_OS_IOS
-    // in order to allow to populate the tiles with the IC BIKE auto connect feature
-    if (firstConnected) {
-        QBluetoothDeviceInfo bt;
-        QString b = settings.value("bluetooth_lastdevice_name", "").toString();
-        bt.setDeviceUuid(QBluetoothUuid(settings.value("bluetooth_lastdevice_address", "").toString()));
-        // set name method doesn't exist
-        emit(deviceConnected(bt));
+    QSettings settings;
+    QString heartRateBeltName =
+        settings.value(QStringLiteral("heart_rate_belt_name"), QStringLiteral("Disabled")).toString();
+    QString ftmsAccessoryName =
+        settings.value(QStringLiteral("ftms_accessory_name"), QStringLiteral("Disabled")).toString();
+    bool csc_as_bike = settings.value(QStringLiteral("cadence_sensor_as_bike"), false).toBool();
+    QString cscName = settings.value(QStringLiteral("cadence_sensor_name"), QStringLiteral("Disabled")).toString();
+    bool power_as_bike = settings.value(QStringLiteral("power_sensor_as_bike"), false).toBool();
+    bool power_as_treadmill = settings.value(QStringLiteral("power_sensor_as_treadmill"), false).toBool();
+    QString powerSensorName =
+        settings.value(QStringLiteral("power_sensor_name"), QStringLiteral("Disabled")).toString();
+    QString eliteRizerName = settings.value(QStringLiteral("elite_rizer_name"), QStringLiteral("Disabled")).toString();
+    QString eliteSterzoSmartName =
+        settings.value(QStringLiteral("elite_sterzo_smart_name"), QStringLiteral("Disabled")).toString();
+
+    return (!heartRateBeltName.startsWith(QStringLiteral("Disabled")) && !heartRateBelt) ||
+           (!ftmsAccessoryName.startsWith(QStringLiteral("Disabled")) && !ftmsAccessory) ||
+           (!csc_as_bike && !cscName.startsWith(QStringLiteral("Disabled")) && !cadenceSensor) ||
+           (!power_as_bike && !power_as_treadmill && !powerSensorName.startsWith(QStringLiteral("Disabled")) &&
+            !powerSensor && !powerSensorRun) ||
+           (!eliteRizerName.startsWith(QStringLiteral("Disabled")) && !eliteRizer) ||
+           (!eliteSterzoSmartName.startsWith(QStringLiteral("Disabled")) && !eliteSterzoSmart && device() &&
+            device()->deviceType() == bluetoothdevice::BIKE);
+}
+
+bool bluetooth::fastReconnectStart() {
+
+    fastReconnect = false;
+    QSettings settings;
+    if (!settings.value(QStringLiteral("bluetooth_fast_reconnect"), false).toBool() || fastReconnectFailed ||
+        settings.value(QStringLiteral("bluetooth_no_reconnection"), false).toBool() || onlyDiscover || device()) {
+        return false;
+    }
+    QString name = settings.value(QStringLiteral("fast_reconnect_name"), QLatin1String("")).toString();
+    QString address = settings.value(QStringLiteral("fast_reconnect_address"), QLatin1String("")).toString();
+    if (name.isEmpty() || address.isEmpty()) {
+        return false;
+    }
+    if (!filterDevice.isEmpty() && !filterDevice.startsWith(QStringLiteral("Disabled")) &&
+        name.compare(filterDevice, Qt::CaseInsensitive)) {
+        return false;
     }
+
+#ifndef Q_OS_IOS
+    QBluetoothDeviceInfo cached(QBluetoothAddress(address), name, 0);
+#else
+    QBluetoothDeviceInfo cached(QBluetoothUuid(address), name, 0);
 #endif
+    cached.setCoreConfigurations(settings.value(QStringLiteral("fast_reconnect_classic"), false).toBool()
+                                     ? QBluetoothDeviceInfo::BaseRateCoreConfiguration
+                                     : QBluetoothDeviceInfo::LowEnergyCoreConfiguration);
+    debug(QStringLiteral("fast reconnect to the last device: ") + name + QStringLiteral(" (") + address + ')');
+
+    // straight to the driver, without waiting for the scan and the accessories
+    fastReconnect = true;
+    deviceDiscovered(cached);
+    if (!device()) {
+        fastReconnect = false;
+        return false;
+    }
 
-    firstConnected = false;
+    // the machine could be off or somewhere else: back to the full discovery
+    QTimer::singleShot(fastReconnectTimeoutMs, this, [this]() {
+        if (fastReconnect && device() && !device()->connected()) {
+            debug(QStringLiteral("fast reconnect failed, starting the discovery"));
+            fastReconnect = false;
+            fastReconnectFailed = true;
+            restart();
+        }
+    });
+    return true;
 }
 
 void bluetooth::heartRate(uint8_t heart) { Q_UNUSED(heart) }
@@ -1779,6 +1857,11 @@ void bluetooth::restart() {
         delete domyos;
         domyos = nullptr;
     }
+    if (registryDevice) {
+
+        delete registryDevice;
+        registryDevice = nullptr;
+    }
     if (m3iBike) {
 
         delete m3iBike;
@@ -1937,16 +2020,6 @@ void bluetooth::restart() {
         delete soleBike;
         soleBike = nullptr;
     }
-    if (keepBike) {
-
-        delete keepBike;
-        keepBike = nullptr;
-    }
-    if (ultraSportBike) {
-
-        delete ultraSportBike;
-        ultraSportBike = nullptr;
-    }
     if (echelonConnectSport) {
 
         delete echelonConnectSport;
@@ -1977,11 +2050,6 @@ void bluetooth::restart() {
         delete smartrowRower;
         smartrowRower = nullptr;
     }
-    if (yesoulBike) {
-
-        delete yesoulBike;
-        yesoulBike = nullptr;
-    }
     if (proformBike) {
 
         delete proformBike;
@@ -2002,56 +2070,26 @@ void bluetooth::restart() {
         delete proformRower;
         proformRower = nullptr;
     }
-    if (eslinkerTreadmill) {
-
-        delete eslinkerTreadmill;
-        eslinkerTreadmill = nullptr;
-    }
     if (bowflexTreadmill) {
 
         delete bowflexTreadmill;
         bowflexTreadmill = nullptr;
     }
-    if (bowflexT216Treadmill) {
-
-        delete bowflexT216Treadmill;
-        bowflexT216Treadmill = nullptr;
-    }
     if (pafersTreadmill) {
 
         delete pafersTreadmill;
         pafersTreadmill = nullptr;
     }
-    if (nautilusTreadmill) {
-
-        delete nautilusTreadmill;
-        nautilusTreadmill = nullptr;
-    }
     if (flywheelBike) {
 
         delete flywheelBike;
         flywheelBike = nullptr;
     }
-    if (mcfBike) {
-
-        delete mcfBike;
-        mcfBike = nullptr;
-    }
     if (schwinnIC4Bike) {
 
         delete schwinnIC4Bike;
         schwinnIC4Bike = nullptr;
     }
-    if (sportsTechBike) {
-
-        delete sportsTechBike;
-        sportsTechBike = nullptr;
-    }
-    if (sportsPlusBike) {
-
-        delete sportsPlusBike;
-        sportsPlusBike = nullptr;
-    }
     if (inspireBike) {
 
         delete inspireBike;
@@ -2097,11 +2135,6 @@ void bluetooth::restart() {
         delete fitPlusBike;
         fitPlusBike = nullptr;
     }
-    if (skandikaWiriBike) {
-
-        delete skandikaWiriBike;
-        skandikaWiriBike = nullptr;
-    }
     if (heartRateBelt) {
 
         // heartRateBelt->disconnectBluetooth(); // to test
@@ -2152,6 +2185,9 @@ void bluetooth::restart() {
         delete eliteSterzoSmart;
         eliteSterzoSmart = nullptr;
     }
+    if (fastReconnectStart() && !accessoriesMissing()) {
+        return;
+    }
     discoveryAgent->start();
 }
 
@@ -2205,10 +2241,6 @@ bluetoothdevice *bluetooth::device() {
         return trxappgateusbBike;
     } else if (soleBike) {
         return soleBike;
-    } else if (keepBike) {
-        return keepBike;
-    } else if (ultraSportBike) {
-        return ultraSportBike;
     } else if (horizonTreadmill) {
         return horizonTreadmill;
     } else if (technogymmyrunTreadmill) {
@@ -2237,8 +2269,6 @@ bluetoothdevice *bluetooth::device() {
         return concept2Skierg;
     } else if (smartrowRower) {
         return smartrowRower;
-    } else if (yesoulBike) {
-        return yesoulBike;
     } else if (proformBike) {
         return proformBike;
     } else if (proformTreadmill) {
@@ -2247,26 +2277,14 @@ bluetoothdevice *bluetooth::device() {
         return proformElliptical;
     } else if (proformRower) {
         return proformRower;
-    } else if (eslinkerTreadmill) {
-        return eslinkerTreadmill;
     } else if (bowflexTreadmill) {
         return bowflexTreadmill;
-    } else if (bowflexT216Treadmill) {
-        return bowflexT216Treadmill;
     } else if (pafersTreadmill) {
         return pafersTreadmill;
-    } else if (nautilusTreadmill) {
-        return nautilusTreadmill;
     } else if (flywheelBike) {
         return flywheelBike;
-    } else if (mcfBike) {
-        return mcfBike;
     } else if (schwinnIC4Bike) {
         return schwinnIC4Bike;
-    } else if (sportsTechBike) {
-        return sportsTechBike;
-    } else if (sportsPlusBike) {
-        return sportsPlusBike;
     } else if (inspireBike) {
         return inspireBike;
     } else if (chronoBike) {
@@ -2287,12 +2305,16 @@ bluetoothdevice *bluetooth::device() {
         return pafersBike;
     } else if (fitPlusBike) {
         return fitPlusBike;
-    } else if (skandikaWiriBike) {
-        return skandikaWiriBike;
+    } else if (registryDevice) {
+        return registryDevice;
     }
     return nullptr;
 }
 
+bluetoothdevice *bluetooth::externalInclination() { return eliteRizer; }
+
+bluetoothdevice *bluetooth::heartRateDevice() { return heartRateBelt; }
+
 bool bluetooth::handleSignal(int signal) {
     if (signal == SIGNALS::SIG_INT) {
         qDebug() << QStringLiteral("SIGINT");
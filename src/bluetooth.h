@@ -17,86 +17,76 @@
 #include <QtCore/qbytearray.h>
 #include <QtCore/qloggingcategory.h>
 
-#include "activiotreadmill.h"
-#include "bhfitnesselliptical.h"
+#include "bike.h"
 #include "bluetoothdevice.h"
-#include "bowflext216treadmill.h"
-#include "bowflextreadmill.h"
-#include "chronobike.h"
-#include "concept2skierg.h"
-#include "cscbike.h"
-#include "domyosbike.h"
-#include "domyoselliptical.h"
-#include "domyosrower.h"
-#include "domyostreadmill.h"
-
-#include "echelonconnectsport.h"
-#include "echelonrower.h"
-#include "eliterizer.h"
-#include "elitesterzosmart.h"
-#include "eslinkertreadmill.h"
-#include "fakebike.h"
-#include "fitmetria_fanfit.h"
-#include "fitplusbike.h"
-
-#include "fitshowtreadmill.h"
-#include "flywheelbike.h"
-#include "ftmsbike.h"
-#include "ftmsrower.h"
-#include "heartratebelt.h"
-#include "horizongr7bike.h"
-#include "horizontreadmill.h"
-#include "iconceptbike.h"
-#include "inspirebike.h"
-#include "keepbike.h"
-#include "kingsmithr1protreadmill.h"
-#include "kingsmithr2treadmill.h"
-#include "m3ibike.h"
-#include "mcfbike.h"
-#include "nautilusbike.h"
-#include "nautiluselliptical.h"
-#include "nautilustreadmill.h"
-#include "npecablebike.h"
-#include "pafersbike.h"
-#include "paferstreadmill.h"
-#include "proformbike.h"
-#include "proformelliptical.h"
-#include "proformrower.h"
-#include "proformtreadmill.h"
-#include "proformwifibike.h"
-#include "schwinnic4bike.h"
+#include "elliptical.h"
+#include "rower.h"
 #include "signalhandler.h"
-#include "skandikawiribike.h"
-#include "smartrowrower.h"
 #include "smartspin2k.h"
-#include "snodebike.h"
-#include "strydrunpowersensor.h"
-
-#include "shuaa5treadmill.h"
-#include "solebike.h"
-#include "soleelliptical.h"
-#include "solef80treadmill.h"
-
-#include "spirittreadmill.h"
-#include "sportsplusbike.h"
-#include "sportstechbike.h"
-#include "stagesbike.h"
-
-#include "renphobike.h"
-#include "tacxneo2.h"
-#include "technogymmyruntreadmill.h"
-#include "technogymmyruntreadmillrfcomm.h"
-
-#include "echelonstride.h"
-
 #include "templateinfosenderbuilder.h"
-#include "toorxtreadmill.h"
 #include "treadmill.h"
-#include "trxappgateusbbike.h"
-#include "trxappgateusbtreadmill.h"
-#include "ultrasportbike.h"
-#include "wahookickrsnapbike.h"
-#include "yesoulbike.h"
+#include "virtualbike.h"
+#include "virtualtreadmill.h"
+
+// the drivers are included only by bluetooth.cpp, the ones in the driverregistry not even there
+class activiotreadmill;
+class bhfitnesselliptical;
+class bowflextreadmill;
+class chronobike;
+class concept2skierg;
+class cscbike;
+class domyosbike;
+class domyoselliptical;
+class domyosrower;
+class domyostreadmill;
+class echelonconnectsport;
+class echelonrower;
+class echelonstride;
+class eliterizer;
+class elitesterzosmart;
+class fakebike;
+class fitmetria_fanfit;
+class fitplusbike;
+class fitshowtreadmill;
+class flywheelbike;
+class ftmsbike;
+class ftmsrower;
+class heartratebelt;
+class horizongr7bike;
+class horizontreadmill;
+class iconceptbike;
+class inspirebike;
+class kingsmithr1protreadmill;
+class kingsmithr2treadmill;
+class m3ibike;
+class nautilusbike;
+class nautiluselliptical;
+class npecablebike;
+class pafersbike;
+class paferstreadmill;
+class proformbike;
+class proformelliptical;
+class proformrower;
+class proformtreadmill;
+class proformwifibike;
+class renphobike;
+class schwinnic4bike;
+class shuaa5treadmill;
+class smartrowrower;
+class snodebike;
+class solebike;
+class soleelliptical;
+class solef80treadmill;
+class spirittreadmill;
+class stagesbike;
+class strydrunpowersensor;
+class tacxneo2;
+class technogymmyruntreadmill;
+class technogymmyruntreadmillrfcomm;
+class toorxtreadmill;
+class trxappgateusbbike;
+class trxappgateusbtreadmill;
+class wahookickrsnapbike;
 
 class bluetooth : public QObject, public SignalHandler {
 
@@ -104,15 +94,18 @@ class bluetooth : public QObject, public SignalHandler {
   public:
     explicit bluetooth(bool logs, const QString &deviceName = QLatin1String(""), bool noWriteResistance = false,
                        bool noHeartService = false, uint32_t pollDeviceTime = 200, bool noConsole = false,
-                       bool testResistance = false, uint8_t bikeResistanceOffset = 4, double bikeResistanceGain = 1.0);
+                       bool testResistance = false, uint8_t bikeResistanceOffset = 4, double bikeResistanceGain = 1.0,
+                       int gatewaySlot = -1);
     ~bluetooth();
     bluetoothdevice *device();
-    bluetoothdevice *externalInclination() { return eliteRizer; }
-    bluetoothdevice *heartRateDevice() { return heartRateBelt; }
+    bluetoothdevice *externalInclination();
+    bluetoothdevice *heartRateDevice();
     QList<QBluetoothDeviceInfo> devices;
     bool onlyDiscover = false;
     TemplateInfoSenderBuilder *getUserTemplateManager() const { return userTemplateManager; }
     TemplateInfoSenderBuilder *getInnerTemplateManager() const { return innerTemplateManager; }
+    // studio gateway: the discovery is shared by all the riders, so it's fed from outside
+    void gatewayDeviceDiscovered(const QBluetoothDeviceInfo &device) { deviceDiscovered(device); }
 
   private:
     TemplateInfoSenderBuilder *userTemplateManager = nullptr;
@@ -121,7 +114,6 @@ class bluetooth : public QObject, public SignalHandler {
     QBluetoothDeviceDiscoveryAgent *discoveryAgent;
     bhfitnesselliptical *bhFitnessElliptical = nullptr;
     bowflextreadmill *bowflexTreadmill = nullptr;
-    bowflext216treadmill *bowflexT216Treadmill = nullptr;
     fitshowtreadmill *fitshowTreadmill = nullptr;
     concept2skierg *concept2Skierg = nullptr;
     domyostreadmill *domyos = nullptr;
@@ -135,10 +127,8 @@ class bluetooth : public QObject, public SignalHandler {
     activiotreadmill *activioTreadmill = nullptr;
     nautilusbike *nautilusBike = nullptr;
     nautiluselliptical *nautilusElliptical = nullptr;
-    nautilustreadmill *nautilusTreadmill = nullptr;
     trxappgateusbbike *trxappgateusbBike = nullptr;
     echelonconnectsport *echelonConnectSport = nullptr;
-    yesoulbike *yesoulBike = nullptr;
     flywheelbike *flywheelBike = nullptr;
     proformrower *proformRower = nullptr;
     proformbike *proformBike = nullptr;
@@ -152,15 +142,10 @@ class bluetooth : public QObject, public SignalHandler {
 #endif
     horizongr7bike *horizonGr7Bike = nullptr;
     schwinnic4bike *schwinnIC4Bike = nullptr;
-    sportstechbike *sportsTechBike = nullptr;
-    sportsplusbike *sportsPlusBike = nullptr;
     inspirebike *inspireBike = nullptr;
     snodebike *snodeBike = nullptr;
-    eslinkertreadmill *eslinkerTreadmill = nullptr;
     m3ibike *m3iBike = nullptr;
-    skandikawiribike *skandikaWiriBike = nullptr;
     cscbike *cscBike = nullptr;
-    mcfbike *mcfBike = nullptr;
     npecablebike *npeCableBike = nullptr;
     stagesbike *stagesBike = nullptr;
     solebike *soleBike = nullptr;
@@ -172,7 +157,6 @@ class bluetooth : public QObject, public SignalHandler {
     ftmsrower *ftmsRower = nullptr;
     smartrowrower *smartrowRower = nullptr;
     echelonstride *echelonStride = nullptr;
-    keepbike *keepBike = nullptr;
     kingsmithr1protreadmill *kingsmithR1ProTreadmill = nullptr;
     kingsmithr2treadmill *kingsmithR2Treadmill = nullptr;
     ftmsbike *ftmsBike = nullptr;
@@ -187,12 +171,13 @@ class bluetooth : public QObject, public SignalHandler {
     stagesbike *powerSensor = nullptr;
     strydrunpowersensor *powerSensorRun = nullptr;
     stagesbike *powerBike = nullptr;
-    ultrasportbike *ultraSportBike = nullptr;
     wahookickrsnapbike *wahooKickrSnapBike = nullptr;
     strydrunpowersensor *powerTreadmill = nullptr;
     eliterizer *eliteRizer = nullptr;
     elitesterzosmart *eliteSterzoSmart = nullptr;
     fakebike *fakeBike = nullptr;
+    // the driver matched by the driverregistry
+    bluetoothdevice *registryDevice = nullptr;
     QList<fitmetria_fanfit *> fitmetriaFanfit;
     QString filterDevice = QLatin1String("");
 
@@ -205,6 +190,11 @@ class bluetooth : public QObject, public SignalHandler {
     uint8_t bikeResistanceOffset = 4;
     double bikeResistanceGain = 1.0;
     bool forceHeartBeltOffForTimeout = false;
+    // fast reconnect: the last machine is connected straight from the cache, the scan looks only for the accessories
+    bool fastReconnect = false;
+    bool fastReconnectFailed = false;
+    static const int fastReconnectTimeoutMs = 20000;
+    int gatewaySlot = -1;
 
     bool handleSignal(int signal) override;
     void stateFileUpdate();
@@ -216,6 +206,9 @@ class bluetooth : public QObject, public SignalHandler {
     bool eliteRizerAvaiable();
     bool eliteSterzoSmartAvaiable();
     bool fitmetria_fanfit_isconnected(QString name);
+    void connectAccessories();
+    bool accessoriesMissing();
+    bool fastReconnectStart();
 
   signals:
     void deviceConnected(QBluetoothDeviceInfo b);
@@ -3,7 +3,18 @@
 #include <QSettings>
 #include <QTime>
 
-bluetoothdevice::bluetoothdevice() {}
+bluetoothdevice::bluetoothdevice() {
+    m_watchdog = new linkwatchdog(this);
+    // an idle machine stops notifying: only the silence of a moving device is a stall
+    m_watchdog->setMoving([this]() { return currentSpeed().value() > 0 || currentCadence().value() > 0; });
+    connect(this, &bluetoothdevice::connectedAndDiscovered, this, [this]() {
+        m_watchdog->attach(m_control);
+        m_watchdog->setArmed(!paused);
+    });
+    m_telemetry = QSharedPointer<telemetry>::create();
+    // the type is known from here on, before the first packet
+    connect(this, &bluetoothdevice::connectedAndDiscovered, this, &bluetoothdevice::publishTelemetry);
+}
 
 bluetoothdevice::BLUETOOTH_TYPE bluetoothdevice::deviceType() { return bluetoothdevice::UNKNOWN; }
 void bluetoothdevice::start() { requestStart = 1; }
@@ -128,8 +139,8 @@ double bluetoothdevice::calculateMETS() { return ((0.048 * m_watt.value()) + 1.1
 // keiser m3i has a separate management of this, so please check it
 void bluetoothdevice::update_metrics(bool watt_calc, const double watts) {
 
-    QDateTime current = QDateTime::currentDateTime();
-    double deltaTime = (((double)_lastTimeUpdate.msecsTo(current)) / ((double)1000.0));
+    qint64 current = steadyclock::now();
+    double deltaTime = (((double)(current - _lastTimeUpdate)) / ((double)1000.0));
     QSettings settings;
     bool power_as_bike = settings.value(QStringLiteral("power_sensor_as_bike"), false).toBool();
     bool power_as_treadmill = settings.value(QStringLiteral("power_sensor_as_treadmill"), false).toBool();
@@ -151,7 +162,7 @@ void bluetoothdevice::update_metrics(bool watt_calc, const double watts) {
             m_jouls += (m_watt.value() * deltaTime);
             WeightLoss = metric::calculateWeightLoss(KCal.value());
             if (watt_calc) {
-                m_watt = watts;
+                m_watt = calibratedWatts(watts);
             }
             WattKg = m_watt.value() / settings.value(QStringLiteral("weight"), 75.0).toFloat();
         } else if (m_watt.value() > 0) {
@@ -162,7 +173,7 @@ void bluetoothdevice::update_metrics(bool watt_calc, const double watts) {
     } else if (paused && settings.value(QStringLiteral("instant_power_on_pause"), false).toBool()) {
         // useful for FTP test
         if (watt_calc) {
-            m_watt = watts;
+            m_watt = calibratedWatts(watts);
         }
         WattKg = m_watt.value() / settings.value(QStringLiteral("weight"), 75.0).toFloat();
     } else if (m_watt.value() > 0) {
@@ -170,11 +181,52 @@ void bluetoothdevice::update_metrics(bool watt_calc, const double watts) {
         m_watt = 0;
         WattKg = 0;
     }
+    if (!_firstUpdate && !paused) {
+        m_load.sample(deltaTime, m_watt.value(), currentHeart().value());
+        recordSample();
+    }
     METS = calculateMETS();
     elevationAcc += (currentSpeed().value() / 3600.0) * 1000.0 * (currentInclination().value() / 100.0) * deltaTime;
 
     _lastTimeUpdate = current;
     _firstUpdate = false;
+    publishTelemetry();
+}
+
+void bluetoothdevice::publishTelemetry() {
+    telemetry::snapshot s;
+    s.deviceType = deviceType();
+    s.speed = currentSpeed().value();
+    s.cadence = currentCadence().value();
+    s.watts = wattsMetric().value();
+    s.heart = currentHeart().value();
+    s.heartOverride = metrics_override_heartrate();
+    s.resistance = currentResistance().value();
+    s.inclination = currentInclination().value();
+    s.odometer = odometer();
+    s.crankRevolutions = currentCrankRevolutions();
+    s.lastCrankEventTime = lastCrankEventTime();
+    s.timestamp = steadyclock::now();
+    m_telemetry->publish(s);
+}
+
+void bluetoothdevice::recordSample() {
+    samplebuffer::sample s;
+    s.ms = qRound64(elapsed.value() * 1000.0);
+    s.speed = currentSpeed().value();
+    s.inclination = currentInclination().value();
+    s.watts = m_watt.value();
+    s.cadence = currentCadence().value();
+    s.heart = currentHeart().value();
+    s.resistance = currentResistance().value();
+    s.calories = calories().value();
+    s.elevation = elevationGain().value();
+    s.distance = odometer();
+    const QGeoCoordinate position = currentCordinate();
+    s.latitude = position.isValid() ? position.latitude() : qQNaN();
+    s.longitude = position.longitude();
+    s.altitude = position.altitude();
+    m_samples.append(s, QDateTime::currentMSecsSinceEpoch());
 }
 
 void bluetoothdevice::clearStats() {
@@ -189,12 +241,15 @@ void bluetoothdevice::clearStats() {
     elevationAcc = 0;
     m_watt.clear(false);
     WeightLoss.clear(false);
+    m_load.reset();
+    m_samples.clear();
     WattKg.clear(false);
 }
 
 void bluetoothdevice::setPaused(bool p) {
 
     paused = p;
+    m_watchdog->setArmed(!p);
     moving.setPaused(p);
     elapsed.setPaused(p);
     Speed.setPaused(p);
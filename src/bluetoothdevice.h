@@ -1,12 +1,17 @@
 #ifndef BLUETOOTHDEVICE_H
 #define BLUETOOTHDEVICE_H
 
+#include "linkwatchdog.h"
 #include "metric.h"
+#include "samplebuffer.h"
+#include "telemetry.h"
+#include "trainingload.h"
 #include <QBluetoothDeviceDiscoveryAgent>
 #include <QBluetoothDeviceInfo>
 #include <QDateTime>
 #include <QGeoCoordinate>
 #include <QObject>
+#include <QSharedPointer>
 #include <QTimer>
 
 #include <QtBluetooth/qlowenergyadvertisingdata.h>
@@ -71,11 +76,24 @@ class bluetoothdevice : public QObject {
     metric currentMETS() { return METS; }
     metric currentHeartZone() {return HeartZone;}
     metric currentPowerZone() {return PowerZone;}
+    const trainingload &trainingLoad() { return m_load; }
+    const samplebuffer &recording() { return m_samples; }
 
     // in the future these 2 should be calculated inside the update_metrics()
     void setHeartZone(double hz) {HeartZone = hz;}
     void setPowerZone(double pz) {PowerZone = pz;}
 
+    // index of the rider when the device is driven by the studio gateway, -1 otherwise
+    int gatewaySlot() { return m_gatewaySlot; }
+    void setGatewaySlot(int slot) { m_gatewaySlot = slot; }
+
+    // stalls and recoveries of the bluetooth link
+    linkwatchdog *linkWatchdog() { return m_watchdog; }
+
+    // copy of the live values for the consumers on other threads, published at every update_metrics (so at every
+    // packet of the device) and when the device is connected
+    QSharedPointer<telemetry> liveTelemetry() { return m_telemetry; }
+
     enum BLUETOOTH_TYPE { UNKNOWN = 0, TREADMILL, BIKE, ROWING, ELLIPTICAL };
     enum WORKOUT_EVENT_STATE { STARTED = 0, PAUSED = 1, RESUMED = 2, STOPPED = 3 };
 
@@ -96,6 +114,7 @@ class bluetoothdevice : public QObject {
     virtual void changeInclination(double grade, double percentage);
     virtual void changeGeoPosition(QGeoCoordinate p);
     virtual void workoutEventStateChanged(bluetoothdevice::WORKOUT_EVENT_STATE state);
+    void publishTelemetry();
 
   Q_SIGNALS:
     void connectedAndDiscovered();
@@ -133,15 +152,24 @@ class bluetoothdevice : public QObject {
     metric Inclination;
     metric HeartZone;
     metric PowerZone;
+    trainingload m_load;
+    samplebuffer m_samples;
 
     bluetoothdevice::WORKOUT_EVENT_STATE lastState;
     bool paused = false;
     bool autoResistanceEnable = true;
+    int m_gatewaySlot = -1;
+    linkwatchdog *m_watchdog = nullptr;
+    QSharedPointer<telemetry> m_telemetry;
 
-    QDateTime _lastTimeUpdate;
+    qint64 _lastTimeUpdate = 0;
     bool _firstUpdate = true;
     void update_metrics(bool watt_calc, const double watts);
     double calculateMETS();
+    void recordSample();
+
+    // hook for the devices that can replace the estimated power with a better model
+    virtual double calibratedWatts(double watts) { return watts; }
 };
 
 #endif // BLUETOOTHDEVICE_H
@@ -1,4 +1,5 @@
 #include "bowflext216treadmill.h"
+#include "driverregistry.h"
 #include "keepawakehelper.h"
 #include "virtualtreadmill.h"
 #include <QBluetoothLocalDevice>
@@ -14,6 +15,9 @@ using namespace std::chrono_literals;
 extern quint8 QZ_EnableDiscoveryCharsAndDescripttors;
 #endif
 
+DRIVERREGISTRY_ADD(bowflext216treadmill, new bowflext216treadmill(p.pollDeviceTime, p.noConsole, p.noHeartService),
+                   QStringLiteral("BOWFLEX T216"));
+
 bowflext216treadmill::bowflext216treadmill(uint32_t pollDeviceTime, bool noConsole, bool noHeartService,
                                            double forceInitSpeed, double forceInitInclination) {
 
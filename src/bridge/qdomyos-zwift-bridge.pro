@@ -0,0 +1,57 @@
+# Headless bridge for the Raspberry Pi and the other boxes without a screen:
+# discovery, drivers, metrics, session recording and export, virtual devices, dircon and the web server,
+# without QtQuick, Widgets, QtCharts and QtWebView.
+#
+# cd src/bridge
+# qmake
+# make
+
+QZ_SRC = $$PWD/..
+VPATH += $$QZ_SRC
+include($$QZ_SRC/qdomyos-zwift.pro)
+
+TARGET = qdomyos-zwift-bridge
+DEFINES += QZ_BRIDGE
+DEFINES -= CHARTJS
+
+QT -= widgets quick quickcontrols2 charts webview
+QT += qml
+CONFIG -= qmltypes qtquickcompiler app_bundle
+
+SOURCES -= \
+   homeform.cpp \
+   tilemodel.cpp \
+   keepawakehelper.cpp \
+   screencapture.cpp \
+   mainwindow.cpp \
+   charts.cpp \
+   $$QZ_SRC/purchasing/qmltypes/inappproductqmltype.cpp \
+   $$QZ_SRC/purchasing/qmltypes/inappstoreqmltype.cpp \
+   $$QZ_SRC/purchasing/inapp/inappproduct.cpp \
+   $$QZ_SRC/purchasing/inapp/inapppurchasebackend.cpp \
+   $$QZ_SRC/purchasing/inapp/inappstore.cpp \
+   $$QZ_SRC/purchasing/inapp/inapptransaction.cpp
+
+HEADERS -= \
+   homeform.h \
+   tilemodel.h \
+   keepawakehelper.h \
+   screencapture.h \
+   mainwindow.h \
+   charts.h \
+   $$QZ_SRC/purchasing/qmltypes/inappproductqmltype.h \
+   $$QZ_SRC/purchasing/qmltypes/inappstoreqmltype.h \
+   $$QZ_SRC/purchasing/inapp/inappproduct.h \
+   $$QZ_SRC/purchasing/inapp/inapppurchasebackend.h \
+   $$QZ_SRC/purchasing/inapp/inappstore.h \
+   $$QZ_SRC/purchasing/inapp/inapptransaction.h
+
+FORMS -= charts.ui mainwindow.ui
+
+# only the templates and the web server pages are served from the resources, the QtQuick UI is left out
+RESOURCES -= icons.qrc qml.qrc templates.qrc
+RESOURCES += $$QZ_SRC/templates.qrc
+
+INCLUDEPATH += $$QZ_SRC $$QZ_SRC/fit-sdk $$QZ_SRC/qmdnsengine/src/include
+
+target.path = /opt/$${TARGET}/bin
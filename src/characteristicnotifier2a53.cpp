@@ -2,17 +2,18 @@
 #include "treadmill.h"
 
 CharacteristicNotifier2A53::CharacteristicNotifier2A53(bluetoothdevice *Bike, QObject *parent)
-    : CharacteristicNotifier(0x2a53, parent), Bike(Bike) {}
+    : CharacteristicNotifier(0x2a53, parent), live(Bike->liveTelemetry()) {}
 
 int CharacteristicNotifier2A53::notify(QByteArray &value) {
-    bluetoothdevice::BLUETOOTH_TYPE dt = Bike->deviceType();
+    const telemetry::snapshot s = live->last();
+    bluetoothdevice::BLUETOOTH_TYPE dt = (bluetoothdevice::BLUETOOTH_TYPE)s.deviceType;
     if (dt == bluetoothdevice::TREADMILL || dt == bluetoothdevice::ELLIPTICAL) {
         value.append(0x02); // total distance
-        uint16_t speed = Bike->currentSpeed().value() / 3.6 * 256;
-        uint32_t distance = Bike->odometer() * 10000.0;
+        uint16_t speed = s.speed / 3.6 * 256;
+        uint32_t distance = s.odometer * 10000.0;
         value.append((char)((speed & 0xFF)));
         value.append((char)((speed >> 8) & 0xFF));
-        value.append((char)(Bike->currentCadence().value()));
+        value.append((char)(s.cadence));
         value.append((char)((distance & 0xFF)));
         value.append((char)((distance >> 8) & 0xFF));
         value.append((char)((distance >> 16) & 0xFF));
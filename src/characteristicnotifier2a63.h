@@ -5,7 +5,7 @@
 #include "characteristicnotifier.h"
 
 class CharacteristicNotifier2A63 : public CharacteristicNotifier {
-    bluetoothdevice *Bike;
+    QSharedPointer<telemetry> live;
 
   public:
     explicit CharacteristicNotifier2A63(bluetoothdevice *Bike, QObject *parent = nullptr);
@@ -3,15 +3,16 @@
 #include <qmath.h>
 
 CharacteristicNotifier2ACD::CharacteristicNotifier2ACD(bluetoothdevice *Bike, QObject *parent)
-    : CharacteristicNotifier(0x2acd, parent), Bike(Bike) {}
+    : CharacteristicNotifier(0x2acd, parent), live(Bike->liveTelemetry()) {}
 
 int CharacteristicNotifier2ACD::notify(QByteArray &value) {
-    bluetoothdevice::BLUETOOTH_TYPE dt = Bike->deviceType();
+    const telemetry::snapshot s = live->last();
+    bluetoothdevice::BLUETOOTH_TYPE dt = (bluetoothdevice::BLUETOOTH_TYPE)s.deviceType;
     if (dt == bluetoothdevice::TREADMILL || dt == bluetoothdevice::ELLIPTICAL) {
         value.append(0x08);       // Inclination avaiable
         value.append((char)0x01); // heart rate avaiable
 
-        uint16_t normalizeSpeed = (uint16_t)qRound(Bike->currentSpeed().value() * 100);
+        uint16_t normalizeSpeed = (uint16_t)qRound(s.speed * 100);
         char a = (normalizeSpeed >> 8) & 0XFF;
         char b = normalizeSpeed & 0XFF;
         QByteArray speedBytes;
@@ -19,7 +20,7 @@ int CharacteristicNotifier2ACD::notify(QByteArray &value) {
         speedBytes.append(a);
         uint16_t normalizeIncline = 0;
         if (dt == bluetoothdevice::TREADMILL)
-            normalizeIncline = (uint32_t)qRound(((treadmill *)Bike)->currentInclination().value() * 10);
+            normalizeIncline = (uint32_t)qRound(s.inclination * 10);
         a = (normalizeIncline >> 8) & 0XFF;
         b = normalizeIncline & 0XFF;
         QByteArray inclineBytes;
@@ -27,7 +28,7 @@ int CharacteristicNotifier2ACD::notify(QByteArray &value) {
         inclineBytes.append(a);
         double ramp = 0;
         if (dt == bluetoothdevice::TREADMILL)
-            ramp = qRadiansToDegrees(qAtan(((treadmill *)Bike)->currentInclination().value() / 100));
+            ramp = qRadiansToDegrees(qAtan(s.inclination / 100));
         int16_t normalizeRamp = (int32_t)qRound(ramp * 10);
         a = (normalizeRamp >> 8) & 0XFF;
         b = normalizeRamp & 0XFF;
@@ -41,7 +42,7 @@ int CharacteristicNotifier2ACD::notify(QByteArray &value) {
 
         value.append(rampBytes); // ramp angle
 
-        value.append(Bike->currentHeart().value()); // current heart rate
+        value.append(s.heart); // current heart rate
         return CN_OK;
     } else
         return CN_INVALID;
@@ -4,7 +4,7 @@
 #include "characteristicnotifier.h"
 
 class CharacteristicNotifier2ACD : public CharacteristicNotifier {
-    bluetoothdevice *Bike;
+    QSharedPointer<telemetry> live;
 
   public:
     explicit CharacteristicNotifier2ACD(bluetoothdevice *Bike, QObject *parent = nullptr);
@@ -3,33 +3,34 @@
 #include "elliptical.h"
 
 CharacteristicNotifier2AD2::CharacteristicNotifier2AD2(bluetoothdevice *Bike, QObject *parent)
-    : CharacteristicNotifier(0x2ad2, parent), Bike(Bike) {}
+    : CharacteristicNotifier(0x2ad2, parent), live(Bike->liveTelemetry()) {}
 
 int CharacteristicNotifier2AD2::notify(QByteArray &value) {
-    bluetoothdevice::BLUETOOTH_TYPE dt = Bike->deviceType();
-    double normalizeWattage = Bike->wattsMetric().value();
+    const telemetry::snapshot s = live->last();
+    bluetoothdevice::BLUETOOTH_TYPE dt = (bluetoothdevice::BLUETOOTH_TYPE)s.deviceType;
+    double normalizeWattage = s.watts;
     if (normalizeWattage < 0)
        normalizeWattage = 0;      
 
     if (dt == bluetoothdevice::BIKE) {
-        uint16_t normalizeSpeed = (uint16_t)qRound(Bike->currentSpeed().value() * 100);
+        uint16_t normalizeSpeed = (uint16_t)qRound(s.speed * 100);
         value.append((char)0x64); // speed, inst. cadence, resistance lvl, instant power
         value.append((char)0x02); // heart rate
 
         value.append((char)(normalizeSpeed & 0xFF));      // speed
         value.append((char)(normalizeSpeed >> 8) & 0xFF); // speed
 
-        value.append((char)((uint16_t)(Bike->currentCadence().value() * 2) & 0xFF));        // cadence
-        value.append((char)(((uint16_t)(Bike->currentCadence().value() * 2) >> 8) & 0xFF)); // cadence
+        value.append((char)((uint16_t)(s.cadence * 2) & 0xFF));        // cadence
+        value.append((char)(((uint16_t)(s.cadence * 2) >> 8) & 0xFF)); // cadence
 
-        value.append((char)Bike->currentResistance().value()); // resistance
-        value.append((char)(0));                               // resistance
+        value.append((char)s.resistance); // resistance
+        value.append((char)(0));          // resistance
 
         value.append((char)(((uint16_t)normalizeWattage) & 0xFF));      // watts
         value.append((char)(((uint16_t)normalizeWattage) >> 8) & 0xFF); // watts
 
-        value.append(char(Bike->currentHeart().value())); // Actual value.
-        value.append((char)0);                            // Bkool FTMS protocol HRM offset 1280 fix
+        value.append(char(s.heart)); // Actual value.
+        value.append((char)0);       // Bkool FTMS protocol HRM offset 1280 fix
         return CN_OK;
     } else if (dt == bluetoothdevice::TREADMILL || dt == bluetoothdevice::ELLIPTICAL) {
         QSettings settings;
@@ -37,7 +38,7 @@ int CharacteristicNotifier2AD2::notify(QByteArray &value) {
         double cadence_multiplier = 2.0;
         if (double_cadence)
             cadence_multiplier = 1.0;      
-        uint16_t normalizeSpeed = (uint16_t)qRound(Bike->currentSpeed().value() * 100);
+        uint16_t normalizeSpeed = (uint16_t)qRound(s.speed * 100);
         value.append((char)0x64); // speed, inst. cadence, resistance lvl, instant power
         value.append((char)0x02); // heart rate
 
@@ -46,7 +47,7 @@ int CharacteristicNotifier2AD2::notify(QByteArray &value) {
 
         uint16_t cadence = 0;
         if (dt == bluetoothdevice::ELLIPTICAL)
-            cadence = ((elliptical *)Bike)->currentCadence().value();
+            cadence = s.cadence;
 
         value.append((char)((uint16_t)(cadence * cadence_multiplier) & 0xFF));        // cadence
         value.append((char)(((uint16_t)(cadence * cadence_multiplier) >> 8) & 0xFF)); // cadence
@@ -57,7 +58,7 @@ int CharacteristicNotifier2AD2::notify(QByteArray &value) {
         value.append((char)(((uint16_t)normalizeWattage) & 0xFF));      // watts
         value.append((char)(((uint16_t)normalizeWattage) >> 8) & 0xFF); // watts
 
-        value.append(char(Bike->currentHeart().value())); // Actual value.
+        value.append(char(s.heart)); // Actual value.
         value.append((char)0);
         return CN_OK;
     } else
@@ -5,7 +5,7 @@
 #include "characteristicnotifier.h"
 
 class CharacteristicNotifier2AD2 : public CharacteristicNotifier {
-    bluetoothdevice *Bike;
+    QSharedPointer<telemetry> live;
 
   public:
     explicit CharacteristicNotifier2AD2(bluetoothdevice *Bike, QObject *parent = nullptr);
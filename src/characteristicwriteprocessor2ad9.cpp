@@ -9,11 +9,20 @@ CharacteristicWriteProcessor2AD9::CharacteristicWriteProcessor2AD9(double bikeRe
                                                                    uint8_t bikeResistanceOffset, bluetoothdevice *bike,
                                                                    QObject *parent)
     : CharacteristicWriteProcessor(parent), bikeResistanceOffset(bikeResistanceOffset),
-      bikeResistanceGain(bikeResistanceGain), Bike(bike) {}
+      bikeResistanceGain(bikeResistanceGain), dt(bike->deviceType()) {
+    qRegisterMetaType<CharacteristicWriteProcessor2AD9::deviceCommand>();
+    // auto connection with the device as context: queued when the command comes from another thread, and dropped
+    // by Qt if the device is destroyed in the meantime
+    connect(this, &CharacteristicWriteProcessor2AD9::commandForDevice, bike,
+            [bike](const CharacteristicWriteProcessor2AD9::deviceCommand &command) { command(bike); });
+}
+
+void CharacteristicWriteProcessor2AD9::runOnDevice(const std::function<void(bluetoothdevice *)> &f) {
+    emit commandForDevice(f);
+}
 
 int CharacteristicWriteProcessor2AD9::writeProcess(quint16 uuid, const QByteArray &data, QByteArray &reply) {
     if (data.size()) {
-        bluetoothdevice::BLUETOOTH_TYPE dt = Bike->deviceType();
         if (dt == bluetoothdevice::BIKE) {
             QSettings settings;
             bool force_resistance = settings.value(QStringLiteral("virtualbike_forceresistance"), true).toBool();
@@ -26,7 +35,7 @@ int CharacteristicWriteProcessor2AD9::writeProcess(quint16 uuid, const QByteArra
                 uint8_t uresistance = data.at(1);
                 uresistance = uresistance / 10;
                 if (force_resistance && !erg_mode) {
-                    Bike->changeResistance(uresistance);
+                    runOnDevice([uresistance](bluetoothdevice *d) { d->changeResistance(uresistance); });
                 }
                 qDebug() << QStringLiteral("new requested resistance ") + QString::number(uresistance) +
                                 QStringLiteral(" enabled ") + force_resistance;
@@ -82,7 +91,7 @@ int CharacteristicWriteProcessor2AD9::writeProcess(quint16 uuid, const QByteArra
                 uint16_t uspeed = a + (((uint16_t)b) << 8);
                 double requestSpeed = (double)uspeed / 100.0;
                 if (dt == bluetoothdevice::TREADMILL) {
-                    ((treadmill *)Bike)->changeSpeed(requestSpeed);
+                    runOnDevice([requestSpeed](bluetoothdevice *d) { ((treadmill *)d)->changeSpeed(requestSpeed); });
                 }
                 qDebug() << QStringLiteral("new requested speed ") + QString::number(requestSpeed);
             } else if ((char)data.at(0) == 0x03) // Set Target Inclination
@@ -96,10 +105,14 @@ int CharacteristicWriteProcessor2AD9::writeProcess(quint16 uuid, const QByteArra
                     requestIncline = 0;
 
                 if (dt == bluetoothdevice::TREADMILL)
-                    ((treadmill *)Bike)->changeInclination(requestIncline, requestIncline);
+                    runOnDevice([requestIncline](bluetoothdevice *d) {
+                        ((treadmill *)d)->changeInclination(requestIncline, requestIncline);
+                    });
                 // Resistance as incline on Sole E95s Elliptical #419
                 else if (dt == bluetoothdevice::ELLIPTICAL)
-                    ((elliptical *)Bike)->changeInclination(requestIncline, requestIncline);
+                    runOnDevice([requestIncline](bluetoothdevice *d) {
+                        ((elliptical *)d)->changeInclination(requestIncline, requestIncline);
+                    });
                 qDebug() << "new requested incline " + QString::number(requestIncline);
             } else if ((char)data.at(0) == 0x07) // Start request
             {
@@ -124,10 +137,11 @@ int CharacteristicWriteProcessor2AD9::writeProcess(quint16 uuid, const QByteArra
         return CP_INVALID;
 }
 
-void CharacteristicWriteProcessor2AD9::changePower(uint16_t power) { Bike->changePower(power); }
+void CharacteristicWriteProcessor2AD9::changePower(uint16_t power) {
+    runOnDevice([power](bluetoothdevice *d) { d->changePower(power); });
+}
 
 void CharacteristicWriteProcessor2AD9::changeSlope(int16_t iresistance) {
-    bluetoothdevice::BLUETOOTH_TYPE dt = Bike->deviceType();
     if (dt == bluetoothdevice::BIKE) {
       QSettings settings;
       bool force_resistance = settings.value(QStringLiteral("virtualbike_forceresistance"), true).toBool();
@@ -144,8 +158,10 @@ void CharacteristicWriteProcessor2AD9::changeSlope(int16_t iresistance) {
 
       double grade = ((iresistance / 100.0) * gain) + offset;
       // if the bike doesn't have the inclination by hardware, i'm simulating inclination with the value received form Zwift
-      if(!((bike*)Bike)->inclinationAvailableByHardware())
-          Bike->setInclination(grade);
+      runOnDevice([grade](bluetoothdevice *d) {
+          if (!((bike *)d)->inclinationAvailableByHardware())
+              d->setInclination(grade);
+      });
 
       if (iresistance >= 0 || !zwift_negative_inclination_x2)
           emit changeInclination(grade,
@@ -156,8 +172,9 @@ void CharacteristicWriteProcessor2AD9::changeSlope(int16_t iresistance) {
 
       if (force_resistance && !erg_mode) {
           // same on the training program
-          Bike->changeResistance((int8_t)(round(resistance * bikeResistanceGain)) + bikeResistanceOffset +
-                                 1); // resistance start from 1
+          // resistance start from 1
+          const int8_t res = (int8_t)(round(resistance * bikeResistanceGain)) + bikeResistanceOffset + 1;
+          runOnDevice([res](bluetoothdevice *d) { d->changeResistance(res); });
       }
     } else if (dt == bluetoothdevice::TREADMILL || dt == bluetoothdevice::ELLIPTICAL) {
       QSettings settings;
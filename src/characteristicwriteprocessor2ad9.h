@@ -3,14 +3,20 @@
 
 #include "bluetoothdevice.h"
 #include "characteristicwriteprocessor.h"
+#include <functional>
 
 class CharacteristicWriteProcessor2AD9 : public CharacteristicWriteProcessor {
     Q_OBJECT
     uint8_t bikeResistanceOffset = 4;
     double bikeResistanceGain = 1.0;
-    bluetoothdevice *Bike;
+    bluetoothdevice::BLUETOOTH_TYPE dt;
+    // the commands run on the thread of the driver, also when they come from the Dircon I/O thread: the device is
+    // never touched from here, the command is posted to it through commandForDevice
+    void runOnDevice(const std::function<void(bluetoothdevice *)> &f);
 
   public:
+    typedef std::function<void(bluetoothdevice *)> deviceCommand;
+
     explicit CharacteristicWriteProcessor2AD9(double bikeResistanceGain, uint8_t bikeResistanceOffset,
                                               bluetoothdevice *bike, QObject *parent = nullptr);
     virtual int writeProcess(quint16 uuid, const QByteArray &data, QByteArray &out);
@@ -20,6 +26,9 @@ class CharacteristicWriteProcessor2AD9 : public CharacteristicWriteProcessor {
     void changeInclination(double grade, double percentage);
     void slopeChanged();
     void ftmsCharacteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue);
+    void commandForDevice(const CharacteristicWriteProcessor2AD9::deviceCommand &command);
 };
 
+Q_DECLARE_METATYPE(CharacteristicWriteProcessor2AD9::deviceCommand)
+
 #endif // CHARACTERISTICWRITEPROCESSOR2AD9_H
@@ -1,5 +1,6 @@
 #include "charts.h"
 #include "ui_charts.h"
+#include <QSettings>
 
 charts::charts(MainWindow *parent) : QDialog(parent), ui(new Ui::charts) {
     ui->setupUi(this);
@@ -41,6 +42,28 @@ charts::charts(MainWindow *parent) : QDialog(parent), ui(new Ui::charts) {
     chart_series_watt->setName(QStringLiteral("Watt (W)"));
     chart_series_resistance->setName(QStringLiteral("Resistance (lvl)"));
 
+    // 0 is the whole workout, otherwise the last seconds of it
+    QSettings settings;
+    const int window = settings.value(QStringLiteral("charts_window"), 0).toInt();
+    setWindow(window);
+    ui->window->blockSignals(true);
+    ui->window->setValue(window);
+    ui->window->blockSignals(false);
+
+    axisX = new QtCharts::QValueAxis();
+    axisY = new QtCharts::QValueAxis();
+    chart->addAxis(axisX, Qt::AlignBottom);
+    chart->addAxis(axisY, Qt::AlignLeft);
+    for (QtCharts::QLineSeries *series : {chart_series_inclination, chart_series_speed, chart_series_pace,
+                                          chart_series_heart, chart_series_watt, chart_series_resistance}) {
+        chart->addSeries(series);
+        series->attachAxis(axisX);
+        series->attachAxis(axisY);
+    }
+    for (QPushButton *button : {ui->speed, ui->pace, ui->inclination, ui->heart, ui->watt, ui->resistance}) {
+        connect(button, &QPushButton::toggled, this, &charts::refresh);
+    }
+
     chart->legend()->setAlignment(Qt::AlignBottom);
     chart_view->setRenderHint(QPainter::Antialiasing);
     chart_view->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
@@ -49,75 +72,89 @@ charts::charts(MainWindow *parent) : QDialog(parent), ui(new Ui::charts) {
 }
 
 void charts::update() {
-    if (!chart->series().isEmpty()) {
-        if (ui->speed->isChecked()) {
-            chart->removeSeries(chart_series_speed);
-        }
-        if (ui->pace->isChecked()) {
-            chart->removeSeries(chart_series_pace);
-        }
-        if (ui->inclination->isChecked()) {
-            chart->removeSeries(chart_series_inclination);
-        }
-        if (ui->heart->isChecked()) {
-            chart->removeSeries(chart_series_heart);
-        }
-        if (ui->watt->isChecked()) {
-            chart->removeSeries(chart_series_watt);
-        }
-        if (ui->resistance->isChecked()) {
-            chart->removeSeries(chart_series_resistance);
-        }
+    const QList<SessionLine> &session = parent->Session;
+    if (session.count() < consumed) {
+        points_speed.clear();
+        points_pace.clear();
+        points_inclination.clear();
+        points_heart.clear();
+        points_watt.clear();
+        points_resistance.clear();
+        consumed = 0;
     }
-    chart_series_inclination->clear();
-    chart_series_speed->clear();
-    chart_series_pace->clear();
-    chart_series_heart->clear();
-    chart_series_watt->clear();
-    chart_series_resistance->clear();
-    const int maxQueue = 100;
-
-    for (int g = 0; g < (parent->Session.count() > maxQueue ? maxQueue : parent->Session.count()); g++) {
-        int index = g + (parent->Session.count() > maxQueue ? parent->Session.count() % maxQueue : 0);
-        if (ui->inclination->isChecked()) {
-            chart_series_inclination->append(g, static_cast<double>(parent->Session[index].inclination));
-        }
-        if (ui->speed->isChecked()) {
-            chart_series_speed->append(g, static_cast<qreal>(parent->Session[index].speed));
-        }
-        if (ui->pace->isChecked()) {
-            chart_series_pace->append(g, static_cast<qreal>(parent->Session[index].pace));
-        }
-        if (ui->heart->isChecked()) {
-            chart_series_heart->append(g, static_cast<qreal>(parent->Session[index].heart));
-        }
-        if (ui->watt->isChecked()) {
-            chart_series_watt->append(g, static_cast<qreal>(parent->Session[index].watt));
-        }
-        if (ui->resistance->isChecked()) {
-            chart_series_resistance->append(g, static_cast<qreal>(parent->Session[index].resistance));
-        }
+    if (session.count() == consumed) {
+        return;
     }
 
-    if (ui->inclination->isChecked()) {
-        chart->addSeries(chart_series_inclination);
-    }
-    if (ui->speed->isChecked()) {
-        chart->addSeries(chart_series_speed);
-    }
-    if (ui->pace->isChecked()) {
-        chart->addSeries(chart_series_pace);
+    for (; consumed < session.count(); consumed++) {
+        const SessionLine &s = session.at(consumed);
+        const double x = s.elapsedTime;
+        points_speed.append(x, s.speed);
+        points_pace.append(x, s.pace);
+        points_inclination.append(x, s.inclination);
+        points_heart.append(x, s.heart);
+        points_watt.append(x, s.watt);
+        points_resistance.append(x, s.resistance);
     }
-    if (ui->heart->isChecked()) {
-        chart->addSeries(chart_series_heart);
-    }
-    if (ui->watt->isChecked()) {
-        chart->addSeries(chart_series_watt);
+    refresh();
+}
+
+void charts::refresh() {
+    struct line {
+        QtCharts::QLineSeries *series;
+        chartseries *points;
+        bool visible;
+    };
+    const line lines[] = {{chart_series_speed, &points_speed, ui->speed->isChecked()},
+                          {chart_series_pace, &points_pace, ui->pace->isChecked()},
+                          {chart_series_inclination, &points_inclination, ui->inclination->isChecked()},
+                          {chart_series_heart, &points_heart, ui->heart->isChecked()},
+                          {chart_series_watt, &points_watt, ui->watt->isChecked()},
+                          {chart_series_resistance, &points_resistance, ui->resistance->isChecked()}};
+
+    // only the visible series are rebuilt, the hidden ones get their points when they're shown again
+    bool empty = true;
+    double minX = 0, maxX = 0, minY = 0, maxY = 0;
+    for (const line &l : lines) {
+        l.series->setVisible(l.visible);
+        if (!l.visible || l.points->isEmpty()) {
+            continue;
+        }
+        l.series->replace(l.points->points());
+        if (empty) {
+            minX = l.points->minX();
+            maxX = l.points->maxX();
+            minY = l.points->minY();
+            maxY = l.points->maxY();
+            empty = false;
+        } else {
+            minX = qMin(minX, l.points->minX());
+            maxX = qMax(maxX, l.points->maxX());
+            minY = qMin(minY, l.points->minY());
+            maxY = qMax(maxY, l.points->maxY());
+        }
     }
-    if (ui->resistance->isChecked()) {
-        chart->addSeries(chart_series_resistance);
+    if (!empty) {
+        axisX->setRange(minX, qMax(maxX, minX + 1));
+        axisY->setRange(minY, qMax(maxY, minY + 1));
     }
-    chart->createDefaultAxes();
+}
+
+void charts::setWindow(int seconds) {
+    points_speed = chartseries(seconds);
+    points_pace = chartseries(seconds);
+    points_inclination = chartseries(seconds);
+    points_heart = chartseries(seconds);
+    points_watt = chartseries(seconds);
+    points_resistance = chartseries(seconds);
+    consumed = 0;
+}
+
+void charts::on_window_valueChanged(int seconds) {
+    QSettings settings;
+    settings.setValue(QStringLiteral("charts_window"), seconds);
+    setWindow(seconds);
+    update();
 }
 
 charts::~charts() { delete ui; }
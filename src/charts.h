@@ -1,6 +1,7 @@
 #ifndef CHARTS_H
 #define CHARTS_H
 
+#include "chartseries.h"
 #include "mainwindow.h"
 #include <QDialog>
 #include <QtCharts>
@@ -14,6 +15,7 @@ class charts : public QDialog {
 
   public:
     explicit charts(MainWindow *parent = nullptr);
+    // appends only the session lines that arrived after the last call
     void update();
     ~charts();
 
@@ -30,7 +32,13 @@ class charts : public QDialog {
 
     void on_heart_clicked();
 
+    void on_window_valueChanged(int seconds);
+
   private:
+    void refresh();
+    // 0 is the whole workout; the series are rebuilt from the session
+    void setWindow(int seconds);
+
     Ui::charts *ui;
     MainWindow *parent = nullptr;
 
@@ -42,6 +50,16 @@ class charts : public QDialog {
     QtCharts::QLineSeries *chart_series_watt = nullptr;
     QtCharts::QLineSeries *chart_series_resistance = nullptr;
     QtCharts::QLineSeries *chart_series_pace = nullptr;
+    QtCharts::QValueAxis *axisX = nullptr;
+    QtCharts::QValueAxis *axisY = nullptr;
+
+    chartseries points_speed;
+    chartseries points_inclination;
+    chartseries points_heart;
+    chartseries points_watt;
+    chartseries points_resistance;
+    chartseries points_pace;
+    int consumed = 0; // session lines already in the series
 };
 
 #endif // CHARTS_H
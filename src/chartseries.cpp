@@ -0,0 +1,100 @@
+#include "chartseries.h"
+#include <QtMath>
+
+chartseries::chartseries(int window, int buckets) : m_window(qMax(window, 0)), m_buckets(qMax(buckets, 2)) {
+    ring.resize(m_buckets + 2);
+    m_points.reserve(ring.size() * 2);
+    clear();
+}
+
+void chartseries::clear() {
+    head = 0;
+    count = 0;
+    span = m_window ? qMax(1.0, double(m_window) / m_buckets) : 1.0;
+    m_points.resize(0);
+    m_minY = 0;
+    m_maxY = 0;
+}
+
+void chartseries::merge() {
+    span *= 2;
+    int n = 0;
+    for (int i = 0; i < count; i++) {
+        const bucket b = at(i);
+        const qint64 key = b.key / 2;
+        if (n && at(n - 1).key == key) {
+            bucket &last = at(n - 1);
+            if (b.min.y() < last.min.y()) {
+                last.min = b.min;
+            }
+            if (b.max.y() > last.max.y()) {
+                last.max = b.max;
+            }
+        } else {
+            bucket &out = at(n++);
+            out = b;
+            out.key = key;
+        }
+    }
+    count = n;
+}
+
+void chartseries::append(double x, double y) {
+    qint64 key = qFloor(x / span);
+    if (!m_window) {
+        while (count >= m_buckets && key > at(count - 1).key) {
+            merge();
+            key = qFloor(x / span);
+        }
+    }
+
+    // x going back (a new session without a clear) stays in the last bucket
+    if (count && key <= at(count - 1).key) {
+        bucket &b = at(count - 1);
+        if (y < b.min.y()) {
+            b.min = QPointF(x, y);
+        }
+        if (y > b.max.y()) {
+            b.max = QPointF(x, y);
+        }
+        return;
+    }
+
+    if (m_window) {
+        while (count && (at(0).key + 1) * span <= x - m_window) {
+            head = (head + 1) % ring.size();
+            count--;
+        }
+    }
+    if (count == ring.size()) {
+        head = (head + 1) % ring.size();
+        count--;
+    }
+    bucket &b = at(count++);
+    b.key = key;
+    b.min = QPointF(x, y);
+    b.max = b.min;
+}
+
+const QVector<QPointF> &chartseries::points() {
+    m_points.resize(0);
+    for (int i = 0; i < count; i++) {
+        const bucket &b = at(i);
+        if (!i || b.min.y() < m_minY) {
+            m_minY = b.min.y();
+        }
+        if (!i || b.max.y() > m_maxY) {
+            m_maxY = b.max.y();
+        }
+        if (b.min == b.max) {
+            m_points.append(b.min);
+        } else if (b.min.x() <= b.max.x()) {
+            m_points.append(b.min);
+            m_points.append(b.max);
+        } else {
+            m_points.append(b.max);
+            m_points.append(b.min);
+        }
+    }
+    return m_points;
+}
@@ -0,0 +1,49 @@
+#ifndef CHARTSERIES_H
+#define CHARTSERIES_H
+
+#include <QPointF>
+#include <QVector>
+
+// Points of a live chart, fed one sample at a time. The samples are kept in a ring of buckets with their minimum and
+// maximum, so an append costs O(1) and the chart gets at most 2 points per bucket, in time order, without losing the
+// peaks. With a window (in units of x) only its last part is kept; without it the buckets are merged in pairs when
+// the ring is full, so the whole workout always fits in the same number of points.
+class chartseries {
+  public:
+    explicit chartseries(int window = 0, int buckets = 500);
+
+    void clear();
+    void append(double x, double y);
+    bool isEmpty() const { return !count; }
+
+    // the points for QXYSeries::replace: the vector is kept between the calls, so it's not reallocated every time
+    const QVector<QPointF> &points();
+    // range of the last points()
+    double minX() const { return m_points.isEmpty() ? 0 : m_points.constFirst().x(); }
+    double maxX() const { return m_points.isEmpty() ? 0 : m_points.constLast().x(); }
+    double minY() const { return m_minY; }
+    double maxY() const { return m_maxY; }
+
+  private:
+    struct bucket {
+        qint64 key; // x / span
+        QPointF min;
+        QPointF max;
+    };
+
+    bucket &at(int i) { return ring[(head + i) % ring.size()]; }
+    void merge();
+
+    int m_window;
+    int m_buckets;
+    double span = 1.0; // x covered by a bucket
+    QVector<bucket> ring;
+    int head = 0;
+    int count = 0;
+
+    QVector<QPointF> m_points;
+    double m_minY = 0;
+    double m_maxY = 0;
+};
+
+#endif // CHARTSERIES_H
@@ -1,4 +1,5 @@
 #include "dirconmanager.h"
+#include "iothread.h"
 #include <QNetworkInterface>
 #include <QSettings>
 
@@ -147,6 +148,10 @@ DirconManager::DirconManager(bluetoothdevice *Bike, uint8_t bikeResistanceOffset
                                                                                          : DM_MACHINE_TYPE_BIKE;
     qDebug() << "Building Dircom Manager";
     uint16_t server_base_port = settings.value(QStringLiteral("dircon_server_base_port"), 4810).toUInt();
+    // every rider of the studio gateway has its own block of ports
+    if (Bike->gatewaySlot() >= 0) {
+        server_base_port += 10 * (Bike->gatewaySlot() + 1);
+    }
     bool bike_wheel_revs = settings.value(QStringLiteral("bike_wheel_revs"), false).toBool();
     DM_CHAR_NOTIF_OP(DM_CHAR_NOTIF_BUILD_OP, Bike, 0, 0)
     writeP2AD9 = new CharacteristicWriteProcessor2AD9(bikeResistanceGain, bikeResistanceOffset, Bike, this);
@@ -168,6 +173,14 @@ DirconManager::DirconManager(bluetoothdevice *Bike, uint8_t bikeResistanceOffset
     if (rv##UUID == CN_OK)                                                                                             \
         P1->sendCharacteristicNotification(0x##UUID, all##UUID);
 
+DirconManager *DirconManager::create(bluetoothdevice *Bike, uint8_t bikeResistanceOffset, double bikeResistanceGain) {
+    qRegisterMetaType<QLowEnergyCharacteristic>("QLowEnergyCharacteristic");
+    DirconManager *manager = nullptr;
+    // the caller waits, so the constructor can still read the device
+    iothread::run([&]() { manager = new DirconManager(Bike, bikeResistanceOffset, bikeResistanceGain); });
+    return manager;
+}
+
 void DirconManager::bikeProvider() {
     DM_CHAR_NOTIF_OP(DM_CHAR_NOTIF_NOTIF1_OP, 0, 0, 0)
     foreach (DirconProcessor *processor, processors) { DM_CHAR_NOTIF_OP(DM_CHAR_NOTIF_NOTIF2_OP, processor, 0, 0) }
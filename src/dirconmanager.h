@@ -30,6 +30,9 @@ class DirconManager : public QObject {
   public:
     explicit DirconManager(bluetoothdevice *t, uint8_t bikeResistanceOffset = 4, double bikeResistanceGain = 1.0,
                            QObject *parent = nullptr);
+    // builds the manager on the I/O thread, where its servers and sockets live; delete it with deleteLater
+    static DirconManager *create(bluetoothdevice *t, uint8_t bikeResistanceOffset = 4,
+                                 double bikeResistanceGain = 1.0);
   private slots:
     void bikeProvider();
   signals:
@@ -0,0 +1,24 @@
+#include "driverregistry.h"
+
+QVector<driverregistry::entry> &driverregistry::list() {
+    // a function static: the entries are added by the static initializers of the drivers, in any order
+    static QVector<entry> entries;
+    return entries;
+}
+
+bool driverregistry::add(const entry &e) {
+    list().append(e);
+    return true;
+}
+
+const driverregistry::entry *driverregistry::match(const QBluetoothDeviceInfo &info) {
+    const QString name = info.name();
+    for (const entry &e : qAsConst(list())) {
+        for (const QString &prefix : e.prefixes) {
+            if (name.startsWith(prefix, Qt::CaseInsensitive)) {
+                return &e;
+            }
+        }
+    }
+    return nullptr;
+}
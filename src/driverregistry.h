@@ -0,0 +1,60 @@
+#ifndef DRIVERREGISTRY_H
+#define DRIVERREGISTRY_H
+
+#include "bluetoothdevice.h"
+#include <QBluetoothDeviceInfo>
+#include <QStringList>
+#include <QVector>
+
+// the command line options of the bluetooth manager that the drivers take in their constructors
+struct driverparams {
+    bool noWriteResistance = false;
+    bool noHeartService = false;
+    bool noConsole = false;
+    uint32_t pollDeviceTime = 200;
+    uint8_t bikeResistanceOffset = 4;
+    double bikeResistanceGain = 1.0;
+};
+
+// Static registry of the drivers that are matched only by the prefix of their advertised name.
+// Every driver adds its own entry from its .cpp, so bluetooth.cpp doesn't need its header: the entries are the
+// manifest that the discovery walks, and the code of a driver is reached only through the factory thunks of the
+// entry that matched.
+class driverregistry {
+  public:
+    typedef bluetoothdevice *(*factory)(const driverparams &params);
+    typedef void (*discover)(bluetoothdevice *device, const QBluetoothDeviceInfo &info);
+
+    struct entry {
+        const char *name;
+        QStringList prefixes; // case insensitive
+        bool connectDebug;    // some drivers are too chatty for the debug log of the manager
+        factory create;
+        discover deviceDiscovered;
+    };
+
+    // returns true, so an entry can be added in the initializer of a static variable
+    static bool add(const entry &e);
+    // the first entry whose signature matches the device, nullptr if none
+    static const entry *match(const QBluetoothDeviceInfo &info);
+
+  private:
+    static QVector<entry> &list();
+};
+
+// DRIVERREGISTRY_ADD(yesoulbike, new yesoulbike(p.noWriteResistance, p.noHeartService), QStringLiteral("YESOUL"));
+// DRIVERREGISTRY_ADD_QUIET doesn't connect the debug signal of the driver to the one of the manager
+#define DRIVERREGISTRY_ADD(cls, construct, ...) DRIVERREGISTRY_ENTRY(cls, true, construct, __VA_ARGS__)
+#define DRIVERREGISTRY_ADD_QUIET(cls, construct, ...) DRIVERREGISTRY_ENTRY(cls, false, construct, __VA_ARGS__)
+#define DRIVERREGISTRY_ENTRY(cls, debugSignal, construct, ...)                                                         \
+    static const bool cls##_registered = driverregistry::add(                                                          \
+        {#cls, QStringList({__VA_ARGS__}), debugSignal,                                                                \
+         [](const driverparams &p) -> bluetoothdevice * {                                                              \
+             Q_UNUSED(p)                                                                                               \
+             return construct;                                                                                         \
+         },                                                                                                            \
+         [](bluetoothdevice *device, const QBluetoothDeviceInfo &info) {                                               \
+             static_cast<cls *>(device)->deviceDiscovered(info);                                                       \
+         }})
+
+#endif // DRIVERREGISTRY_H
@@ -506,6 +506,11 @@ uint16_t echelonconnectsport::watts() {
 }
 
 uint16_t echelonconnectsport::wattsFromResistance(double resistance) {
+    QSettings settings;
+    if (settings.value(QStringLiteral("power_calibration"), false).toBool() && powerCalibrationReady()) {
+        return m_powerCalibration.predict(currentCadence().value(), resistance);
+    }
+
     // https://github.com/cagnulein/qdomyos-zwift/issues/62#issuecomment-736913564
     /*if(currentCadence().value() < 90)
         return (uint16_t)((3.59 * exp(0.0217 * (double)(currentCadence().value()))) * exp(0.095 *
@@ -6,8 +6,8 @@ elliptical::elliptical() {}
 
 void elliptical::update_metrics(bool watt_calc, const double watts) {
 
-    QDateTime current = QDateTime::currentDateTime();
-    double deltaTime = (((double)_lastTimeUpdate.msecsTo(current)) / ((double)1000.0));
+    qint64 current = steadyclock::now();
+    double deltaTime = (((double)(current - _lastTimeUpdate)) / ((double)1000.0));
     QSettings settings;
     if (!_firstUpdate && !paused) {
         if (currentSpeed().value() > 0.0 || settings.value(QStringLiteral("continuous_moving"), true).toBool()) {
@@ -30,11 +30,16 @@ void elliptical::update_metrics(bool watt_calc, const double watts) {
         WattKg = 0;
     }
 
+    if (!_firstUpdate && !paused) {
+        m_load.sample(deltaTime, m_watt.value(), currentHeart().value());
+        recordSample();
+    }
     METS = calculateMETS();
     elevationAcc += (currentSpeed().value() / 3600.0) * 1000.0 * (currentInclination().value() / 100.0) * deltaTime;
 
     _lastTimeUpdate = current;
     _firstUpdate = false;
+    publishTelemetry();
 }
 
 uint16_t elliptical::watts() {
@@ -86,12 +91,15 @@ void elliptical::clearStats() {
     elevationAcc = 0;
     m_watt.clear(false);
     WeightLoss.clear(false);
+    m_load.reset();
+    m_samples.clear();
     WattKg.clear(false);
     Inclination.clear(false);
 }
 
 void elliptical::setPaused(bool p) {
     paused = p;
+    m_watchdog->setArmed(!p);
     moving.setPaused(p);
     elapsed.setPaused(p);
     Speed.setPaused(p);
@@ -1,4 +1,5 @@
 #include "eslinkertreadmill.h"
+#include "driverregistry.h"
 #include "keepawakehelper.h"
 #include "virtualtreadmill.h"
 #include <QBluetoothLocalDevice>
@@ -10,6 +11,9 @@
 
 using namespace std::chrono_literals;
 
+DRIVERREGISTRY_ADD(eslinkertreadmill, new eslinkertreadmill(p.pollDeviceTime, p.noConsole, p.noHeartService),
+                   QStringLiteral("ESLINKER"));
+
 eslinkertreadmill::eslinkertreadmill(uint32_t pollDeviceTime, bool noConsole, bool noHeartService,
                                      double forceInitSpeed, double forceInitInclination) {
     m_watt.setType(metric::METRIC_WATT);
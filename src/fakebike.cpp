@@ -103,6 +103,7 @@ void fakebike::update() {
         Resistance = requestResistance;
         m_pelotonResistance = requestResistance;
     }
+    publishTelemetry();
 }
 
 void fakebike::ftmsCharacteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue) {
@@ -0,0 +1,63 @@
+#include "ghostrace.h"
+#include "qdebugfixup.h"
+#include <QFileInfo>
+
+bool ghostrace::load(const QString &filename) {
+    clear();
+    points = qfit::open(filename);
+    m_name = QFileInfo(filename).completeBaseName();
+    qDebug() << QStringLiteral("ghostrace::load") << filename << points.count();
+    return isLoaded();
+}
+
+void ghostrace::clear() {
+    points.clear();
+    m_name.clear();
+    timeCursor = 0;
+    distanceCursor = 0;
+}
+
+double ghostrace::distanceAt(double seconds) {
+    if (!isLoaded()) {
+        return 0;
+    }
+    if (timeCursor >= points.count() - 1 || points.at(timeCursor).seconds > seconds) {
+        timeCursor = 0;
+    }
+    while (timeCursor < points.count() - 2 && points.at(timeCursor + 1).seconds <= seconds) {
+        timeCursor++;
+    }
+
+    const qfit_point &a = points.at(timeCursor);
+    const qfit_point &b = points.at(timeCursor + 1);
+    if (seconds >= b.seconds) {
+        return b.distance;
+    }
+    if (seconds <= a.seconds) {
+        return a.distance;
+    }
+    return a.distance + (b.distance - a.distance) * (seconds - a.seconds) / (b.seconds - a.seconds);
+}
+
+double ghostrace::secondsAt(double distance) {
+    if (!isLoaded()) {
+        return 0;
+    }
+    if (distanceCursor >= points.count() - 1 || points.at(distanceCursor).distance > distance) {
+        distanceCursor = 0;
+    }
+    while (distanceCursor < points.count() - 2 && points.at(distanceCursor + 1).distance <= distance) {
+        distanceCursor++;
+    }
+
+    const qfit_point &a = points.at(distanceCursor);
+    const qfit_point &b = points.at(distanceCursor + 1);
+    if (distance >= b.distance || b.distance <= a.distance) {
+        // beyond the end of the ghost: it would have needed at least all its time
+        return b.seconds;
+    }
+    if (distance <= a.distance) {
+        return a.seconds;
+    }
+    return a.seconds + (b.seconds - a.seconds) * (distance - a.distance) / (b.distance - a.distance);
+}
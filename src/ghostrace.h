@@ -0,0 +1,34 @@
+#ifndef GHOSTRACE_H
+#define GHOSTRACE_H
+
+#include "qfit.h"
+#include <QString>
+#include <QVector>
+
+// Races against a past activity loaded from a FIT file.
+// The lookups are called once a second with a growing time and distance, so they keep a cursor on the series and
+// are O(1) on average; going back (e.g. a new workout) just rewinds the cursor.
+class ghostrace {
+  public:
+    bool load(const QString &filename);
+    void clear();
+    bool isLoaded() const { return points.count() >= 2; }
+    QString name() const { return m_name; }
+
+    // ghost distance (km) after the seconds elapsed
+    double distanceAt(double seconds);
+    // seconds the ghost needed to reach the distance (km)
+    double secondsAt(double distance);
+
+    // positive when we are ahead of the ghost
+    double distanceGap(double seconds, double distance) { return distance - distanceAt(seconds); }
+    double timeGap(double seconds, double distance) { return secondsAt(distance) - seconds; }
+
+  private:
+    QVector<qfit_point> points;
+    QString m_name;
+    int timeCursor = 0;
+    int distanceCursor = 0;
+};
+
+#endif // GHOSTRACE_H
@@ -59,13 +59,16 @@ QList<gpx_altitude_point_for_treadmill> gpx::open(const QString &gpx) {
     return inclinationList;
 }
 
-void gpx::save(const QString &filename, QList<SessionLine> session, bluetoothdevice::BLUETOOTH_TYPE type) {
+bool gpx::save(const QString &filename, const QList<SessionLine> &session, bluetoothdevice::BLUETOOTH_TYPE type) {
     if (session.isEmpty()) {
-        return;
+        return false;
     }
 
     QFile output(filename);
-    output.open(QIODevice::WriteOnly);
+    if (!output.open(QIODevice::WriteOnly)) {
+        qDebug() << QStringLiteral("gpx::save error opening") << filename << output.errorString();
+        return false;
+    }
     QXmlStreamWriter stream(&output);
     stream.setAutoFormatting(true);
     stream.writeStartDocument();
@@ -108,14 +111,15 @@ void gpx::save(const QString &filename, QList<SessionLine> session, bluetoothdev
     }
 
     stream.writeStartElement(QStringLiteral("trkseg"));
-    for (const SessionLine &s : qAsConst(session)) {
+    for (const SessionLine &s : session) {
         if (s.speed > 0) {
             stream.writeStartElement(QStringLiteral("trkpt"));
             stream.writeAttribute(QStringLiteral("lat"), QStringLiteral("0"));
             stream.writeAttribute(QStringLiteral("lon"), QStringLiteral("0"));
             stream.writeTextElement(QStringLiteral("ele"),
                                     QStringLiteral("0")); // replace with the cumulative inclination
-            stream.writeTextElement(QStringLiteral("time"), s.time.toString(QStringLiteral("yyyy-MM-ddTHH:mm:ssZ")));
+            stream.writeTextElement(QStringLiteral("time"),
+                                    s.time.toString(QStringLiteral("yyyy-MM-ddTHH:mm:ss.zzzZ")));
             stream.writeTextElement(QStringLiteral("speed"), QString::number(s.speed / 3.6)); // meter per second
             stream.writeStartElement(QStringLiteral("extensions"));
             stream.writeTextElement(QStringLiteral("power"), QString::number(s.watt));
@@ -139,4 +143,9 @@ void gpx::save(const QString &filename, QList<SessionLine> session, bluetoothdev
     stream.writeEndElement(); // gpx
 
     stream.writeEndDocument();
+    if (stream.hasError()) {
+        qDebug() << QStringLiteral("gpx::save error writing") << filename << output.errorString();
+        return false;
+    }
+    return true;
 }
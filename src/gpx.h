@@ -28,7 +28,8 @@ class gpx : public QObject {
   public:
     explicit gpx(QObject *parent = nullptr);
     QList<gpx_altitude_point_for_treadmill> open(const QString &gpx);
-    static void save(const QString &filename, QList<SessionLine> session, bluetoothdevice::BLUETOOTH_TYPE type);
+    // false if the file couldn't be written
+    static bool save(const QString &filename, const QList<SessionLine> &session, bluetoothdevice::BLUETOOTH_TYPE type);
 
   private:
     QList<gpx_point> points;
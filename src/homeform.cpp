@@ -1,11 +1,18 @@
 #include "homeform.h"
+#include "activitystore.h"
+#include "appdir.h"
 #include "gpx.h"
 #include "ios/lockscreen.h"
 #include "keepawakehelper.h"
+#include "m3ibike.h"
+#include "m3ibroadcastlistener.h"
 #include "material.h"
 #include "qfit.h"
+#include "sessionrecorder.h"
 #include "simplecrypt.h"
+#include "startupprofiler.h"
 #include "templateinfosenderbuilder.h"
+#include "workoutlibrary.h"
 #include "zwiftworkout.h"
 
 #include <QAbstractOAuth2>
@@ -21,6 +28,7 @@
 #include <QOAuthHttpServerReplyHandler>
 #include <QQmlContext>
 #include <QQmlFile>
+#include <QQuickWindow>
 
 #include <QRandomGenerator>
 #include <QSettings>
@@ -79,40 +87,105 @@ DataObject::DataObject(const QString &name, const QString &icon, const QString &
 }
 
 void DataObject::setName(const QString &v) {
+    if (m_name == v) {
+        return;
+    }
     m_name = v;
     emit nameChanged(m_name);
+    if (m_model) {
+        m_model->markDirty(this, tilemodel::NameRole);
+    }
 }
 void DataObject::setValue(const QString &v) {
+    if (m_formatted && qIsNaN(m_number) && m_value == v) {
+        return;
+    }
     m_value = v;
-    emit valueChanged(m_value);
+    m_number = NAN;
+    m_formatted = true;
+    emit valueChanged();
+    if (m_model) {
+        m_model->markDirty(this, tilemodel::ValueRole);
+        m_model->markDirty(this, tilemodel::NumberRole);
+    }
+}
+void DataObject::setValue(double v, int decimals) {
+    if (v == m_number && decimals == m_decimals) {
+        return;
+    }
+    m_number = v;
+    m_decimals = decimals;
+    m_formatted = false;
+    emit valueChanged();
+    if (m_model) {
+        m_model->markDirty(this, tilemodel::ValueRole);
+        m_model->markDirty(this, tilemodel::NumberRole);
+    }
 }
 void DataObject::setSecondLine(const QString &value) {
+    if (m_secondLine == value) {
+        return;
+    }
     m_secondLine = value;
     emit secondLineChanged(m_secondLine);
+    if (m_model) {
+        m_model->markDirty(this, tilemodel::SecondLineRole);
+    }
 }
 void DataObject::setValueFontSize(int value) {
+    if (m_valueFontSize == value) {
+        return;
+    }
     m_valueFontSize = value;
     emit valueFontSizeChanged(m_valueFontSize);
+    if (m_model) {
+        m_model->markDirty(this, tilemodel::ValueFontSizeRole);
+    }
 }
 void DataObject::setValueFontColor(const QString &value) {
+    if (m_valueFontColor == value) {
+        return;
+    }
     m_valueFontColor = value;
     emit valueFontColorChanged(m_valueFontColor);
+    if (m_model) {
+        m_model->markDirty(this, tilemodel::ValueFontColorRole);
+    }
 }
 void DataObject::setLabelFontSize(int value) {
+    if (m_labelFontSize == value) {
+        return;
+    }
     m_labelFontSize = value;
     emit labelFontSizeChanged(m_labelFontSize);
+    if (m_model) {
+        m_model->markDirty(this, tilemodel::LabelFontSizeRole);
+    }
 }
 void DataObject::setGridId(int id) {
+    if (m_gridId == id) {
+        return;
+    }
     m_gridId = id;
     emit gridIdChanged(m_gridId);
+    if (m_model) {
+        m_model->markDirty(this, tilemodel::GridIdRole);
+    }
 }
 void DataObject::setVisible(bool visible) {
+    if (m_visible == visible) {
+        return;
+    }
     m_visible = visible;
     emit visibleChanged(m_visible);
+    if (m_model) {
+        m_model->markDirty(this, tilemodel::VisibleItemRole);
+    }
 }
 
 homeform::homeform(QQmlApplicationEngine *engine, bluetooth *bl) {
 
+    startupprofiler::begin("tiles");
     QSettings settings;
     bool miles = settings.value(QStringLiteral("miles_unit"), false).toBool();
     QString unit = QStringLiteral("km");
@@ -234,6 +307,15 @@ homeform::homeform(QQmlApplicationEngine *engine, bluetooth *bl) {
                            QStringLiteral("0"), true, QStringLiteral("pid_hr"), 48, labelFontSize);
     extIncline = new DataObject(QStringLiteral("Ext.Inclin.(%)"), QStringLiteral("icons/icons/inclination.png"),
                                 QStringLiteral("0.0"), true, QStringLiteral("external_inclination"), 48, labelFontSize);
+    ghost = new DataObject(QStringLiteral("Ghost"), QStringLiteral("icons/icons/odometer.png"), QStringLiteral("-"),
+                           false, QStringLiteral("ghost"), 48, labelFontSize);
+    tss = new DataObject(QStringLiteral("TSS"), QStringLiteral("icons/icons/watt.png"), QStringLiteral("0"), false,
+                         QStringLiteral("tss"), 48, labelFontSize);
+    trimp = new DataObject(QStringLiteral("TRIMP"), QStringLiteral("icons/icons/heart_red.png"), QStringLiteral("0"),
+                           false, QStringLiteral("trimp"), 48, labelFontSize);
+    wPrimeBalance = new DataObject(QStringLiteral("W' Bal"), QStringLiteral("icons/icons/watt.png"),
+                                   QStringLiteral("-"), false, QStringLiteral("wprime_balance"), 48, labelFontSize);
+    startupprofiler::end();
 
     if (!settings.value(QStringLiteral("top_bar_enabled"), true).toBool()) {
 
@@ -283,11 +365,38 @@ homeform::homeform(QQmlApplicationEngine *engine, bluetooth *bl) {
     connect(timer, &QTimer::timeout, this, &homeform::update);
     timer->start(1s);
 
+    exporter = new sessionexporter(this);
+    connect(exporter, &sessionexporter::fitEncoded, this, &homeform::fitEncoded);
+    connect(exporter, &sessionexporter::exportFailed, this, [this](int format, const QString &filename) {
+        Q_UNUSED(format);
+        m_info = QStringLiteral("Error saving ") + QFileInfo(filename).fileName();
+        emit infoChanged(m_info);
+    });
+
+    stravaQueueThread = new QThread(this);
+    stravaQueue = new stravauploadqueue(getWritableAppDir() + QStringLiteral("strava_queue/"));
+#ifdef STRAVA_SECRET_KEY
+    stravaQueue->setClientCredentials(QStringLiteral(STRAVA_CLIENT_ID_S), QStringLiteral(STRINGIFY(STRAVA_SECRET_KEY)));
+#else
+    stravaQueue->setClientCredentials(QStringLiteral(STRAVA_CLIENT_ID_S), QLatin1String(""));
+#endif
+    stravaQueue->moveToThread(stravaQueueThread);
+    connect(stravaQueueThread, &QThread::started, stravaQueue, &stravauploadqueue::start);
+    connect(stravaQueueThread, &QThread::finished, stravaQueue, &QObject::deleteLater);
+
     backupTimer = new QTimer(this);
     connect(backupTimer, &QTimer::timeout, this, &homeform::backup);
     backupTimer->start(1min);
 
     QObject *rootObject = engine->rootObjects().constFirst();
+    QQuickWindow *window = qobject_cast<QQuickWindow *>(rootObject);
+    if (window) {
+        connect(window, &QQuickWindow::frameSwapped, this, &homeform::deferredInit, Qt::QueuedConnection);
+        // a hidden or minimized window, or a scene graph that failed, never swaps a frame
+        QTimer::singleShot(2s, this, &homeform::deferredInit);
+    } else {
+        QTimer::singleShot(0, this, &homeform::deferredInit);
+    }
     QObject *home = rootObject->findChild<QObject *>(QStringLiteral("home"));
     QObject *stack = rootObject;
     QObject::connect(home, SIGNAL(start_clicked()), this, SLOT(Start()));
@@ -295,8 +404,10 @@ homeform::homeform(QQmlApplicationEngine *engine, bluetooth *bl) {
     QObject::connect(stack, SIGNAL(trainprogram_open_clicked(QUrl)), this, SLOT(trainprogram_open_clicked(QUrl)));
     QObject::connect(stack, SIGNAL(trainprogram_zwo_loaded(QString)), this, SLOT(trainprogram_zwo_loaded(QString)));
     QObject::connect(stack, SIGNAL(gpx_open_clicked(QUrl)), this, SLOT(gpx_open_clicked(QUrl)));
+    QObject::connect(stack, SIGNAL(ghost_open_clicked(QUrl)), this, SLOT(ghost_open_clicked(QUrl)));
     QObject::connect(stack, SIGNAL(gpx_save_clicked()), this, SLOT(gpx_save_clicked()));
     QObject::connect(stack, SIGNAL(fit_save_clicked()), this, SLOT(fit_save_clicked()));
+    QObject::connect(stack, SIGNAL(tcx_save_clicked()), this, SLOT(tcx_save_clicked()));
     QObject::connect(stack, SIGNAL(strava_connect_clicked()), this, SLOT(strava_connect_clicked()));
     QObject::connect(stack, SIGNAL(refresh_bluetooth_devices_clicked()), this,
                      SLOT(refresh_bluetooth_devices_clicked()));
@@ -324,16 +435,47 @@ homeform::homeform(QQmlApplicationEngine *engine, bluetooth *bl) {
 
     emit tile_orderChanged(tile_order()); // NOTE: clazy-incorrecrt-emit
 
-    pelotonHandler = new peloton(bl);
+#ifdef TEST
+    QBluetoothDeviceInfo b;
+    deviceConnected(b);
+#endif
+}
+
+void homeform::deferredInit() {
+    if (deferredInitDone) {
+        return;
+    }
+    deferredInitDone = true;
+    if (QQuickWindow *window = qobject_cast<QQuickWindow *>(engine->rootObjects().constFirst())) {
+        disconnect(window, &QQuickWindow::frameSwapped, this, &homeform::deferredInit);
+    }
+    startupprofiler::mark("first frame");
+    startupprofiler::begin("deferred init");
+
+    QSettings settings;
+    pelotonHandler = new peloton(bluetoothManager);
     connect(pelotonHandler, &peloton::workoutStarted, this, &homeform::pelotonWorkoutStarted);
     connect(pelotonHandler, &peloton::workoutChanged, this, &homeform::pelotonWorkoutChanged);
     connect(pelotonHandler, &peloton::loginState, this, &homeform::pelotonLoginState);
     connect(pelotonHandler, &peloton::pzpLoginState, this, &homeform::pzpLoginState);
 
-#ifdef TEST
-    QBluetoothDeviceInfo b;
-    deviceConnected(b);
-#endif
+    stravaQueueThread->start();
+
+    // together, so the QML expressions are refreshed once
+    engine->rootContext()->setContextProperties(
+        {{QStringLiteral("activityStore"), QVariant::fromValue<QObject *>(activitystore::instance())},
+         {QStringLiteral("workoutLibrary"), QVariant::fromValue<QObject *>(workoutlibrary::instance())}});
+    if (settings.value(QStringLiteral("m3i_broadcast_listener"), false).toBool()) {
+        m3ibroadcastlistener::instance()->start();
+    }
+
+    // the biggest pages compile on the loader thread now, so their first push doesn't wait for it
+    for (const QString &page : {QStringLiteral("qrc:/settings.qml"), QStringLiteral("qrc:/TrainingProgramsList.qml")}) {
+        preloadedPages.append(new QQmlComponent(engine, QUrl(page), QQmlComponent::Asynchronous, this));
+    }
+
+    startupprofiler::end();
+    startupprofiler::finish();
 }
 
 void homeform::setActivityDescription(QString desc) { activityDescription = desc; }
@@ -453,17 +595,7 @@ void homeform::pelotonWorkoutChanged(const QString &name, const QString &instruc
     emit infoChanged(m_info);
 }
 
-QString homeform::getWritableAppDir() {
-    QString path = QLatin1String("");
-#if defined(Q_OS_ANDROID)
-    path = getAndroidDataAppDir() + "/";
-#elif defined(Q_OS_MACOS) || defined(Q_OS_OSX)
-    path = QStandardPaths::writableLocation(QStandardPaths::DownloadLocation) + "/";
-#elif defined(Q_OS_IOS)
-    path = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation) + "/";
-#endif
-    return path;
-}
+QString homeform::getWritableAppDir() { return appdir::getWritableAppDir(); }
 
 void homeform::backup() {
 
@@ -475,10 +607,10 @@ void homeform::backup() {
     if (dev) {
 
         QString filename = path + QString::number(index) + backupFitFileName;
-        QFile::remove(filename);
-        qfit::save(filename, Session, dev->deviceType(),
-                   qobject_cast<m3ibike *>(dev) ? QFIT_PROCESS_DISTANCENOISE : QFIT_PROCESS_NONE,
-                   stravaPelotonWorkoutType);
+        QFile::remove(filename + QStringLiteral(".fit"));
+        exporter->exportSession(Session, dev->recording(), dev->deviceType(), filename, sessionexporter::FIT,
+                                qobject_cast<m3ibike *>(dev) ? QFIT_PROCESS_DISTANCENOISE : QFIT_PROCESS_NONE,
+                                stravaPelotonWorkoutType);
 
         index++;
         if (index > 1) {
@@ -512,15 +644,31 @@ void homeform::refresh_bluetooth_devices_clicked() {
 }
 
 homeform::~homeform() {
-
-    gpx_save_clicked();
-    fit_save_clicked();
+    // the session has been saved by aboutToQuit
+    if (stravaQueueThread->isRunning()) {
+        stravaQueueThread->quit();
+        stravaQueueThread->wait();
+    }
 }
 
 void homeform::aboutToQuit() {
 
     /*if(bluetoothManager->device())
         bluetoothManager->device()->disconnectBluetooth();*/
+
+    // homeform is never deleted, so the session is saved here; the app is closing, so this time we have to wait
+    // for the files
+    saveSession(sessionexporter::GPX | sessionexporter::FIT, true);
+    exporter->flush();
+
+    // the exporter has queued the FIT files for strava: they have to reach the disk before the queue stops,
+    // the pending uploads will be sent at the next start. The thread isn't there before deferredInit
+    if (stravaQueueThread->isRunning()) {
+        QMetaObject::invokeMethod(
+            stravaQueue, []() {}, Qt::BlockingQueuedConnection);
+        stravaQueueThread->quit();
+        stravaQueueThread->wait();
+    }
 }
 
 void homeform::trainProgramSignals() {
@@ -791,6 +939,30 @@ void homeform::sortTiles() {
                 pidHR->setGridId(i);
                 dataList.append(pidHR);
             }
+
+            if (settings.value(QStringLiteral("tile_ghost_enabled"), false).toBool() &&
+                settings.value(QStringLiteral("tile_ghost_order"), 33).toInt() == i) {
+                ghost->setGridId(i);
+                dataList.append(ghost);
+            }
+
+            if (settings.value(QStringLiteral("tile_tss_enabled"), false).toBool() &&
+                settings.value(QStringLiteral("tile_tss_order"), 34).toInt() == i) {
+                tss->setGridId(i);
+                dataList.append(tss);
+            }
+
+            if (settings.value(QStringLiteral("tile_trimp_enabled"), false).toBool() &&
+                settings.value(QStringLiteral("tile_trimp_order"), 35).toInt() == i) {
+                trimp->setGridId(i);
+                dataList.append(trimp);
+            }
+
+            if (settings.value(QStringLiteral("tile_wprime_balance_enabled"), false).toBool() &&
+                settings.value(QStringLiteral("tile_wprime_balance_order"), 36).toInt() == i) {
+                wPrimeBalance->setGridId(i);
+                dataList.append(wPrimeBalance);
+            }
         }
     } else if (bluetoothManager->device()->deviceType() == bluetoothdevice::BIKE) {
         for (int i = 0; i < 100; i++) {
@@ -1011,6 +1183,30 @@ void homeform::sortTiles() {
                 extIncline->setGridId(i);
                 dataList.append(extIncline);
             }
+
+            if (settings.value(QStringLiteral("tile_ghost_enabled"), false).toBool() &&
+                settings.value(QStringLiteral("tile_ghost_order"), 33).toInt() == i) {
+                ghost->setGridId(i);
+                dataList.append(ghost);
+            }
+
+            if (settings.value(QStringLiteral("tile_tss_enabled"), false).toBool() &&
+                settings.value(QStringLiteral("tile_tss_order"), 34).toInt() == i) {
+                tss->setGridId(i);
+                dataList.append(tss);
+            }
+
+            if (settings.value(QStringLiteral("tile_trimp_enabled"), false).toBool() &&
+                settings.value(QStringLiteral("tile_trimp_order"), 35).toInt() == i) {
+                trimp->setGridId(i);
+                dataList.append(trimp);
+            }
+
+            if (settings.value(QStringLiteral("tile_wprime_balance_enabled"), false).toBool() &&
+                settings.value(QStringLiteral("tile_wprime_balance_order"), 36).toInt() == i) {
+                wPrimeBalance->setGridId(i);
+                dataList.append(wPrimeBalance);
+            }
         }
     } else if (bluetoothManager->device()->deviceType() == bluetoothdevice::ROWING) {
         for (int i = 0; i < 100; i++) {
@@ -1220,6 +1416,30 @@ void homeform::sortTiles() {
                 target_zone->setGridId(i);
                 dataList.append(target_zone);
             }
+
+            if (settings.value(QStringLiteral("tile_ghost_enabled"), false).toBool() &&
+                settings.value(QStringLiteral("tile_ghost_order"), 33).toInt() == i) {
+                ghost->setGridId(i);
+                dataList.append(ghost);
+            }
+
+            if (settings.value(QStringLiteral("tile_tss_enabled"), false).toBool() &&
+                settings.value(QStringLiteral("tile_tss_order"), 34).toInt() == i) {
+                tss->setGridId(i);
+                dataList.append(tss);
+            }
+
+            if (settings.value(QStringLiteral("tile_trimp_enabled"), false).toBool() &&
+                settings.value(QStringLiteral("tile_trimp_order"), 35).toInt() == i) {
+                trimp->setGridId(i);
+                dataList.append(trimp);
+            }
+
+            if (settings.value(QStringLiteral("tile_wprime_balance_enabled"), false).toBool() &&
+                settings.value(QStringLiteral("tile_wprime_balance_order"), 36).toInt() == i) {
+                wPrimeBalance->setGridId(i);
+                dataList.append(wPrimeBalance);
+            }
         }
     } else if (bluetoothManager->device()->deviceType() == bluetoothdevice::ELLIPTICAL) {
         for (int i = 0; i < 100; i++) {
@@ -1390,10 +1610,38 @@ void homeform::sortTiles() {
                 pidHR->setGridId(i);
                 dataList.append(pidHR);
             }
+
+            if (settings.value(QStringLiteral("tile_ghost_enabled"), false).toBool() &&
+                settings.value(QStringLiteral("tile_ghost_order"), 33).toInt() == i) {
+                ghost->setGridId(i);
+                dataList.append(ghost);
+            }
+
+            if (settings.value(QStringLiteral("tile_tss_enabled"), false).toBool() &&
+                settings.value(QStringLiteral("tile_tss_order"), 34).toInt() == i) {
+                tss->setGridId(i);
+                dataList.append(tss);
+            }
+
+            if (settings.value(QStringLiteral("tile_trimp_enabled"), false).toBool() &&
+                settings.value(QStringLiteral("tile_trimp_order"), 35).toInt() == i) {
+                trimp->setGridId(i);
+                dataList.append(trimp);
+            }
+
+            if (settings.value(QStringLiteral("tile_wprime_balance_enabled"), false).toBool() &&
+                settings.value(QStringLiteral("tile_wprime_balance_order"), 36).toInt() == i) {
+                wPrimeBalance->setGridId(i);
+                dataList.append(wPrimeBalance);
+            }
         }
     }
 
-    engine->rootContext()->setContextProperty(QStringLiteral("appModel"), QVariant::fromValue(dataList));
+    if (!tiles) {
+        tiles = new tilemodel(this);
+        engine->rootContext()->setContextProperty(QStringLiteral("appModel"), tiles);
+    }
+    tiles->setTiles(dataList);
 }
 
 DataObject *homeform::tileFromName(QString name) {
@@ -1871,6 +2119,8 @@ void homeform::Stop() {
     fit_save_clicked();
 
     if (bluetoothManager->device()) {
+        activitystore::instance()->addSession(Session, bluetoothManager->device()->deviceType(),
+                                              stravaPendingFitFile);
         bluetoothManager->device()->setPaused(paused | stopped);
     }
 
@@ -1984,13 +2234,8 @@ void homeform::update() {
         double inclination = 0;
         double resistance = 0;
         double watts = 0;
-        double pace = 0;
         double peloton_resistance = 0;
         uint8_t cadence = 0;
-        uint32_t totalStrokes = 0;
-        double avgStrokesRate = 0;
-        double maxStrokesRate = 0;
-        double avgStrokesLength = 0;
 
         bool miles = settings.value(QStringLiteral("miles_unit"), false).toBool();
         double ftpSetting = settings.value(QStringLiteral("ftp"), 200.0).toDouble();
@@ -2007,29 +2252,62 @@ void homeform::update() {
             unit_conversion = 0.621371;
         }
 
-        emit signalChanged(signal());
-        speed->setValue(QString::number(bluetoothManager->device()->currentSpeed().value() * unit_conversion, 'f', 1));
+        QString icon = signal();
+        if (icon != signalIcon) {
+            signalIcon = icon;
+            emit signalChanged(signalIcon);
+        }
+        speed->setValue(bluetoothManager->device()->currentSpeed().value() * unit_conversion, 1);
         speed->setSecondLine(
             QStringLiteral("AVG: ") +
             QString::number((bluetoothManager->device())->currentSpeed().average() * unit_conversion, 'f', 1) +
             QStringLiteral(" MAX: ") +
             QString::number((bluetoothManager->device())->currentSpeed().max() * unit_conversion, 'f', 1));
-        heart->setValue(QString::number(bluetoothManager->device()->currentHeart().value(), 'f', 0));
+        heart->setValue(bluetoothManager->device()->currentHeart().value(), 0);
 
-        calories->setValue(QString::number(bluetoothManager->device()->calories().value(), 'f', 0));
+        calories->setValue(bluetoothManager->device()->calories().value(), 0);
         calories->setSecondLine(QString::number(bluetoothManager->device()->calories().rate1s() * 60.0, 'f', 1) +
                                 " /min");
         if (!settings.value(QStringLiteral("fitmetria_fanfit_enable"), false).toBool())
             fan->setValue(QString::number(bluetoothManager->device()->fanSpeed()));
         else
             fan->setValue(QString::number(qRound(((double)bluetoothManager->device()->fanSpeed()) / 10.0) * 10.0));
-        jouls->setValue(QString::number(bluetoothManager->device()->jouls().value() / 1000.0, 'f', 1));
+        jouls->setValue(bluetoothManager->device()->jouls().value() / 1000.0, 1);
         jouls->setSecondLine(QString::number(bluetoothManager->device()->jouls().rate1s() / 1000.0 * 60.0, 'f', 1) +
                              " /min");
         elapsed->setValue(bluetoothManager->device()->elapsedTime().toString(QStringLiteral("h:mm:ss")));
         moving_time->setValue(bluetoothManager->device()->movingTime().toString(QStringLiteral("h:mm:ss")));
         pidHR->setValue(QString::number(treadmill_pid_heart_zone));
 
+        const trainingload &load = bluetoothManager->device()->trainingLoad();
+        tss->setValue(QString::number(load.tss(), 'f', 0));
+        tss->setSecondLine(QStringLiteral("IF ") + QString::number(load.intensityFactor(), 'f', 2) +
+                           QStringLiteral(" NP ") + QString::number(load.normalizedPower(), 'f', 0) +
+                           QStringLiteral("W"));
+        trimp->setValue(QString::number(load.trimp(), 'f', 0));
+        wPrimeBalance->setValue(QString::number(load.wPrimeBalance() / 1000.0, 'f', 1) + QStringLiteral(" kJ"));
+        wPrimeBalance->setSecondLine(QString::number(load.wPrimeBalance() * 100.0 / load.wPrime(), 'f', 0) +
+                                     QStringLiteral("%"));
+
+        if (ghostRace.isLoaded()) {
+            QTime e = bluetoothManager->device()->elapsedTime();
+            double seconds = e.second() + (e.minute() * 60) + (e.hour() * 3600);
+            double odometer = bluetoothManager->device()->odometer();
+            double meters = ghostRace.distanceGap(seconds, odometer) * 1000.0;
+            int timeGap = qRound(ghostRace.timeGap(seconds, odometer));
+            if (miles) {
+                ghost->setValue((meters >= 0 ? QStringLiteral("+") : QString()) +
+                                QString::number(meters * 3.28084, 'f', 0) + QStringLiteral(" ft"));
+            } else {
+                ghost->setValue((meters >= 0 ? QStringLiteral("+") : QString()) + QString::number(meters, 'f', 0) +
+                                QStringLiteral(" m"));
+            }
+            // by hand, a QTime would wrap after an hour
+            const int gap = qAbs(timeGap);
+            ghost->setSecondLine((timeGap >= 0 ? QStringLiteral("+") : QStringLiteral("-")) +
+                                 QStringLiteral("%1:%2").arg(gap / 60).arg(gap % 60, 2, 10, QLatin1Char('0')));
+        }
+
         if (trainProgram) {
             peloton_offset->setValue(QString::number(trainProgram->offsetElapsedTime()) + QStringLiteral(" sec."));
             peloton_remaining->setValue(trainProgram->remainingTime().toString("h:mm:ss"));
@@ -2039,7 +2317,7 @@ void homeform::update() {
                 trainProgram->currentRowRemainingTime().toString(QStringLiteral("h:mm:ss")));
             remaningTimeTrainingProgramCurrentRow->setSecondLine(
                 trainProgram->currentRowElapsedTime().toString(QStringLiteral("h:mm:ss")));
-            targetMets->setValue(QString::number(trainProgram->currentTargetMets(), 'f', 1));
+            targetMets->setValue(trainProgram->currentTargetMets(), 1);
             trainrow next = trainProgram->getRowFromCurrent(1);
             trainrow next_1 = trainProgram->getRowFromCurrent(2);
             if (next.duration.second() != 0 || next.duration.minute() != 0 || next.duration.hour() != 0) {
@@ -2108,13 +2386,13 @@ void homeform::update() {
                 nextRows->setValue(QStringLiteral("N/A"));
             }
         }
-        mets->setValue(QString::number(bluetoothManager->device()->currentMETS().value(), 'f', 1));
+        mets->setValue(bluetoothManager->device()->currentMETS().value(), 1);
         mets->setSecondLine(
             QStringLiteral("AVG: ") + QString::number(bluetoothManager->device()->currentMETS().average(), 'f', 1) +
             QStringLiteral("MAX: ") + QString::number(bluetoothManager->device()->currentMETS().max(), 'f', 1));
         lapElapsed->setValue(bluetoothManager->device()->lapElapsedTime().toString(QStringLiteral("h:mm:ss")));
-        avgWatt->setValue(QString::number(bluetoothManager->device()->wattsMetric().average(), 'f', 0));
-        wattKg->setValue(QString::number(bluetoothManager->device()->wattKg().value(), 'f', 1));
+        avgWatt->setValue(bluetoothManager->device()->wattsMetric().average(), 0);
+        wattKg->setValue(bluetoothManager->device()->wattKg().value(), 1);
         wattKg->setSecondLine(
             QStringLiteral("AVG: ") + QString::number(bluetoothManager->device()->wattKg().average(), 'f', 1) +
             QStringLiteral("MAX: ") + QString::number(bluetoothManager->device()->wattKg().max(), 'f', 1));
@@ -2123,7 +2401,7 @@ void homeform::update() {
             watts = bluetoothManager->device()->wattsMetric().average5s();
         else
             watts = bluetoothManager->device()->wattsMetric().value();
-        watt->setValue(QString::number(watts, 'f', 0));
+        watt->setValue(watts, 0);
         weightLoss->setValue(QString::number(miles ? bluetoothManager->device()->weightLoss() * 35.274
                                                    : bluetoothManager->device()->weightLoss(),
                                              'f', 2));
@@ -2161,17 +2439,7 @@ void homeform::update() {
 
         if (bluetoothManager->device()->deviceType() == bluetoothdevice::TREADMILL) {
 
-            odometer->setValue(QString::number(bluetoothManager->device()->odometer() * unit_conversion, 'f', 2));
-            if (bluetoothManager->device()->currentSpeed().value()) {
-                pace = 10000 / (((treadmill *)bluetoothManager->device())->currentPace().second() +
-                                (((treadmill *)bluetoothManager->device())->currentPace().minute() * 60));
-                if (pace < 0) {
-                    pace = 0;
-                }
-            } else {
-
-                pace = 0;
-            }
+            odometer->setValue(bluetoothManager->device()->odometer() * unit_conversion, 2);
             inclination = ((treadmill *)bluetoothManager->device())->currentInclination().value();
             this->pace->setValue(
                 ((treadmill *)bluetoothManager->device())->currentPace().toString(QStringLiteral("m:ss")));
@@ -2250,7 +2518,7 @@ void homeform::update() {
                     QString::number(bluetoothManager->externalInclination()->currentInclination().value(), 'f', 1));
             double elite_rizer_gain = settings.value(QStringLiteral("elite_rizer_gain"), 1.0).toDouble();
             extIncline->setSecondLine(QStringLiteral("Gain: ") + QString::number(elite_rizer_gain, 'f', 1));
-            odometer->setValue(QString::number(bluetoothManager->device()->odometer() * unit_conversion, 'f', 2));
+            odometer->setValue(bluetoothManager->device()->odometer() * unit_conversion, 2);
             resistance = ((bike *)bluetoothManager->device())->currentResistance().value();
             peloton_resistance = ((bike *)bluetoothManager->device())->pelotonResistance().value();
             this->peloton_resistance->setValue(QString::number(peloton_resistance, 'f', 0));
@@ -2282,7 +2550,7 @@ void homeform::update() {
                                     settings.value(QStringLiteral("bike_resistance_offset"), 4.0).toDouble(),
                                 'f', 0));
 
-            elevation->setValue(QString::number(((bike *)bluetoothManager->device())->elevationGain().value(), 'f', 1));
+            elevation->setValue(((bike *)bluetoothManager->device())->elevationGain().value(), 1);
             elevation->setSecondLine(
                 QString::number(((bike *)bluetoothManager->device())->elevationGain().rate1s() * 60.0, 'f', 1) +
                 " /min");
@@ -2339,29 +2607,15 @@ void homeform::update() {
                 QString::number(((bike *)bluetoothManager->device())->currentSteeringAngle().value(), 'f', 1));
 
         } else if (bluetoothManager->device()->deviceType() == bluetoothdevice::ROWING) {
-            if (bluetoothManager->device()->currentSpeed().value()) {
-                pace = 10000 / (((rower *)bluetoothManager->device())->currentPace().second() +
-                                (((rower *)bluetoothManager->device())->currentPace().minute() * 60));
-                if (pace < 0) {
-                    pace = 0;
-                }
-            } else {
-
-                pace = 0;
-            }
             this->pace->setValue(((rower *)bluetoothManager->device())->currentPace().toString(QStringLiteral("m:ss")));
             this->pace->setSecondLine(
                 QStringLiteral("AVG: ") +
                 ((rower *)bluetoothManager->device())->averagePace().toString(QStringLiteral("m:ss")) +
                 QStringLiteral(" MAX: ") +
                 ((rower *)bluetoothManager->device())->maxPace().toString(QStringLiteral("m:ss")));
-            odometer->setValue(QString::number(bluetoothManager->device()->odometer() * 1000.0, 'f', 0));
+            odometer->setValue(bluetoothManager->device()->odometer() * 1000.0, 0);
             resistance = ((rower *)bluetoothManager->device())->currentResistance().value();
             peloton_resistance = ((rower *)bluetoothManager->device())->pelotonResistance().value();
-            totalStrokes = ((rower *)bluetoothManager->device())->currentStrokesCount().value();
-            avgStrokesRate = ((rower *)bluetoothManager->device())->currentCadence().average();
-            maxStrokesRate = ((rower *)bluetoothManager->device())->currentCadence().max();
-            avgStrokesLength = ((rower *)bluetoothManager->device())->currentStrokesLength().average();
             this->strokesCount->setValue(
                 QString::number(((rower *)bluetoothManager->device())->currentStrokesCount().value(), 'f', 0));
             this->strokesLength->setValue(
@@ -2423,7 +2677,7 @@ void homeform::update() {
             }
         } else if (bluetoothManager->device()->deviceType() == bluetoothdevice::ELLIPTICAL) {
 
-            odometer->setValue(QString::number(bluetoothManager->device()->odometer() * unit_conversion, 'f', 2));
+            odometer->setValue(bluetoothManager->device()->odometer() * unit_conversion, 2);
             resistance = ((elliptical *)bluetoothManager->device())->currentResistance().value();
             // this->peloton_resistance->setValue(QString::number(((elliptical*)bluetoothManager->device())->pelotonResistance(),
             // 'f', 0));
@@ -2913,19 +3167,7 @@ void homeform::update() {
         }
 
         if (!stopped && !paused) {
-            SessionLine s(bluetoothManager->device()->currentSpeed().value(), inclination,
-                          bluetoothManager->device()->odometer(), watts, resistance, peloton_resistance,
-                          (uint8_t)bluetoothManager->device()->currentHeart().value(), pace, cadence,
-                          bluetoothManager->device()->calories().value(),
-                          bluetoothManager->device()->elevationGain().value(),
-                          bluetoothManager->device()->elapsedTime().second() +
-                              (bluetoothManager->device()->elapsedTime().minute() * 60) +
-                              (bluetoothManager->device()->elapsedTime().hour() * 3600),
-
-                          lapTrigger, totalStrokes, avgStrokesRate, maxStrokesRate, avgStrokesLength,
-                          bluetoothManager->device()->currentCordinate());
-
-            Session.append(s);
+            Session.append(sessionrecorder::line(bluetoothManager->device(), lapTrigger));
 
             if (lapTrigger) {
                 lapTrigger = false;
@@ -2934,29 +3176,22 @@ void homeform::update() {
         emit workoutStartDateChanged(workoutStartDate());
     }
 
-    emit changeOfdevice();
-    emit changeOflap();
-}
-
-bool homeform::getDevice() {
-
-    static bool toggle = false;
-    if (!this->bluetoothManager->device()) {
-
-        // toggling the bluetooth icon
-        toggle = !toggle;
-        return toggle;
+    // without a device the bluetooth icon blinks
+    bool device = bluetoothManager->device() ? bluetoothManager->device()->connected() : !deviceState;
+    if (device != deviceState) {
+        deviceState = device;
+        emit changeOfdevice();
+    }
+    bool lap = bluetoothManager->device() != nullptr;
+    if (lap != lapState) {
+        lapState = lap;
+        emit changeOflap();
     }
-    return this->bluetoothManager->device()->connected();
 }
 
-bool homeform::getLap() {
-    if (!this->bluetoothManager->device()) {
+bool homeform::getDevice() { return deviceState; }
 
-        return false;
-    }
-    return true;
-}
+bool homeform::getLap() { return lapState; }
 
 void homeform::trainprogram_open_clicked(const QUrl &fileName) {
     qDebug() << QStringLiteral("trainprogram_open_clicked") << fileName;
@@ -3001,39 +3236,53 @@ void homeform::trainprogram_zwo_loaded(const QString &s) {
     trainProgramSignals();
 }
 
-void homeform::gpx_save_clicked() {
+void homeform::gpx_save_clicked() { saveSession(sessionexporter::GPX); }
 
-    QString path = getWritableAppDir();
+void homeform::fit_save_clicked() { saveSession(sessionexporter::FIT); }
 
-    if (bluetoothManager->device()) {
-        gpx::save(path + QDateTime::currentDateTime().toString().replace(QStringLiteral(":"), QStringLiteral("_")) +
-                      QStringLiteral(".gpx"),
-                  Session, bluetoothManager->device()->deviceType());
-    }
-}
+void homeform::tcx_save_clicked() { saveSession(sessionexporter::TCX); }
 
-void homeform::fit_save_clicked() {
+void homeform::saveSession(int formats, bool wait) {
 
     QString path = getWritableAppDir();
     bluetoothdevice *dev = bluetoothManager->device();
     if (dev) {
-        QString filename = path +
-                           QDateTime::currentDateTime().toString().replace(QStringLiteral(":"), QStringLiteral("_")) +
-                           QStringLiteral(".fit");
-        qfit::save(filename, Session, dev->deviceType(),
-                   qobject_cast<m3ibike *>(dev) ? QFIT_PROCESS_DISTANCENOISE : QFIT_PROCESS_NONE,
-                   stravaPelotonWorkoutType);
+        QString filename =
+            path + QDateTime::currentDateTime().toString().replace(QStringLiteral(":"), QStringLiteral("_"));
+        if (formats & sessionexporter::FIT) {
+            stravaPendingFitFile = filename + QStringLiteral(".fit");
+        }
+        sessionexporter::upload strava;
+        QSettings settings;
+        if ((formats & sessionexporter::FIT) &&
+            !settings.value(QStringLiteral("strava_accesstoken"), QLatin1String("")).toString().isEmpty()) {
+            strava = strava_upload_info();
+        }
+        exporter->exportSession(Session, dev->recording(), dev->deviceType(), filename, formats,
+                                qobject_cast<m3ibike *>(dev) ? QFIT_PROCESS_DISTANCENOISE : QFIT_PROCESS_NONE,
+                                stravaPelotonWorkoutType, wait, strava);
+    }
+}
+
+void homeform::fitEncoded(const QString &filename, const QByteArray &data) {
+    Q_UNUSED(data);
+    // the backups are going through the exporter too, they are not the workout to attach to the mail.
+    // The strava upload is queued by the exporter itself
+    if (filename == stravaPendingFitFile) {
         lastFitFileSaved = filename;
+    }
+}
 
-        QSettings settings;
-        if (!settings.value(QStringLiteral("strava_accesstoken"), QLatin1String("")).toString().isEmpty()) {
+void homeform::ghost_open_clicked(const QUrl &fileName) {
+    qDebug() << QStringLiteral("ghost_open_clicked") << fileName;
 
-            QFile f(filename);
-            f.open(QFile::OpenModeFlag::ReadOnly);
-            QByteArray fitfile = f.readAll();
-            strava_upload_file(fitfile, filename);
-            f.close();
-        }
+    QString file = QQmlFile::urlToLocalFileOrQrc(fileName);
+    if (file.isEmpty()) {
+        return;
+    }
+    if (!ghostRace.load(file)) {
+        ghost->setValue(QStringLiteral("-"));
+        ghost->setSecondLine(QString());
     }
 }
 
@@ -3183,53 +3432,22 @@ void homeform::strava_refreshtoken() {
 
     settings.setValue(QStringLiteral("strava_accesstoken"), access_token);
     settings.setValue(QStringLiteral("strava_refreshtoken"), refresh_token);
+    settings.setValue(QStringLiteral("strava_expires"), document[QStringLiteral("expires_at")].toVariant());
     settings.setValue(QStringLiteral("strava_lastrefresh"), QDateTime::currentDateTime());
 }
 
-bool homeform::strava_upload_file(const QByteArray &data, const QString &remotename) {
-
-    strava_refreshtoken();
+sessionexporter::upload homeform::strava_upload_info() {
 
     QSettings settings;
-    QString token = settings.value(QStringLiteral("strava_accesstoken")).toString();
-
-    // The V3 API doc said "https://api.strava.com" but it is not working yet
-    QUrl url = QUrl(QStringLiteral("https://www.strava.com/api/v3/uploads"));
-    QNetworkRequest request = QNetworkRequest(url);
-
-    // QString boundary = QString::number(qrand() * (90000000000) / (RAND_MAX + 1) + 10000000000, 16);
-    QString boundary = QVariant(QRandomGenerator::global()->generate()).toString() +
-                       QVariant(QRandomGenerator::global()->generate()).toString() +
-                       QVariant(QRandomGenerator::global()->generate()).toString(); // NOTE: qrand is deprecated
-
-    // MULTIPART *****************
-
-    QHttpMultiPart *multiPart = new QHttpMultiPart(QHttpMultiPart::FormDataType);
-    multiPart->setBoundary(boundary.toLatin1());
-
-    QHttpPart accessTokenPart;
-    accessTokenPart.setHeader(QNetworkRequest::ContentDispositionHeader,
-                              QVariant(QStringLiteral("form-data; name=\"access_token\"")));
-    accessTokenPart.setBody(token.toLatin1());
-    multiPart->append(accessTokenPart);
-
-    QHttpPart activityTypePart;
-    activityTypePart.setHeader(QNetworkRequest::ContentDispositionHeader,
-                               QVariant("form-data; name=\"activity_type\""));
-
+    QString activityType;
     // Map some known sports and default to ride for anything else
     if (bluetoothManager->device()->deviceType() == bluetoothdevice::TREADMILL) {
-        activityTypePart.setBody("run");
+        activityType = QStringLiteral("run");
     } else if (bluetoothManager->device()->deviceType() == bluetoothdevice::ROWING) {
-        activityTypePart.setBody("rowing");
+        activityType = QStringLiteral("rowing");
     } else {
-        activityTypePart.setBody("ride");
+        activityType = QStringLiteral("ride");
     }
-    multiPart->append(activityTypePart);
-
-    QHttpPart activityNamePart;
-    activityNamePart.setHeader(QNetworkRequest::ContentDispositionHeader,
-                               QVariant(QStringLiteral("form-data; name=\"name\"")));
 
     // use metadata config if the user selected it
     QString activityName =
@@ -3249,78 +3467,14 @@ bool homeform::strava_upload_file(const QByteArray &data, const QString &remoten
             activityName = QStringLiteral("Ride") + activityName;
         }
     }
-    activityNamePart.setHeader(QNetworkRequest::ContentTypeHeader,
-                               QVariant(QStringLiteral("text/plain;charset=utf-8")));
-    activityNamePart.setBody(activityName.toUtf8());
-    if (activityName != QLatin1String("")) {
-        multiPart->append(activityNamePart);
-    }
-
-    QHttpPart activityDescriptionPart;
-    activityDescriptionPart.setHeader(QNetworkRequest::ContentDispositionHeader,
-                                      QVariant(QStringLiteral("form-data; name=\"description\"")));
-    activityDescriptionPart.setHeader(QNetworkRequest::ContentTypeHeader,
-                                      QVariant(QStringLiteral("text/plain;charset=utf-8")));
-    activityDescriptionPart.setBody(activityDescription.toUtf8());
-    if (activityDescription != QLatin1String("")) {
-        multiPart->append(activityDescriptionPart);
-    }
-
-    // upload file data
-    QString filename = QFileInfo(remotename).baseName();
-
-    QHttpPart dataTypePart;
-    dataTypePart.setHeader(QNetworkRequest::ContentDispositionHeader,
-                           QVariant(QStringLiteral("form-data; name=\"data_type\"")));
-    dataTypePart.setBody("fit");
-    multiPart->append(dataTypePart);
-
-    QHttpPart externalIdPart;
-    externalIdPart.setHeader(QNetworkRequest::ContentDispositionHeader,
-                             QVariant(QStringLiteral("form-data; name=\"external_id\"")));
-    externalIdPart.setBody(filename.toStdString().c_str());
-    multiPart->append(externalIdPart);
-
-    QHttpPart filePart;
-    filePart.setHeader(QNetworkRequest::ContentTypeHeader, QVariant(QStringLiteral("application/octet-stream")));
-    filePart.setHeader(QNetworkRequest::ContentDispositionHeader,
-                       QVariant(QStringLiteral("form-data; name=\"file\"; filename=\"") + remotename +
-                                QStringLiteral("\"; type=\"application/octet-stream\"")));
-    filePart.setBody(data);
-    multiPart->append(filePart);
-
-    // this must be performed asyncronously and call made
-    // to notifyWriteCompleted(QString remotename, QString message) when done
-    if (manager) {
-
-        delete manager;
-        manager = 0;
-    }
-    manager = new QNetworkAccessManager(this);
-    replyStrava = manager->post(request, multiPart);
-
-    // catch finished signal
-    connect(replyStrava, &QNetworkReply::finished, this, &homeform::writeFileCompleted);
-#if (QT_VERSION >= QT_VERSION_CHECK(5, 13, 0))
-    connect(replyStrava, &QNetworkReply::errorOccurred, this, &homeform::errorOccurredUploadStrava);
-#endif
-    return true;
-}
 
-void homeform::errorOccurredUploadStrava(QNetworkReply::NetworkError code) {
-    qDebug() << QStringLiteral("strava upload error!") << code;
-}
-
-void homeform::writeFileCompleted() {
-    qDebug() << QStringLiteral("strava upload completed!");
-
-    QNetworkReply *reply = static_cast<QNetworkReply *>(QObject::sender());
-
-    QString response = reply->readAll();
-    // QString uploadError = QStringLiteral("invalid response or parser error");
-    // NOTE: clazy-unused-non-trivial-variable
-
-    qDebug() << "reply:" << response;
+    // the queue compresses and stores the file, then it uploads it (and retries it) on its own thread
+    sessionexporter::upload upload;
+    upload.queue = stravaQueue;
+    upload.name = activityName;
+    upload.description = activityDescription;
+    upload.type = activityType;
+    return upload;
 }
 
 void homeform::onStravaGranted() {
@@ -3332,6 +3486,9 @@ void homeform::onStravaGranted() {
     qDebug() << QStringLiteral("strava authenticathed") << strava->token() << strava->refreshToken();
     strava_refreshtoken();
     setGeneralPopupVisible(true);
+
+    // some workouts could be waiting for the strava login
+    QMetaObject::invokeMethod(stravaQueue, &stravauploadqueue::start, Qt::QueuedConnection);
 }
 
 void homeform::onStravaAuthorizeWithBrowser(const QUrl &url) {
@@ -3774,37 +3931,7 @@ void homeform::sendMail() {
 }
 
 #if defined(Q_OS_ANDROID)
-QString homeform::getAndroidDataAppDir() {
-    static QString path = "";
-
-    if (path.length()) {
-        return path;
-    }
-
-    QAndroidJniObject filesArr = QtAndroid::androidActivity().callObjectMethod(
-        "getExternalFilesDirs", "(Ljava/lang/String;)[Ljava/io/File;", nullptr);
-    jobjectArray dataArray = filesArr.object<jobjectArray>();
-    QString out;
-    if (dataArray) {
-        QAndroidJniEnvironment env;
-        jsize dataSize = env->GetArrayLength(dataArray);
-        if (dataSize) {
-            QAndroidJniObject mediaPath;
-            QAndroidJniObject file;
-            for (int i = 0; i < dataSize; i++) {
-                file = env->GetObjectArrayElement(dataArray, i);
-                jboolean val = QAndroidJniObject::callStaticMethod<jboolean>(
-                    "android/os/Environment", "isExternalStorageRemovable", "(Ljava/io/File;)Z", file.object());
-                mediaPath = file.callObjectMethod("getAbsolutePath", "()Ljava/lang/String;");
-                out = mediaPath.toString();
-                if (!val)
-                    break;
-            }
-        }
-    }
-    path = out;
-    return out;
-}
+QString homeform::getAndroidDataAppDir() { return appdir::getAndroidDataAppDir(); }
 #endif
 
 quint64 homeform::cryptoKeySettingsProfiles() {
@@ -3896,17 +4023,7 @@ void homeform::restart() {
 #endif
 }
 
-double homeform::heartRateMax() {
-    QSettings settings;
-    double maxHeartRate = 220.0 - settings.value(QStringLiteral("age"), 35).toDouble();
-
-    if (settings.value(QStringLiteral("heart_max_override_enable"), false).toBool())
-        maxHeartRate = settings.value(QStringLiteral("heart_max_override_value"), 195).toDouble();
-    if (maxHeartRate == 0) {
-        maxHeartRate = 190.0;
-    }
-    return maxHeartRate;
-}
+double homeform::heartRateMax() { return trainingload::heartRateMax(); }
 
 void homeform::clearFiles() {
     QString path = homeform::getWritableAppDir();
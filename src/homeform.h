@@ -4,19 +4,26 @@
 #include "bluetooth.h"
 
 #include "fit_profile.hpp"
+#include "ghostrace.h"
 #include "peloton.h"
 #include "screencapture.h"
+#include "sessionexporter.h"
+#include "stravauploadqueue.h"
 #include "sessionline.h"
 #include "smtpclient/src/SmtpMime"
+#include "tilemodel.h"
 #include "trainprogram.h"
+#include "workoutchart.h"
 #include <QChart>
 #include <QColor>
 #include <QGraphicsScene>
 #include <QNetworkReply>
 #include <QOAuth2AuthorizationCodeFlow>
 #include <QQmlApplicationEngine>
+#include <QQmlComponent>
 #include <QQuickItem>
 #include <QQuickItemGrabResult>
+#include <QXYSeries>
 
 class DataObject : public QObject {
 
@@ -42,6 +49,8 @@ class DataObject : public QObject {
                const QString &secondLine = QLatin1String(""), const int gridId = 0);
     void setName(const QString &value);
     void setValue(const QString &value);
+    // formatted only when the value changed and somebody reads it
+    void setValue(double value, int decimals);
     void setSecondLine(const QString &value);
     void setValueFontSize(int value);
     void setValueFontColor(const QString &value);
@@ -50,7 +59,14 @@ class DataObject : public QObject {
     void setGridId(int id);
     QString name() { return m_name; }
     QString icon() { return m_icon; }
-    QString value() { return m_value; }
+    QString value() {
+        if (!m_formatted) {
+            m_value = QString::number(m_number, 'f', m_decimals);
+            m_formatted = true;
+        }
+        return m_value;
+    }
+    double number() const { return m_number; }
     QString secondLine() { return m_secondLine; }
     int gridId() { return m_gridId; }
     int valueFontSize() { return m_valueFontSize; }
@@ -73,9 +89,13 @@ class DataObject : public QObject {
     int m_labelFontSize;
     bool m_writable;
     bool m_visible = true;
+    double m_number = NAN; // NAN for the text values
+    int m_decimals = 0;
+    bool m_formatted = true;
+    tilemodel *m_model = nullptr;
 
   signals:
-    void valueChanged(QString value);
+    void valueChanged();
     void secondLineChanged(QString value);
     void valueFontSizeChanged(int value);
     void valueFontColorChanged(QString value);
@@ -254,6 +274,13 @@ class homeform : public QObject {
         }
     }
 
+    // fills an end of workout chart series in a single call, decimated to the chart width in pixels
+    Q_INVOKABLE void workout_chart_series(QtCharts::QAbstractSeries *series, const QString &channel, int width) {
+        if (QtCharts::QXYSeries *xy = qobject_cast<QtCharts::QXYSeries *>(series)) {
+            xy->replace(workoutchart::points(Session, workoutchart::channelFromName(channel), width));
+        }
+    }
+
     Q_INVOKABLE void update_axes(QtCharts::QAbstractAxis *axisX, QtCharts::QAbstractAxis *axisY) {
         if (axisX && axisY) {
             // Customize axis colors
@@ -398,14 +425,23 @@ class homeform : public QObject {
 
   private:
     QList<QObject *> dataList;
+    tilemodel *tiles = nullptr;
+    // what QML last got, so the notifications are sent only on a change
+    bool deviceState = false;
+    bool lapState = false;
+    QString signalIcon;
     QList<SessionLine> Session;
     bluetooth *bluetoothManager;
     QQmlApplicationEngine *engine;
     trainprogram *trainProgram = nullptr;
     QString backupFitFileName =
         QStringLiteral("QZ-backup-") +
-        QDateTime::currentDateTime().toString().replace(QStringLiteral(":"), QStringLiteral("_")) +
-        QStringLiteral(".fit");
+        QDateTime::currentDateTime().toString().replace(QStringLiteral(":"), QStringLiteral("_"));
+    sessionexporter *exporter = nullptr;
+    stravauploadqueue *stravaQueue = nullptr;
+    QThread *stravaQueueThread = nullptr;
+    QString stravaPendingFitFile = QLatin1String("");
+    void saveSession(int formats, bool wait = false);
 
     int m_topBarHeight = 120;
     QString m_info = QStringLiteral("Connecting...");
@@ -479,17 +515,26 @@ class homeform : public QObject {
     DataObject *steeringAngle;
     DataObject *pidHR;
     DataObject *extIncline;
+    DataObject *ghost;
+    DataObject *tss;
+    DataObject *trimp;
+    DataObject *wPrimeBalance;
 
     QTimer *timer;
     QTimer *backupTimer;
+    // the subsystems that the first screen doesn't need are created after its first frame
+    bool deferredInitDone = false;
+    QList<QQmlComponent *> preloadedPages;
+    void deferredInit();
+
+    ghostrace ghostRace;
 
     QString strava_code;
     QOAuth2AuthorizationCodeFlow *strava_connect();
     void strava_refreshtoken();
-    QNetworkReply *replyStrava;
     QAbstractOAuth::ModifyParametersFunction buildModifyParametersFunction(const QUrl &clientIdentifier,
                                                                            const QUrl &clientIdentifierSharedKey);
-    bool strava_upload_file(const QByteArray &data, const QString &remotename);
+    sessionexporter::upload strava_upload_info();
 
     const QString cryptoKeySettingsProfilesTag = QStringLiteral("cryptoKeySettingsProfiles");
     quint64 cryptoKeySettingsProfiles();
@@ -525,8 +570,11 @@ class homeform : public QObject {
     void trainprogram_open_clicked(const QUrl &fileName);
     void trainprogram_zwo_loaded(const QString &comp);
     void gpx_open_clicked(const QUrl &fileName);
+    void ghost_open_clicked(const QUrl &fileName);
     void gpx_save_clicked();
     void fit_save_clicked();
+    void tcx_save_clicked();
+    void fitEncoded(const QString &filename, const QByteArray &data);
     void strava_connect_clicked();
     void trainProgramSignals();
     void refresh_bluetooth_devices_clicked();
@@ -536,8 +584,6 @@ class homeform : public QObject {
     void onSslErrors(QNetworkReply *reply, const QList<QSslError> &error);
     void networkRequestFinished(QNetworkReply *reply);
     void callbackReceived(const QVariantMap &values);
-    void writeFileCompleted();
-    void errorOccurredUploadStrava(QNetworkReply::NetworkError code);
     void pelotonWorkoutStarted(const QString &name, const QString &instructor);
     void pelotonWorkoutChanged(const QString &name, const QString &instructor);
     void pelotonLoginState(bool ok);
@@ -831,7 +831,7 @@ void horizontreadmill::update() {
                 }
             }
 
-            lastStart = QDateTime::currentMSecsSinceEpoch();
+            lastStart = steadyclock::now();
         }
         if (requestStop != -1) {
             emit debug(QStringLiteral("stopping..."));
@@ -854,7 +854,7 @@ void horizontreadmill::update() {
                 }
             }
 
-            lastStop = QDateTime::currentMSecsSinceEpoch();
+            lastStop = steadyclock::now();
 
             requestStop = -1;
         }
@@ -1566,7 +1566,7 @@ int horizontreadmill::GenerateCRC_CCITT(uint8_t *PUPtr8, int PU16_Count) {
 }
 
 bool horizontreadmill::autoPauseWhenSpeedIsZero() {
-    if (lastStart == 0 || QDateTime::currentMSecsSinceEpoch() > (lastStart + 10000))
+    if (lastStart == 0 || steadyclock::now() > (lastStart + 10000))
         return true;
     else
         return false;
@@ -1581,7 +1581,7 @@ bool horizontreadmill::autoStartWhenSpeedIsGreaterThenZero() {
     // is to understand why it's starting with this strange speed)
     if (!horizon_paragon_x && !horizon_treadmill_7_8) return false;
 
-    if ((lastStop == 0 || QDateTime::currentMSecsSinceEpoch() > (lastStop + 25000)) && requestStop == -1)
+    if ((lastStop == 0 || steadyclock::now() > (lastStop + 25000)) && requestStop == -1)
         return true;
     else
         return false;
@@ -0,0 +1,28 @@
+#include "iothread.h"
+#include <QCoreApplication>
+#include <QThread>
+
+QObject *iothread::context() {
+    static QObject *object = nullptr;
+    if (!object) {
+        QThread *thread = new QThread();
+        thread->setObjectName(QStringLiteral("iothread"));
+        object = new QObject();
+        object->moveToThread(thread);
+        QObject::connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, [thread]() {
+            thread->quit();
+            thread->wait();
+        });
+        thread->start(QThread::HighPriority);
+    }
+    return object;
+}
+
+void iothread::run(const std::function<void()> &f) {
+    QObject *c = context();
+    if (QThread::currentThread() == c->thread()) {
+        f();
+        return;
+    }
+    QMetaObject::invokeMethod(c, f, Qt::BlockingQueuedConnection);
+}
@@ -0,0 +1,19 @@
+#ifndef IOTHREAD_H
+#define IOTHREAD_H
+
+#include <QObject>
+#include <functional>
+
+// Thread of the network I/O of the device layer that must not wait for the user interface.
+// The Dircon servers live here, so the notifications to the apps and their commands keep their timing even when QML
+// or homeform::update keep the main thread busy. The objects living here read the devices only through their
+// telemetry snapshot and send the commands to the drivers with queued calls.
+class iothread {
+  public:
+    // an object living on the I/O thread, the context of the queued calls
+    static QObject *context();
+    // runs f on the I/O thread and waits for it
+    static void run(const std::function<void()> &f);
+};
+
+#endif // IOTHREAD_H
@@ -0,0 +1,117 @@
+#include "linkwatchdog.h"
+#include "qdebugfixup.h"
+#include "steadyclock.h"
+#include <QSettings>
+
+linkwatchdog::linkwatchdog(QObject *parent) : QObject(parent) {
+    timer.setInterval(500);
+    connect(&timer, &QTimer::timeout, this, &linkwatchdog::check);
+}
+
+void linkwatchdog::attach(QLowEnergyController *controller) {
+    QSettings settings;
+    if (!controller || !settings.value(QStringLiteral("bluetooth_watchdog"), false).toBool()) {
+        return;
+    }
+
+    qDeleteAll(services);
+    services.clear();
+    this->controller = controller;
+    // every QLowEnergyService of the same service shares the state of the controller, so these objects get the
+    // same notifications of the ones created by the driver, without touching it
+    const QList<QBluetoothUuid> uuids = controller->services();
+    for (const QBluetoothUuid &uuid : uuids) {
+        QLowEnergyService *s = controller->createServiceObject(uuid, this);
+        if (!s) {
+            continue;
+        }
+        connect(s, &QLowEnergyService::characteristicChanged, this, &linkwatchdog::feed);
+        services.append(s);
+    }
+
+    // a grace period after every connection
+    lastPacket = steadyclock::now();
+    if (m_state == IDLE) {
+        m_state = WATCHING;
+    }
+    timer.start();
+}
+
+void linkwatchdog::setArmed(bool armed) {
+    if (armed == m_armed) {
+        return;
+    }
+    m_armed = armed;
+    if (armed) {
+        lastPacket = steadyclock::now();
+    }
+}
+
+bool linkwatchdog::stalled(qint64 now) const {
+    if (!m_armed || (m_moving && !m_moving())) {
+        return false;
+    }
+    // until the cadence is known, only the minimum
+    qint64 limit = minStallMs;
+    if (samples >= 5) {
+        limit = qMax<qint64>(minStallMs, qRound64(interval * missedIntervals));
+    }
+    return now - lastPacket > limit;
+}
+
+qint64 linkwatchdog::backoffMs(int attempt) { return qMin<qint64>(maxBackoffMs, qint64(1000) << qMin(attempt, 5)); }
+
+void linkwatchdog::feed() {
+    qint64 now = steadyclock::now();
+    if (lastPacket > 0 && m_state != RECONNECTING) {
+        qint64 delta = now - lastPacket;
+        interval = samples ? interval * 0.9 + delta * 0.1 : delta;
+        samples++;
+    }
+    lastPacket = now;
+
+    if (m_state == RECONNECTING) {
+        m_lastRecoveryMs = now - stallAt;
+        attempt = 0;
+        m_state = WATCHING;
+        qDebug() << QStringLiteral("linkwatchdog: notifications back in") << m_lastRecoveryMs << QStringLiteral("ms");
+        emit recovered(m_lastRecoveryMs);
+    }
+}
+
+void linkwatchdog::check() {
+    if (!controller) {
+        timer.stop();
+        m_state = IDLE;
+        return;
+    }
+    qint64 now = steadyclock::now();
+
+    if (m_state == WATCHING) {
+        if (!stalled(now)) {
+            return;
+        }
+        m_stalls++;
+        stallAt = now;
+        attempt = 0;
+        m_state = RECONNECTING;
+        qDebug() << QStringLiteral("linkwatchdog: no notifications for") << now - lastPacket
+                 << QStringLiteral("ms, reconnecting. stalls") << m_stalls;
+        emit stalled();
+        if (controller->state() != QLowEnergyController::UnconnectedState) {
+            controller->disconnectFromDevice();
+        }
+        nextAttempt = now + 1000;
+        return;
+    }
+
+    if (m_state == RECONNECTING && now >= nextAttempt) {
+        // many drivers reconnect by themselves on the disconnection: only if nobody did it
+        if (controller->state() == QLowEnergyController::UnconnectedState) {
+            qDebug() << QStringLiteral("linkwatchdog: reconnection attempt") << attempt + 1;
+            controller->connectToDevice();
+        }
+        nextAttempt = now + backoffMs(attempt);
+        attempt++;
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef LINKWATCHDOG_H
+#define LINKWATCHDOG_H
+
+#include <QList>
+#include <QLowEnergyController>
+#include <QLowEnergyService>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <functional>
+
+// Watchdog of the bluetooth link of a device, shared by all the drivers through bluetoothdevice.
+// It learns the notification cadence of the device and, when the notifications stop for a few intervals while the
+// link looks up, it drops the connection and reconnects it with a backoff. The driver and its metrics are kept, so
+// the session goes on in place when the notifications are back.
+// Only the devices with a QLowEnergyController are watched, and only while armed and moving: bluetoothdevice arms it
+// at every connection and disarms it while the workout is paused or stopped, and an idle machine (or a power meter
+// nobody pedals) is silent by design, so the silence counts only while the last values of the device say it moves.
+class linkwatchdog : public QObject {
+    Q_OBJECT
+  public:
+    enum STATE { IDLE = 0, WATCHING, RECONNECTING };
+
+    explicit linkwatchdog(QObject *parent = nullptr);
+
+    // listens to the notifications of every service discovered by the controller; called at every
+    // connectedAndDiscovered, since the services are new after a reconnection
+    void attach(QLowEnergyController *controller);
+    // the silence is a stall only while armed; arming it again starts a new grace period
+    void setArmed(bool armed);
+    bool armed() const { return m_armed; }
+    void setMoving(const std::function<bool()> &moving) { m_moving = moving; }
+
+    // the silence up to now is a stall: armed, moving, and longer than missedIntervals of the learned cadence
+    // (minStallMs until it's known)
+    bool stalled(qint64 now) const;
+    // delay before the reconnection attempt n, from 0: 1 s << n, up to maxBackoffMs
+    static qint64 backoffMs(int attempt);
+
+    STATE state() const { return m_state; }
+    int stalls() const { return m_stalls; }
+    // time from the last stall to the first notification after it, -1 if never recovered
+    qint64 lastRecoveryMs() const { return m_lastRecoveryMs; }
+    qint64 intervalMs() const { return qRound64(interval); }
+
+    static const int minStallMs = 5000;
+    static const int missedIntervals = 4;
+    static const int maxBackoffMs = 30000;
+
+  signals:
+    void stalled();
+    void recovered(qint64 ms);
+
+  private:
+    QPointer<QLowEnergyController> controller;
+    QList<QLowEnergyService *> services;
+    QTimer timer;
+    STATE m_state = IDLE;
+    bool m_armed = false;
+    std::function<bool()> m_moving;
+
+    qint64 lastPacket = 0;
+    double interval = 0; // moving average of the time between two notifications
+    int samples = 0;
+
+    qint64 stallAt = 0;
+    qint64 nextAttempt = 0;
+    int attempt = 0;
+    int m_stalls = 0;
+    qint64 m_lastRecoveryMs = -1;
+
+  public slots:
+    // a notification arrived
+    void feed();
+
+  private slots:
+    void check();
+};
+
+#endif // LINKWATCHDOG_H
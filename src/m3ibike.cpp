@@ -136,17 +136,19 @@ double KeiserM3iDeviceSimulator::calcSpeed(keiser_m3i_out_t *f, bool pause) {
 
             this->old_dist = realdist;
             this->old_timeRms = realtime;
-            qDebug() << QStringLiteral("D = (") << realdist << QStringLiteral(",") << acc << QStringLiteral("->") << rem
-                     << QStringLiteral(",") << this->dist_acc << QStringLiteral(") T = (") << realtime
-                     << QStringLiteral(",") << acc_time << QStringLiteral("->") << rem_time << QStringLiteral(",")
-                     << this->timeRms_acc << QStringLiteral(") => ");
+            if (trace)
+                qDebug() << QStringLiteral("D = (") << realdist << QStringLiteral(",") << acc << QStringLiteral("->")
+                         << rem << QStringLiteral(",") << this->dist_acc << QStringLiteral(") T = (") << realtime
+                         << QStringLiteral(",") << acc_time << QStringLiteral("->") << rem_time
+                         << QStringLiteral(",") << this->timeRms_acc << QStringLiteral(") => ");
         } else {
             if (f->timeRAbsms - this->lastUpdatePostedTime >= 1000) {
                 this->lastUpdatePostedTime = f->timeRAbsms;
             }
-            qDebug() << QStringLiteral("P D = (") << realdist << QStringLiteral(",- -> -,") << this->dist_acc
-                     << QStringLiteral(") T = (") << realtime << QStringLiteral(",- -> -,") << this->timeRms_acc
-                     << QStringLiteral(") => ");
+            if (trace)
+                qDebug() << QStringLiteral("P D = (") << realdist << QStringLiteral(",- -> -,") << this->dist_acc
+                         << QStringLiteral(") T = (") << realtime << QStringLiteral(",- -> -,") << this->timeRms_acc
+                         << QStringLiteral(") => ");
         }
 
         if (this->timeRms_acc == 0) {
@@ -154,7 +156,8 @@ double KeiserM3iDeviceSimulator::calcSpeed(keiser_m3i_out_t *f, bool pause) {
         } else {
             f->speed = this->dist_acc / (this->timeRms_acc / 3600.00);
         }
-        qDebug() << f->speed;
+        if (trace)
+            qDebug() << f->speed;
     }
     return f->speed;
 }
@@ -179,7 +182,10 @@ void KeiserM3iDeviceSimulator::detectPause(const keiser_m3i_out_t *f, qint64 ud)
 }
 
 bool KeiserM3iDeviceSimulator::inner_step(keiser_m3i_out_t *f) {
-    qint64 nowms = QDateTime::currentMSecsSinceEpoch();
+    return inner_step(f, steadyclock::now());
+}
+
+bool KeiserM3iDeviceSimulator::inner_step(keiser_m3i_out_t *f, qint64 nowms) {
     if (this->old_time_orig > f->time_orig) {
         qDebug() << QStringLiteral("Setting offsets Km3i because ") << this->old_time_orig << QStringLiteral(" > ")
                  << f->time_orig;
@@ -194,7 +200,8 @@ bool KeiserM3iDeviceSimulator::inner_step(keiser_m3i_out_t *f) {
     f->pulseMn /= 10.0;
     f->rpm /= 10;
     f->rpmMn /= 10.0;
-    qDebug() << QStringLiteral("Returning ") << out;
+    if (trace)
+        qDebug() << QStringLiteral("Returning ") << out;
     return out;
 }
 
@@ -202,9 +209,10 @@ bool KeiserM3iDeviceSimulator::step_cyc(keiser_m3i_out_t *f, qint64 now) {
     qint64 updateDiff = now - lastUpdateTime;
     this->detectPause(f, updateDiff);
     bool nowpause = this->inPause(updateDiff);
-    qDebug() << QStringLiteral("ET=") << this->equalTime << QStringLiteral("ETD=") << this->equalTimeDistance
-             << QStringLiteral(" UD=") << updateDiff << QStringLiteral(" OP=") << oldPause << QStringLiteral(" NP=")
-             << nowpause;
+    if (trace)
+        qDebug() << QStringLiteral("ET=") << this->equalTime << QStringLiteral("ETD=") << this->equalTimeDistance
+                 << QStringLiteral(" UD=") << updateDiff << QStringLiteral(" OP=") << oldPause
+                 << QStringLiteral(" NP=") << nowpause;
     if (!this->oldPause && !nowpause) {
         this->sumTime += updateDiff;
         this->fillTimeRFields(f, now);
@@ -284,7 +292,7 @@ m3ibike::m3ibike(bool noWriteResistance, bool noHeartService) {
     connect(elapsedTimer, &QTimer::timeout, this, [this]() {
         Q_UNUSED(this);
         if (lastTimerRestart > 0) {
-            elapsed = lastTimerRestartOffset + (QDateTime::currentMSecsSinceEpoch() - lastTimerRestart) / 1000.0;
+            elapsed = lastTimerRestartOffset + (steadyclock::now() - lastTimerRestart) / 1000.0;
             moving = elapsed;
         }
     });
@@ -688,7 +696,7 @@ void m3ibike::processAdvertising(const QByteArray &data) {
                 KCal += ((((0.048 * ((double)watts()) + 1.19) *
                            settings.value(QStringLiteral("weight"), 75.0).toFloat() * 3.5) /
                           200.0) /
-                         (60000.0 / ((double)lastRefreshCharacteristicChanged.msecsTo(QDateTime::currentDateTime()))));
+                         (60000.0 / ((double)(steadyclock::now() - lastRefreshCharacteristicChanged))));
         }
         Distance = k3.distance;
         if (!not_in_pause || k3.time_orig <= 10) {
@@ -699,7 +707,7 @@ void m3ibike::processAdvertising(const QByteArray &data) {
         } else if (lastTimerRestart < 0) {
             elapsed = lastTimerRestartOffset = k3.time;
             moving = elapsed;
-            lastTimerRestart = QDateTime::currentMSecsSinceEpoch();
+            lastTimerRestart = steadyclock::now();
             elapsedTimer->start(1s);
         }
         m_jouls += (m_watt.value() * (k3.time - oldtime));
@@ -711,7 +719,7 @@ void m3ibike::processAdvertising(const QByteArray &data) {
             LastCrankEventTime += (uint16_t)(1024.0 / (((double)(Cadence.value())) / 60.0));
         }
 
-        lastRefreshCharacteristicChanged = QDateTime::currentDateTime();
+        lastRefreshCharacteristicChanged = steadyclock::now();
 
 #ifdef Q_OS_ANDROID
         if (antHeart)
@@ -735,6 +743,13 @@ void m3ibike::processAdvertising(const QByteArray &data) {
             }
         }
 
+        // the m3i keeps its own time, it doesn't go through update_metrics
+        if (!paused && k3.time > oldtime) {
+            m_load.sample(k3.time - oldtime, m_watt.value(), currentHeart().value());
+            recordSample();
+        }
+        publishTelemetry();
+
 #if defined(Q_OS_IOS) && !defined(IO_UNDER_QT)
         bool cadence = settings.value("bike_cadence_sensor", false).toBool();
         bool ios_peloton_workaround = settings.value("ios_peloton_workaround", false).toBool();
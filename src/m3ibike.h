@@ -86,8 +86,13 @@ class KeiserM3iDeviceSimulator {
     KeiserM3iDeviceSimulator();
     void inner_reset(int buffSize, int equalTimeDist);
     bool inner_step(keiser_m3i_out_t *f);
+    // same as above, with the time of the advertisement given by the caller (used when replaying)
+    bool inner_step(keiser_m3i_out_t *f, qint64 nowms);
+    // the log of every frame: off when many bikes are decoded at once
+    void setTrace(bool on) { trace = on; }
 
   private:
+    bool trace = true;
 #define M3I_EQUAL_TIME_THRESHOLD 8
 #define M3I_VALID_PULSE_THRESHOLD 50
 #define M3I_PAUSE_DELAY_DETECT_THRESHOLD 10000
@@ -169,7 +174,7 @@ class m3ibike : public bike {
     keiser_m3i_out_t k3;
     qint64 lastTimerRestart = -1;
     int lastTimerRestartOffset = 0;
-    QDateTime lastRefreshCharacteristicChanged = QDateTime::currentDateTime();
+    qint64 lastRefreshCharacteristicChanged = steadyclock::now();
 
     virtualbike *virtualBike = nullptr;
 
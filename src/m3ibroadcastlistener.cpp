@@ -0,0 +1,166 @@
+#include "m3ibroadcastlistener.h"
+#include "qdebugfixup.h"
+#include "steadyclock.h"
+#include <QCoreApplication>
+#include <QJsonObject>
+#include <QSettings>
+#include <algorithm>
+
+m3ibroadcastlistener *m3ibroadcastlistener::instance() {
+    static m3ibroadcastlistener *listener = nullptr;
+    if (!listener) {
+        listener = new m3ibroadcastlistener(QCoreApplication::instance());
+    }
+    return listener;
+}
+
+m3ibroadcastlistener::m3ibroadcastlistener(QObject *parent) : QObject(parent) {
+    QSettings settings;
+    buffSize = settings.value(QStringLiteral("m3i_bike_speed_buffsize"), 90).toInt();
+    seen.reserve(256);
+    for (rider &r : riders) {
+        r.decoder.setTrace(false);
+    }
+}
+
+m3ibroadcastlistener::~m3ibroadcastlistener() { stop(); }
+
+void m3ibroadcastlistener::start() {
+    if (running) {
+        return;
+    }
+    if (!discoveryAgent) {
+        discoveryAgent = new QBluetoothDeviceDiscoveryAgent(this);
+        connect(discoveryAgent, &QBluetoothDeviceDiscoveryAgent::deviceDiscovered, this,
+                &m3ibroadcastlistener::deviceDiscovered);
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 12, 0))
+        connect(discoveryAgent, &QBluetoothDeviceDiscoveryAgent::deviceUpdated, this,
+                &m3ibroadcastlistener::deviceUpdated);
+#endif
+        connect(discoveryAgent, &QBluetoothDeviceDiscoveryAgent::canceled, this,
+                &m3ibroadcastlistener::discoveryFinished);
+        connect(discoveryAgent, &QBluetoothDeviceDiscoveryAgent::finished, this,
+                &m3ibroadcastlistener::discoveryFinished);
+        discoveryAgent->setLowEnergyDiscoveryTimeout(600000);
+    }
+    running = true;
+    qDebug() << QStringLiteral("m3ibroadcastlistener: started");
+    discoveryAgent->start(QBluetoothDeviceDiscoveryAgent::LowEnergyMethod);
+}
+
+void m3ibroadcastlistener::stop() {
+    running = false;
+    if (discoveryAgent && discoveryAgent->isActive()) {
+        discoveryAgent->stop();
+    }
+}
+
+void m3ibroadcastlistener::deviceDiscovered(const QBluetoothDeviceInfo &device) {
+    if (!device.name().startsWith(QStringLiteral("M3"))) {
+        return;
+    }
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 12, 0))
+    qint64 now = steadyclock::now();
+    QHash<quint16, QByteArray> datas = device.manufacturerData();
+    QHashIterator<quint16, QByteArray> i(datas);
+    while (i.hasNext()) {
+        i.next();
+        if (processAdvertising(i.value(), now) >= 0) {
+            return;
+        }
+    }
+#endif
+}
+
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 12, 0))
+void m3ibroadcastlistener::deviceUpdated(const QBluetoothDeviceInfo &device,
+                                         QBluetoothDeviceInfo::Fields updateFields) {
+    if (updateFields & QBluetoothDeviceInfo::Field::ManufacturerData) {
+        deviceDiscovered(device);
+    }
+}
+#endif
+
+void m3ibroadcastlistener::discoveryFinished() {
+    // the bikes never stop broadcasting, so neither does the scan
+    if (running && discoveryAgent) {
+        discoveryAgent->start(QBluetoothDeviceDiscoveryAgent::LowEnergyMethod);
+    }
+}
+
+int m3ibroadcastlistener::processAdvertising(const QByteArray &data, qint64 now) {
+    keiser_m3i_out_t k3;
+    if (!m3ibike::parse_data(data, &k3) || !m3ibike::valid_id(k3.system_id)) {
+        return -1;
+    }
+
+    rider &r = riders[k3.system_id];
+    const bool first = !r.heard;
+    if (first) {
+        r.heard = true;
+        seen.insert(std::lower_bound(seen.begin(), seen.end(), (quint8)k3.system_id), (quint8)k3.system_id);
+    }
+    if (first || now - r.lastSeen > staleMs) {
+        // a new bike, or a bike silent for a while: it's a new ride
+        r.decoder.inner_reset(buffSize, 2500);
+    }
+    r.active = r.decoder.inner_step(&k3, now);
+    r.k3 = k3;
+    r.lastSeen = now;
+    emit bikeUpdated(k3.system_id);
+    return k3.system_id;
+}
+
+QJsonArray m3ibroadcastlistener::table(qint64 now) const {
+    QJsonArray out;
+    for (quint8 id : seen) {
+        const rider &r = riders[id];
+        if (now - r.lastSeen > staleMs) {
+            continue;
+        }
+        QJsonObject bike;
+        bike[QStringLiteral("id")] = id;
+        bike[QStringLiteral("watt")] = r.k3.watt;
+        bike[QStringLiteral("cadence")] = r.k3.rpm;
+        bike[QStringLiteral("heart")] = r.k3.pulse;
+        bike[QStringLiteral("speed")] = r.k3.speed;
+        bike[QStringLiteral("distance")] = r.k3.distance;
+        bike[QStringLiteral("calories")] = r.k3.calorie;
+        bike[QStringLiteral("time")] = r.k3.time;
+        bike[QStringLiteral("resistance")] = r.k3.incline;
+        bike[QStringLiteral("avgWatt")] = r.k3.wattMn;
+        bike[QStringLiteral("avgCadence")] = r.k3.rpmMn;
+        bike[QStringLiteral("avgHeart")] = r.k3.pulseMn;
+        bike[QStringLiteral("avgSpeed")] = r.k3.speedMn;
+        bike[QStringLiteral("active")] = r.active;
+        bike[QStringLiteral("age")] = now - r.lastSeen;
+        out.append(bike);
+    }
+    return out;
+}
+
+QByteArray m3ibroadcastlistener::encodeFrame(int id, int rpm, int pulse, int watt, int calories, int seconds,
+                                             double distance, int incline) {
+    // rpm and pulse are in tenths, the distance is in tenths of km with the metric flag
+    uint16_t dist = 0x8000 | (qRound(distance * 10.0) & 0x7FFF);
+    QByteArray frame(17, 0);
+    uint8_t *arr = (uint8_t *)frame.data();
+    arr[0] = 0x06;
+    arr[1] = 0x30;
+    arr[2] = 0;
+    arr[3] = id;
+    arr[4] = rpm & 0xFF;
+    arr[5] = (rpm >> 8) & 0xFF;
+    arr[6] = pulse & 0xFF;
+    arr[7] = (pulse >> 8) & 0xFF;
+    arr[8] = watt & 0xFF;
+    arr[9] = (watt >> 8) & 0xFF;
+    arr[10] = calories & 0xFF;
+    arr[11] = (calories >> 8) & 0xFF;
+    arr[12] = seconds / 60;
+    arr[13] = seconds % 60;
+    arr[14] = dist & 0xFF;
+    arr[15] = (dist >> 8) & 0xFF;
+    arr[16] = incline;
+    return frame;
+}
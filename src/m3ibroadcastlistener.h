@@ -0,0 +1,68 @@
+#ifndef M3IBROADCASTLISTENER_H
+#define M3IBROADCASTLISTENER_H
+
+#include "m3ibike.h"
+#include <QBluetoothDeviceDiscoveryAgent>
+#include <QBluetoothDeviceInfo>
+#include <QJsonArray>
+#include <QObject>
+#include <QVector>
+
+// Passive listener for a room full of Keiser M3i bikes.
+// The M3i never accepts a connection: it only broadcasts its data in the manufacturer data of the advertisement,
+// so one scanner is enough for all the bikes. Every frame is routed by the bike id (0-255) straight to the slot
+// of that bike, which keeps its own decoder state, so the cost of a frame doesn't depend on how many bikes are
+// in the room.
+class m3ibroadcastlistener : public QObject {
+    Q_OBJECT
+  public:
+    static m3ibroadcastlistener *instance();
+    explicit m3ibroadcastlistener(QObject *parent = nullptr);
+    ~m3ibroadcastlistener();
+
+    void start();
+    void stop();
+    bool isRunning() const { return running; }
+
+    // decodes one advertisement; returns the bike id or -1 if the frame isn't a valid M3i frame
+    int processAdvertising(const QByteArray &data, qint64 now);
+    // one object for every bike heard in the last staleMs, with the values of its decoder (the speed is computed,
+    // the time and the distance go on across the restarts of the console): id, watt, cadence, heart, speed (km/h),
+    // distance (km), calories, time (s), resistance, the averages of the ride, active (false in pause) and age
+    // (milliseconds since the last frame)
+    QJsonArray table(qint64 now) const;
+
+    // builds an advertisement payload like the one of the bike (firmware 6, software 0x30)
+    static QByteArray encodeFrame(int id, int rpm, int pulse, int watt, int calories, int seconds, double distance,
+                                  int incline);
+
+    static const int staleMs = 10000;
+
+  signals:
+    void bikeUpdated(int id);
+
+  private:
+    struct rider {
+        KeiserM3iDeviceSimulator decoder;
+        keiser_m3i_out_t k3;
+        bool active = false;
+        bool heard = false; // a frame of this id arrived since the start
+        qint64 lastSeen = 0;
+    };
+
+    rider riders[256];
+    // the ids heard since the start, sorted: only the table walks it
+    QVector<quint8> seen;
+    QBluetoothDeviceDiscoveryAgent *discoveryAgent = nullptr;
+    bool running = false;
+    int buffSize = 90;
+
+  private slots:
+    void deviceDiscovered(const QBluetoothDeviceInfo &device);
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 12, 0))
+    void deviceUpdated(const QBluetoothDeviceInfo &device, QBluetoothDeviceInfo::Fields updateFields);
+#endif
+    void discoveryFinished();
+};
+
+#endif // M3IBROADCASTLISTENER_H
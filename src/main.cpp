@@ -1,5 +1,7 @@
+#ifndef QZ_BRIDGE
 #include <QApplication>
 #include <QStyleFactory>
+#endif
 #include <stdio.h>
 #include <stdlib.h>
 #ifdef Q_OS_LINUX
@@ -7,18 +9,28 @@
 #include <unistd.h> // getuid
 #endif
 #endif
-#include <QQmlContext>
 
+#include "appdir.h"
 #include "bluetooth.h"
 #include "domyostreadmill.h"
-#include "homeform.h"
-#include "mainwindow.h"
+#include "startupprofiler.h"
+#include "studiogateway.h"
 #include "qfit.h"
 #include "virtualtreadmill.h"
-#include <QDir>
+#ifdef QZ_BRIDGE
+#include "homefitnessbuddy.h"
+#include "peloton.h"
+#include "powerzonepack.h"
+#include "sessionrecorder.h"
+#else
+#include "homeform.h"
+#include "mainwindow.h"
 #include <QGuiApplication>
-#include <QOperatingSystemVersion>
 #include <QQmlApplicationEngine>
+#include <QQmlContext>
+#endif
+#include <QDir>
+#include <QOperatingSystemVersion>
 #include <QSettings>
 #include <QStandardPaths>
 #ifdef CHARTJS
@@ -67,6 +79,9 @@ bool nordictrack_10_treadmill = false;
 bool reebok_fr30_treadmill = false;
 QString trainProgram;
 QString deviceName = QLatin1String("");
+QString studioGateway = QLatin1String("");
+quint16 studioGatewayPort = 4890;
+bool startupProfile = false;
 uint32_t pollDeviceTime = 200;
 uint8_t bikeResistanceOffset = 4;
 double bikeResistanceGain = 1.0;
@@ -79,6 +94,11 @@ QString logfilename = QStringLiteral("debug-") +
                       QStringLiteral(".log");
 static const QtMessageHandler QT_DEFAULT_MESSAGE_HANDLER = qInstallMessageHandler(0);
 
+// the startup ends at the first turn of the event loop, except in the QML flow that waits for its first frame
+static void finishStartupProfile() {
+    QTimer::singleShot(0, []() { startupprofiler::finish(); });
+}
+
 QCoreApplication *createApplication(int &argc, char *argv[]) {
 
     QSettings settings;
@@ -141,6 +161,16 @@ QCoreApplication *createApplication(int &argc, char *argv[]) {
 
             deviceName = argv[++i];
         }
+        if (!qstrcmp(argv[i], "-studio-gateway")) {
+
+            studioGateway = argv[++i];
+        }
+        if (!qstrcmp(argv[i], "-studio-gateway-port")) {
+
+            studioGatewayPort = atoi(argv[++i]);
+        }
+        if (!qstrcmp(argv[i], "-startup-profile"))
+            startupProfile = true;
         if (!qstrcmp(argv[i], "-peloton-username")) {
 
             peloton_username = argv[++i];
@@ -171,6 +201,12 @@ QCoreApplication *createApplication(int &argc, char *argv[]) {
         }
     }
 
+#ifdef QZ_BRIDGE
+    // the bridge has no UI at all, whatever the command line says
+    Q_UNUSED(nogui)
+    forceQml = false;
+    return new QCoreApplication(argc, argv);
+#else
     if (nogui) {
         return new QCoreApplication(argc, argv);
     } else if (forceQml) {
@@ -212,6 +248,7 @@ QCoreApplication *createApplication(int &argc, char *argv[]) {
 
         return a;
     }
+#endif
 }
 
 void myMessageOutput(QtMsgType type, const QMessageLogContext &context, const QString &msg) {
@@ -250,7 +287,7 @@ void myMessageOutput(QtMsgType type, const QMessageLogContext &context, const QS
 
     if (logs == true || logdebug == true) {
 
-        QString path = homeform::getWritableAppDir();
+        QString path = appdir::getWritableAppDir();
 
         // Linux log files are generated on binary location
 
@@ -267,6 +304,7 @@ void myMessageOutput(QtMsgType type, const QMessageLogContext &context, const QS
 
 int main(int argc, char *argv[]) {
 
+    startupprofiler::begin("application");
 #ifdef Q_OS_ANDROID
     qputenv("QT_ANDROID_VOLUME_KEYS", "1"); // "1" is dummy
 #endif
@@ -294,8 +332,11 @@ int main(int argc, char *argv[]) {
     app->setOrganizationName(QStringLiteral("Roberto Viola"));
     app->setOrganizationDomain(QStringLiteral("robertoviola.cloud"));
     app->setApplicationName(QStringLiteral("qDomyos-Zwift"));
+    startupprofiler::end();
 
+    startupprofiler::begin("settings");
     QSettings settings;
+    startupprofiler::setEnabled(startupProfile || settings.value(QStringLiteral("startup_profile"), false).toBool());
 #if !defined(Q_OS_ANDROID) && !defined(Q_OS_IOS)
     if (forceQml)
 #endif
@@ -342,6 +383,7 @@ int main(int argc, char *argv[]) {
             qDebug() << s << settings.value(s);
         }
     }
+    startupprofiler::end();
 
 #if 0 // test gpx or fit export
     QList<SessionLine> l;
@@ -350,7 +392,7 @@ int main(int argc, char *argv[]) {
         QDateTime d = QDateTime::currentDateTime();
         l.append(SessionLine(i%20,i%10,i,i%300,i%10,i%180,i%6,i%120,i,i, d));
     }
-    QString path = homeform::getWritableAppDir();
+    QString path = appdir::getWritableAppDir();
     qfit::save(path + QDateTime::currentDateTime().toString().replace(":", "_") + ".fit", l, bluetoothdevice::BIKE);
     return 0;
 #endif
@@ -362,12 +404,14 @@ int main(int argc, char *argv[]) {
                           noHeartService); // FIXED: clang-analyzer-cplusplus.NewDeleteLeaks - potential leak
 
             Q_UNUSED(V)
+            finishStartupProfile();
             return app->exec();
         } else if (onlyVirtualTreadmill) {
             virtualtreadmill V(new treadmill(),
                                noHeartService); // FIXED: clang-analyzer-cplusplus.NewDeleteLeaks - potential leak
 
             Q_UNUSED(V)
+            finishStartupProfile();
             return app->exec();
         } else if (testPeloton) {
             settings.setValue("peloton_username", peloton_username);
@@ -382,6 +426,7 @@ int main(int argc, char *argv[]) {
             });
             QObject::connect(p, &peloton::workoutStarted,
                              [&](QString workout_name, QString instructor) { app->exit(0); });
+            finishStartupProfile();
             return app->exec();
         } else if (testHomeFitnessBudy) {
             homefitnessbuddy *h = new homefitnessbuddy(0, 0);
@@ -398,6 +443,7 @@ int main(int argc, char *argv[]) {
                     exit(1);
                 }
             });
+            finishStartupProfile();
             return app->exec();
         } else if (testPowerZonePack) {
             powerzonepack *h = new powerzonepack(0, 0);
@@ -414,6 +460,7 @@ int main(int argc, char *argv[]) {
                     exit(1);
                 }
             });
+            finishStartupProfile();
             return app->exec();
         }
     }
@@ -421,14 +468,30 @@ int main(int argc, char *argv[]) {
 
     settings.setValue(QStringLiteral("app_opening"), settings.value(QStringLiteral("app_opening"), 0).toInt() + 1);
 
+    // one process for all the machines of a studio: -studio-gateway "name 1,name 2,..."
+    if (!studioGateway.isEmpty()) {
+        studiogateway gateway(studioGateway.split(QLatin1Char(','), Qt::SkipEmptyParts), studioGatewayPort);
+        finishStartupProfile();
+        return app->exec();
+    }
+
     /* test virtual echelon
      * settings.setValue("virtual_device_echelon", true);
     virtualbike* V = new virtualbike(new bike(), noWriteResistance, noHeartService);
     Q_UNUSED(V)
     return app->exec();*/
+    startupprofiler::begin("bluetooth");
     bluetooth bl(logs, deviceName, noWriteResistance, noHeartService, pollDeviceTime, noConsole, testResistance,
                  bikeResistanceOffset,
                  bikeResistanceGain); // FIXED: clang-analyzer-cplusplus.NewDeleteLeaks - potential leak
+    startupprofiler::end();
+
+#ifdef QZ_BRIDGE
+    // headless bridge: the workouts are recorded here, as there is no homeform
+    sessionrecorder recorder(&bl, appdir::getWritableAppDir());
+    finishStartupProfile();
+    return app->exec();
+#else
 
 #ifdef Q_OS_IOS
 #ifndef IO_UNDER_QT
@@ -494,8 +557,12 @@ int main(int argc, char *argv[]) {
 #else
         engine.rootContext()->setContextProperty("CHARTJS", QVariant(false));
 #endif
+        startupprofiler::begin("main.qml");
         engine.load(url);
+        startupprofiler::end();
+        startupprofiler::begin("homeform");
         homeform *h = new homeform(&engine, &bl);
+        startupprofiler::end();
         QObject::connect(app.data(), &QCoreApplication::aboutToQuit, h,
                          &homeform::aboutToQuit); // NOTE: clazy-unneeded-cast
 
@@ -532,6 +599,8 @@ int main(int argc, char *argv[]) {
     } else {
         // start non-GUI version...
     }
+    finishStartupProfile();
     return app->exec();
 #endif
+#endif // QZ_BRIDGE
 }
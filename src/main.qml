@@ -16,10 +16,12 @@ ApplicationWindow {
     title: qsTr("Stack")
 
     signal gpx_open_clicked(url name)
+    signal ghost_open_clicked(url name)
     signal trainprogram_open_clicked(url name)
     signal trainprogram_zwo_loaded(string s)
     signal gpx_save_clicked()
     signal fit_save_clicked()
+    signal tcx_save_clicked()
     signal refresh_bluetooth_devices_clicked()
     signal strava_connect_clicked()
     signal loadSettings(url name)
@@ -470,6 +472,15 @@ ApplicationWindow {
                     drawer.close()
                 }
             }
+            ItemDelegate {
+                id: ghost_open
+                text: qsTr("Race a Ghost (FIT)")
+                width: parent.width
+                onClicked: {
+                    fileDialogGhost.visible = true
+                    drawer.close()
+                }
+            }
             ItemDelegate {
                 id: trainprogram_open
                 text: qsTr("Open Train Program")
@@ -513,6 +524,16 @@ ApplicationWindow {
                     popupSaveFile.open()
                 }
             }
+            ItemDelegate {
+                id: tcx_save
+                text: qsTr("Save TCX")
+                width: parent.width
+                onClicked: {
+                    tcx_save_clicked()
+                    drawer.close()
+                    popupSaveFile.open()
+                }
+            }
             ItemDelegate {
                 id: strava_connect
                 text: qsTr("Connect to Strava")
@@ -567,6 +588,21 @@ ApplicationWindow {
 						  fileDialogGPX.close()
 						}
 					}
+				FileDialog {
+				    id: fileDialogGhost
+					 title: "Please choose a FIT file"
+					 folder: shortcuts.home
+					 nameFilters: ["FIT files (*.fit)"]
+					 onAccepted: {
+					     console.log("You chose: " + fileDialogGhost.fileUrl)
+						  ghost_open_clicked(fileDialogGhost.fileUrl)
+						  fileDialogGhost.close()
+						}
+					 onRejected: {
+					     console.log("Canceled")
+						  fileDialogGhost.close()
+						}
+					}
         }
     }    
 
@@ -495,6 +495,10 @@ void MainWindow::on_difficulty_valueChanged(int value) {
             trainProgram->loadedRows.at(i).speed + (trainProgram->loadedRows.at(i).speed * (0.02 * (value - 50)));
         trainProgram->rows[i].inclination = trainProgram->loadedRows.at(i).inclination +
                                             (trainProgram->loadedRows.at(i).inclination * (0.02 * (value - 50)));
+        if (trainProgram->loadedRows.at(i).speed_end != -1) {
+            trainProgram->rows[i].speed_end = trainProgram->loadedRows.at(i).speed_end +
+                                              (trainProgram->loadedRows.at(i).speed_end * (0.02 * (value - 50)));
+        }
     }
 
     int countRow = 0;
@@ -1,4 +1,5 @@
 #include "mcfbike.h"
+#include "driverregistry.h"
 #include "ios/lockscreen.h"
 #include "keepawakehelper.h"
 #include "virtualbike.h"
@@ -16,6 +17,10 @@ using namespace std::chrono_literals;
 extern quint8 QZ_EnableDiscoveryCharsAndDescripttors;
 #endif
 
+DRIVERREGISTRY_ADD_QUIET(mcfbike,
+                         new mcfbike(p.noWriteResistance, p.noHeartService, p.bikeResistanceOffset, p.bikeResistanceGain),
+                         QStringLiteral("MCF-"));
+
 mcfbike::mcfbike(bool noWriteResistance, bool noHeartService, uint8_t bikeResistanceOffset, double bikeResistanceGain) {
 #ifdef Q_OS_IOS
     QZ_EnableDiscoveryCharsAndDescripttors = true;
@@ -39,11 +39,11 @@ void metric::setValue(double v) {
         }
     }
 
-    QDateTime now = QDateTime::currentDateTime();
+    qint64 now = steadyclock::now();
     if (v != m_value) {
         if (m_last5.count() > 1) {
             double diff = v - m_value;
-            double diffFromLastValue = qAbs(now.msecsTo(m_lastChanged));
+            double diffFromLastValue = qAbs(now - m_lastChanged);
             if (diffFromLastValue > 0)
                 m_rateAtSec = diff * (1000.0 / diffFromLastValue);
             else
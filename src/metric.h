@@ -2,6 +2,7 @@
 #define METRIC_H
 
 #include "qdebugfixup.h"
+#include "steadyclock.h"
 #include <QDateTime>
 #include <math.h>
 
@@ -58,7 +59,7 @@ class metric {
     double m_lapMin = 999999999;
     double m_lapMax = 0;
 
-    QDateTime m_lastChanged = QDateTime::currentDateTime();
+    qint64 m_lastChanged = steadyclock::now();
     double m_rateAtSec = 0;
 
     _metric_type m_type = METRIC_OTHER;
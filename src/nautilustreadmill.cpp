@@ -1,4 +1,5 @@
 #include "nautilustreadmill.h"
+#include "driverregistry.h"
 #include "keepawakehelper.h"
 #include "virtualtreadmill.h"
 #include <QBluetoothLocalDevice>
@@ -14,6 +15,9 @@ using namespace std::chrono_literals;
 extern quint8 QZ_EnableDiscoveryCharsAndDescripttors;
 #endif
 
+DRIVERREGISTRY_ADD(nautilustreadmill, new nautilustreadmill(p.pollDeviceTime, p.noConsole, p.noHeartService),
+                   QStringLiteral("NAUTILUS T"));
+
 nautilustreadmill::nautilustreadmill(uint32_t pollDeviceTime, bool noConsole, bool noHeartService,
                                      double forceInitSpeed, double forceInitInclination) {    
 #ifdef Q_OS_IOS
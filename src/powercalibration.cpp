@@ -0,0 +1,161 @@
+#include "powercalibration.h"
+#include "qdebugfixup.h"
+#include <QSettings>
+#include <QVariantList>
+#include <cmath>
+
+powercalibration::powercalibration() { reset(); }
+
+void powercalibration::reset() {
+    for (uint8_t i = 0; i < features; i++) {
+        m_theta[i] = 0;
+        for (uint8_t j = 0; j < features; j++) {
+            m_p[i][j] = (i == j ? 1000.0 : 0.0);
+        }
+    }
+    m_samples = 0;
+}
+
+void powercalibration::featureVector(double cadence, double resistance, double *x) const {
+    // normalized in order to keep the P matrix well conditioned
+    double c = cadence / 100.0;
+    double r = resistance / 100.0;
+    x[0] = 1.0;
+    x[1] = c;
+    x[2] = c * r;
+    x[3] = c * r * r;
+}
+
+bool powercalibration::addSample(double cadence, double resistance, double watts) {
+    if (cadence <= 0 || watts <= 0)
+        return false;
+
+    double x[features];
+    double px[features];
+    featureVector(cadence, resistance, x);
+
+    double denom = m_lambda;
+    double prediction = 0;
+    for (uint8_t i = 0; i < features; i++) {
+        px[i] = 0;
+        for (uint8_t j = 0; j < features; j++) {
+            px[i] += m_p[i][j] * x[j];
+        }
+        denom += x[i] * px[i];
+        prediction += m_theta[i] * x[i];
+    }
+
+    double error = watts - prediction;
+    for (uint8_t i = 0; i < features; i++) {
+        m_theta[i] += (px[i] / denom) * error;
+    }
+
+    // P is symmetric, so P * x * x^T * P is just (P * x) * (P * x)^T
+    for (uint8_t i = 0; i < features; i++) {
+        for (uint8_t j = 0; j < features; j++) {
+            m_p[i][j] = (m_p[i][j] - (px[i] * px[j]) / denom) / m_lambda;
+        }
+    }
+
+    for (uint8_t i = 0; i < features; i++) {
+        if (!std::isfinite(m_theta[i]) || !std::isfinite(m_p[i][i])) {
+            qDebug() << QStringLiteral("powercalibration diverged, resetting the model");
+            reset();
+            return false;
+        }
+    }
+    bound();
+
+    m_samples++;
+    return true;
+}
+
+void powercalibration::bound() {
+    m_theta[0] = qBound(-maxOffset, m_theta[0], maxOffset);
+    for (uint8_t i = 1; i < features; i++) {
+        m_theta[i] = qBound(-maxGain, m_theta[i], maxGain);
+    }
+
+    // with the same cadence and resistance for a long time the forgetting factor makes P grow without limit, and the
+    // first different sample would throw the model away: P is scaled back under the ceiling, which keeps it positive
+    // definite, and the floor on the diagonal keeps the model able to follow the wear
+    double largest = 0;
+    for (uint8_t i = 0; i < features; i++) {
+        largest = qMax(largest, m_p[i][i]);
+    }
+    if (largest > maxVariance) {
+        const double scale = maxVariance / largest;
+        for (uint8_t i = 0; i < features; i++) {
+            for (uint8_t j = 0; j < features; j++) {
+                m_p[i][j] *= scale;
+            }
+        }
+    }
+    for (uint8_t i = 0; i < features; i++) {
+        if (m_p[i][i] < minVariance) {
+            m_p[i][i] = minVariance;
+        }
+    }
+}
+
+double powercalibration::predict(double cadence, double resistance) const {
+    if (cadence <= 0)
+        return 0;
+
+    double x[features];
+    featureVector(cadence, resistance, x);
+    double w = 0;
+    for (uint8_t i = 0; i < features; i++) {
+        w += m_theta[i] * x[i];
+    }
+    if (w < 0)
+        w = 0;
+    return w;
+}
+
+bool powercalibration::load(const QString &deviceName) {
+    QSettings settings;
+    QVariantList l =
+        settings.value(QStringLiteral("power_calibration_model/") + deviceName, QVariantList()).toList();
+    if (l.count() != 1 + features + (features * features)) {
+        reset();
+        return false;
+    }
+
+    int k = 0;
+    m_samples = l.at(k++).toUInt();
+    for (uint8_t i = 0; i < features; i++) {
+        m_theta[i] = l.at(k++).toDouble();
+    }
+    for (uint8_t i = 0; i < features; i++) {
+        for (uint8_t j = 0; j < features; j++) {
+            m_p[i][j] = l.at(k++).toDouble();
+        }
+    }
+    for (uint8_t i = 0; i < features; i++) {
+        if (!std::isfinite(m_theta[i]) || !std::isfinite(m_p[i][i])) {
+            reset();
+            return false;
+        }
+    }
+    // a model saved before the limits
+    bound();
+    qDebug() << QStringLiteral("powercalibration loaded for") << deviceName << m_samples << m_theta[0] << m_theta[1]
+             << m_theta[2] << m_theta[3];
+    return true;
+}
+
+void powercalibration::save(const QString &deviceName) const {
+    QSettings settings;
+    QVariantList l;
+    l.append(m_samples);
+    for (uint8_t i = 0; i < features; i++) {
+        l.append(m_theta[i]);
+    }
+    for (uint8_t i = 0; i < features; i++) {
+        for (uint8_t j = 0; j < features; j++) {
+            l.append(m_p[i][j]);
+        }
+    }
+    settings.setValue(QStringLiteral("power_calibration_model/") + deviceName, l);
+}
@@ -0,0 +1,52 @@
+#ifndef POWERCALIBRATION_H
+#define POWERCALIBRATION_H
+
+#include <QString>
+
+// Online power model learnt from an external power meter.
+// The model is watts = a + b * c + d * c * r + e * c * r^2 (c = cadence, r = resistance) and it's fitted with a
+// recursive least squares filter, so every sample costs a constant amount of work and nothing has to be stored.
+// The coefficients and the covariance are kept bounded, so a burst of wrong samples or a long ride at the same
+// cadence and resistance can't make the model absurd.
+class powercalibration {
+
+  public:
+    powercalibration();
+
+    // false if the sample has been discarded (coasting or no power)
+    bool addSample(double cadence, double resistance, double watts);
+    double predict(double cadence, double resistance) const;
+    bool isReady() const { return m_samples >= minSamples; }
+    uint32_t samples() const { return m_samples; }
+    // a, b, d, e of the model, in the normalized units of the features (cadence / 100, resistance / 100)
+    double coefficient(uint8_t i) const { return m_theta[i]; }
+    double variance(uint8_t i) const { return m_p[i][i]; }
+    void reset();
+
+    // the model is persisted in the QSettings, one model for each machine
+    bool load(const QString &deviceName);
+    void save(const QString &deviceName) const;
+
+    static const uint8_t minSamples = 120;
+    static const uint8_t features = 4;
+    // watts of the offset a, and of the other coefficients at 100 rpm and resistance 100
+    static constexpr double maxOffset = 300.0;
+    static constexpr double maxGain = 20000.0;
+    // limits of the diagonal of P: the initial value is 1000
+    static constexpr double minVariance = 1e-4;
+    static constexpr double maxVariance = 1e4;
+
+  private:
+    void featureVector(double cadence, double resistance, double *x) const;
+    // clamps the coefficients and the diagonal of P
+    void bound();
+
+    double m_theta[features];
+    double m_p[features][features];
+    uint32_t m_samples = 0;
+
+    // forgetting factor: old samples slowly lose importance, so the model follows the bike wear
+    const double m_lambda = 0.9995;
+};
+
+#endif // POWERCALIBRATION_H
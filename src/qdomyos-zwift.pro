@@ -1,4 +1,4 @@
-QT += bluetooth widgets xml positioning quick networkauth websockets
+QT += bluetooth widgets xml positioning quick networkauth websockets concurrent sql
 
 QT+= charts
 
@@ -23,6 +23,8 @@ qtHaveModule(httpserver) {
 CONFIG += c++17 console app_bundle optimize_full ltcg
 
 CONFIG += qmltypes
+# the QML is compiled ahead of time, so the pages are not parsed at every start
+CONFIG += qtquickcompiler
 QML_IMPORT_NAME = org.cagnulein.qdomyoszwift
 QML_IMPORT_MAJOR_VERSION = 1
 # Additional import path used to resolve QML modules in Qt Creator's code model
@@ -57,6 +59,8 @@ android: include(../android_openssl/openssl.pri)
 # include(../qtzeroconf/qtzeroconf.pri)
 
 SOURCES += \
+   activitystore.cpp \
+   appdir.cpp \
     characteristicnotifier2a53.cpp \
     characteristicnotifier2a5b.cpp \
     characteristicnotifier2acd.cpp \
@@ -138,6 +142,7 @@ SOURCES += \
 	ftmsbike.cpp \
     ftmsrower.cpp \
 	     gpx.cpp \
+   ghostrace.cpp \
 		heartratebelt.cpp \
    homefitnessbuddy.cpp \
 	homeform.cpp \
@@ -158,6 +163,7 @@ SOURCES += \
    pafersbike.cpp \
    paferstreadmill.cpp \
    peloton.cpp \
+   powercalibration.cpp \
    powerzonepack.cpp \
 	proformbike.cpp \
    proformelliptical.cpp \
@@ -168,6 +174,17 @@ SOURCES += \
 	schwinnic4bike.cpp \
    screencapture.cpp \
 	sessionline.cpp \
+   sessionexporter.cpp \
+   sessionrecorder.cpp \
+   steadyclock.cpp \
+   linkwatchdog.cpp \
+   workoutlibrary.cpp \
+   tilemodel.cpp \
+   iothread.cpp \
+   startupprofiler.cpp \
+   trainingload.cpp \
+   samplebuffer.cpp \
+   driverregistry.cpp \
    shuaa5treadmill.cpp \
 	signalhandler.cpp \
    simplecrypt.cpp \
@@ -194,8 +211,12 @@ SOURCES += \
    sportsplusbike.cpp \
    sportstechbike.cpp \
    strydrunpowersensor.cpp \
+   stravauploadqueue.cpp \
+   studiogateway.cpp \
    tacxneo2.cpp \
+   tcx.cpp \
     tcpclientinfosender.cpp \
+    timeseriesinfosender.cpp \
    technogymmyruntreadmill.cpp \
     technogymmyruntreadmillrfcomm.cpp \
     templateinfosender.cpp \
@@ -207,12 +228,15 @@ SOURCES += \
    ultrasportbike.cpp \
    virtualrower.cpp \
    wahookickrsnapbike.cpp \
+   workoutchart.cpp \
+   chartseries.cpp \
 		yesoulbike.cpp \
 		  trainprogram.cpp \
 		trxappgateusbtreadmill.cpp \
 	 virtualbike.cpp \
 	     virtualtreadmill.cpp \
              m3ibike.cpp \
+   m3ibroadcastlistener.cpp \
                 domyosbike.cpp \
                scanrecordresult.cpp \
    zwiftworkout.cpp
@@ -227,6 +251,8 @@ else: unix:!android: target.path = /opt/$${TARGET}/bin
 INCLUDEPATH += fit-sdk/
 
 HEADERS += \
+   activitystore.h \
+   appdir.h \
     characteristicnotifier2a53.h \
     characteristicnotifier2a5b.h \
     characteristicnotifier2acd.h \
@@ -301,6 +327,7 @@ HEADERS += \
    kingsmithr1protreadmill.h \
    kingsmithr2treadmill.h \
    m3ibike.h \
+   m3ibroadcastlistener.h \
         fitshowtreadmill.h \
 	fit-sdk/FitDecode.h \
 	fit-sdk/FitDeveloperField.h \
@@ -538,6 +565,7 @@ HEADERS += \
    pafersbike.h \
    paferstreadmill.h \
    peloton.h \
+   powercalibration.h \
    powerzonepack.h \
 	proformbike.h \
    proformelliptical.h \
@@ -550,6 +578,18 @@ HEADERS += \
 	schwinnic4bike.h \
    screencapture.h \
 	sessionline.h \
+   sessionexporter.h \
+   sessionrecorder.h \
+   steadyclock.h \
+   linkwatchdog.h \
+   workoutlibrary.h \
+   tilemodel.h \
+   iothread.h \
+   telemetry.h \
+   startupprofiler.h \
+   trainingload.h \
+   samplebuffer.h \
+   driverregistry.h \
    shuaa5treadmill.h \
 	signalhandler.h \
    simplecrypt.h \
@@ -578,8 +618,12 @@ HEADERS += \
    sportsplusbike.h \
    sportstechbike.h \
    strydrunpowersensor.h \
+   stravauploadqueue.h \
+   studiogateway.h \
    tacxneo2.h \
+   tcx.h \
     tcpclientinfosender.h \
+    timeseriesinfosender.h \
    technogymmyruntreadmill.h \
     technogymmyruntreadmillrfcomm.h \
     templateinfosender.h \
@@ -587,6 +631,7 @@ HEADERS += \
    stagesbike.h \
 	toorxtreadmill.h \
 	gpx.h \
+   ghostrace.h \
 	treadmill.h \
 	mainwindow.h \
 	trainprogram.h \
@@ -598,6 +643,8 @@ HEADERS += \
 	virtualtreadmill.h \
 	 domyosbike.h \
    wahookickrsnapbike.h \
+   workoutchart.h \
+   chartseries.h \
         yesoulbike.h \
         scanrecordresult.h \
    zwiftworkout.h
@@ -612,7 +659,8 @@ exists(secret.h): HEADERS += secret.h
 
 RESOURCES += \
    icons.qrc \
-	qml.qrc
+	qml.qrc \
+   templates.qrc
 
 DISTFILES += \
     .clang-format \
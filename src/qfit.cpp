@@ -3,22 +3,58 @@
 #include <cstdlib>
 #include <fstream>
 
+#include "fit_buffer_encode.hpp"
 #include "fit_date_time.hpp"
-#include "fit_encode.hpp"
+#include "fit_decode.hpp"
+#include "fit_record_mesg_listener.hpp"
+#include "fit_runtime_exception.hpp"
 
 #include "fit_file_id_mesg.hpp"
 #include "fit_mesg_broadcaster.hpp"
 
+#include <QFileInfo>
+#include <QVector>
+
 qfit::qfit(QObject *parent) : QObject(parent) {}
 
-void qfit::save(const QString &filename, QList<SessionLine> session, bluetoothdevice::BLUETOOTH_TYPE type,
+bool qfit::save(const QString &filename, const QList<SessionLine> &session, bluetoothdevice::BLUETOOTH_TYPE type,
                 uint32_t processFlag, FIT_SPORT overrideSport) {
-    std::list<fit::RecordMesg> records;
-    fit::Encode encode(fit::ProtocolVersion::V20);
     if (session.isEmpty()) {
-        return;
+        return false;
+    }
+
+    QByteArray fit = encode(session, type, processFlag, overrideSport);
+    if (!write(filename, fit)) {
+        return false;
+    }
+    qDebug() << QStringLiteral("Encoded FIT file") << filename;
+    return true;
+}
+
+bool qfit::write(const QString &filename, const QByteArray &fit) {
+    if (fit.isEmpty()) {
+        return false;
+    }
+
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qDebug() << QStringLiteral("qfit::write error opening") << filename << file.errorString();
+        return false;
+    }
+    if (file.write(fit) != fit.size() || !file.flush()) {
+        qDebug() << QStringLiteral("qfit::write error writing") << filename << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+QByteArray qfit::encode(const QList<SessionLine> &session, bluetoothdevice::BLUETOOTH_TYPE type, uint32_t processFlag,
+                        FIT_SPORT overrideSport) {
+    // the whole file is built in memory, so it can be written to disk or uploaded without a round trip
+    fit::BufferEncode encode;
+    if (session.isEmpty()) {
+        return QByteArray();
     }
-    std::fstream file;
     uint32_t firstRealIndex = 0;
     for (int i = 0; i < session.length(); i++) {
         if ((session.at(i).speed > 0 && (type == bluetoothdevice::TREADMILL || type == bluetoothdevice::ELLIPTICAL)) ||
@@ -32,17 +68,6 @@ void qfit::save(const QString &filename, QList<SessionLine> session, bluetoothde
         startingDistanceOffset = session.at(firstRealIndex).distance;
     }
 
-    file.open(filename.toStdString(), std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
-
-    if (!file.is_open()) {
-
-        printf("Error opening file ExampleActivity.fit\n");
-        return;
-    }
-
-    QFile output(filename);
-    output.open(QIODevice::WriteOnly);
-
     fit::FileIdMesg fileIdMesg; // Every FIT file requires a File ID message
     fileIdMesg.SetType(FIT_FILE_ACTIVITY);
     fileIdMesg.SetManufacturer(FIT_MANUFACTURER_DEVELOPMENT);
@@ -61,6 +86,12 @@ void qfit::save(const QString &filename, QList<SessionLine> session, bluetoothde
     sessionMesg.SetTotalMovingTime(session.last().elapsedTime);
     sessionMesg.SetMinAltitude(0);
     sessionMesg.SetMaxAltitude(session.last().elevationGain);
+    if (session.last().normalizedPower > 0) {
+        sessionMesg.SetNormalizedPower(qRound(session.last().normalizedPower));
+        sessionMesg.SetIntensityFactor(session.last().intensityFactor);
+        sessionMesg.SetTrainingStressScore(session.last().tss);
+        sessionMesg.SetThresholdPower(qRound(session.last().thresholdPower));
+    }
     sessionMesg.SetEvent(FIT_EVENT_SESSION);
     sessionMesg.SetEventType(FIT_EVENT_TYPE_STOP);
     sessionMesg.SetFirstLapIndex(0);
@@ -139,7 +170,6 @@ void qfit::save(const QString &filename, QList<SessionLine> session, bluetoothde
         lapMesg.SetSport(FIT_SPORT_CYCLING);
     }
 
-    encode.Open(file);
     encode.Write(fileIdMesg);
     encode.Write(devIdMesg);
     encode.Write(sessionMesg);
@@ -147,7 +177,10 @@ void qfit::save(const QString &filename, QList<SessionLine> session, bluetoothde
 
     fit::DateTime date((time_t)session.at(firstRealIndex).time.toSecsSinceEpoch());
     SessionLine sl;
+    // the session is shared with the caller, so the distance noise is kept aside instead of changing the lines
+    QVector<double> distanceNoise;
     if (processFlag & QFIT_PROCESS_DISTANCENOISE) {
+        distanceNoise.fill(0.0, session.length());
         double distanceOld = -1.0;
         int startIdx = -1;
         for (int i = firstRealIndex; i < session.length(); i++) {
@@ -159,7 +192,7 @@ void qfit::save(const QString &filename, QList<SessionLine> session, bluetoothde
                 }
                 if (startIdx >= 0) {
                     for (int j = startIdx; j < i; j++) {
-                        session[j].distance += 0.1 * (j - startIdx) / (i - startIdx);
+                        distanceNoise[j] = 0.1 * (j - startIdx) / (i - startIdx);
                     }
                 }
                 distanceOld = sl.distance;
@@ -171,6 +204,9 @@ void qfit::save(const QString &filename, QList<SessionLine> session, bluetoothde
 
         fit::RecordMesg newRecord;
         sl = session.at(i);
+        if (!distanceNoise.isEmpty()) {
+            sl.distance += distanceNoise.at(i);
+        }
         // fit::DateTime date((time_t)session.at(i).time.toSecsSinceEpoch());
         newRecord.SetHeartRate(sl.heart);
         newRecord.SetCadence(sl.cadence);
@@ -181,10 +217,11 @@ void qfit::save(const QString &filename, QList<SessionLine> session, bluetoothde
         newRecord.SetCalories(sl.calories);
         newRecord.SetAltitude(sl.elevationGain);
 
-        // using just the start point as reference in order to avoid pause time
-        // strava ignore the elapsed field
-        // this workaround could leads an accuracy issue.
-        newRecord.SetTimestamp(date.GetTimeStamp() + i);
+        // the start plus the elapsed time of the line, not its wall clock: the pauses are left out on purpose,
+        // strava ignores the elapsed field and would count them as riding time. The elapsed time and not the index,
+        // so a missing line or a line at the native rate doesn't shift the ones after it
+        const qint64 offset = qint64(sl.elapsedTime) - session.at(firstRealIndex).elapsedTime;
+        newRecord.SetTimestamp(date.GetTimeStamp() + FIT_DATE_TIME(qMax<qint64>(0, offset)));
         encode.Write(newRecord);
 
         if (sl.lapTrigger) {
@@ -207,13 +244,106 @@ void qfit::save(const QString &filename, QList<SessionLine> session, bluetoothde
     lapMesg.SetEventType(FIT_EVENT_TYPE_STOP);
     encode.Write(lapMesg);
 
-    if (!encode.Close()) {
+    std::string out = encode.Close();
+    return QByteArray(out.data(), (int)out.size());
+}
+
+namespace {
+// the records are reduced to qfit_point as soon as they are decoded, so only the compact series is kept in memory.
+// Fields missing in a record keep the previous value, and records in the same second are collapsed in one point
+class qfitRecordListener : public fit::RecordMesgListener {
+  public:
+    explicit qfitRecordListener(QVector<qfit_point> *points) : points(points) {}
+
+    void OnMesg(fit::RecordMesg &mesg) override {
+        if (!mesg.IsTimestampValid()) {
+            return;
+        }
+        FIT_DATE_TIME timestamp = mesg.GetTimestamp();
+        if (!started) {
+            firstTimestamp = timestamp;
+            started = true;
+        }
+        if (timestamp < firstTimestamp) {
+            return;
+        }
+
+        qfit_point p = points->isEmpty() ? qfit_point() : points->constLast();
+        p.seconds = timestamp - firstTimestamp;
+        bool hasSpeed = false;
+        if (mesg.IsDistanceValid()) {
+            p.distance = mesg.GetDistance() / 1000.0;
+        }
+        if (mesg.IsEnhancedSpeedValid()) {
+            p.speed = mesg.GetEnhancedSpeed() * 3.6;
+            hasSpeed = true;
+        } else if (mesg.IsSpeedValid()) {
+            p.speed = mesg.GetSpeed() * 3.6;
+            hasSpeed = true;
+        }
+        if (mesg.IsEnhancedAltitudeValid()) {
+            p.altitude = mesg.GetEnhancedAltitude();
+        } else if (mesg.IsAltitudeValid()) {
+            p.altitude = mesg.GetAltitude();
+        }
+        if (mesg.IsPowerValid()) {
+            p.watt = mesg.GetPower();
+        }
+        if (mesg.IsHeartRateValid()) {
+            p.heart = mesg.GetHeartRate();
+        }
+        if (mesg.IsCadenceValid()) {
+            p.cadence = mesg.GetCadence();
+        }
+
+        if (!points->isEmpty() && points->constLast().seconds == p.seconds) {
+            points->last() = p;
+            return;
+        }
+        if (!hasSpeed && !points->isEmpty()) {
+            const qfit_point &prev = points->constLast();
+            p.speed = (p.distance - prev.distance) * 3600.0 / (p.seconds - prev.seconds);
+        }
+        points->append(p);
+    }
+
+  private:
+    QVector<qfit_point> *points;
+    FIT_DATE_TIME firstTimestamp = 0;
+    bool started = false;
+};
+} // namespace
+
+QVector<qfit_point> qfit::open(const QString &filename) {
+    QVector<qfit_point> points;
+    // the decoder reads the file as a stream, so it's never loaded in memory as a whole
+    std::ifstream input(QFile::encodeName(filename).constData(), std::ios::in | std::ios::binary);
+    if (!input.is_open()) {
+        qDebug() << QStringLiteral("qfit::open error opening") << filename;
+        return points;
+    }
+    const qint64 size = QFileInfo(filename).size();
+
+    fit::Decode decode;
+    if (!decode.IsFIT(input)) {
+        qDebug() << QStringLiteral("qfit::open not a FIT file") << filename;
+        return points;
+    }
 
-        printf("Error closing encode.\n");
-        return;
+    // a record every second is the usual rate, so this avoids the reallocations on long activities
+    points.reserve(int(size / 32));
+    qfitRecordListener recordListener(&points);
+    fit::MesgBroadcaster broadcaster;
+    broadcaster.AddListener((fit::RecordMesgListener &)recordListener);
+    input.clear(); // IsFIT could have hit the end of a small file
+    try {
+        decode.Read(input, broadcaster, broadcaster);
+    } catch (const fit::RuntimeException &e) {
+        // a truncated file is still useful: the records decoded so far are kept
+        qDebug() << QStringLiteral("qfit::open decode error") << e.what();
     }
-    file.close();
+    points.squeeze();
 
-    printf("Encoded FIT file ExampleActivity.fit.\n");
-    return;
+    qDebug() << QStringLiteral("qfit::open") << filename << points.count() << QStringLiteral("points");
+    return points;
 }
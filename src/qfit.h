@@ -8,16 +8,36 @@
 #include <QGeoCoordinate>
 #include <QObject>
 #include <QTime>
+#include <QVector>
 
 #define QFIT_PROCESS_NONE 0
 #define QFIT_PROCESS_DISTANCENOISE 1
 
+// one second of a past activity, as read back by qfit::open. It's kept small on purpose: a 5 hours ride
+// is 18000 points, less than half a megabyte
+struct qfit_point {
+    uint32_t seconds = 0; // from the first record
+    float distance = 0;   // km
+    float speed = 0;      // km/h
+    float altitude = 0;   // meters
+    uint16_t watt = 0;
+    uint8_t heart = 0;
+    uint8_t cadence = 0;
+};
+Q_DECLARE_TYPEINFO(qfit_point, Q_PRIMITIVE_TYPE);
+
 class qfit : public QObject {
     Q_OBJECT
   public:
     explicit qfit(QObject *parent = nullptr);
-    static void save(const QString &filename, QList<SessionLine> session, bluetoothdevice::BLUETOOTH_TYPE type,
+    // false if the file couldn't be written
+    static bool save(const QString &filename, const QList<SessionLine> &session, bluetoothdevice::BLUETOOTH_TYPE type,
                      uint32_t processFlag = QFIT_PROCESS_NONE, FIT_SPORT overrideSport = FIT_SPORT_INVALID);
+    static QByteArray encode(const QList<SessionLine> &session, bluetoothdevice::BLUETOOTH_TYPE type,
+                             uint32_t processFlag = QFIT_PROCESS_NONE, FIT_SPORT overrideSport = FIT_SPORT_INVALID);
+    // writes an encoded file, false if it's empty or the write failed
+    static bool write(const QString &filename, const QByteArray &fit);
+    static QVector<qfit_point> open(const QString &filename);
 
   signals:
 };
@@ -48,6 +48,8 @@ void rower::clearStats() {
     elevationAcc = 0;
     m_watt.clear(false);
     WeightLoss.clear(false);
+    m_load.reset();
+    m_samples.clear();
     StrokesCount.clear(false);
     StrokesLength.clear(false);
 
@@ -64,6 +66,7 @@ void rower::clearStats() {
 void rower::setPaused(bool p) {
 
     paused = p;
+    m_watchdog->setArmed(!p);
     moving.setPaused(p);
     elapsed.setPaused(p);
     Speed.setPaused(p);
@@ -0,0 +1,130 @@
+#include "samplebuffer.h"
+#include "sessionline.h"
+#include <QHash>
+#include <QtMath>
+
+void samplebuffer::clear() {
+    m_samples.clear();
+    m_start = QDateTime();
+}
+
+void samplebuffer::append(const sample &s, qint64 wall) {
+    if (!m_samples.isEmpty() && s.ms - m_samples.constLast().ms < 1000 / maxRate) {
+        return;
+    }
+    m_samples.append(s);
+    m_samples.last().wall = wall;
+    if (m_samples.count() == 1) {
+        m_start = QDateTime::fromMSecsSinceEpoch(m_samples.last().wall - s.ms);
+    }
+}
+
+static SessionLine sessionLine(const samplebuffer::sample &s, qint64 ms, qint64 wall) {
+    QGeoCoordinate coordinate;
+    if (!qIsNaN(s.latitude)) {
+        coordinate = QGeoCoordinate(s.latitude, s.longitude, s.altitude);
+    }
+    return SessionLine(s.speed, qRound(s.inclination), s.distance, qRound(s.watts), qRound(s.resistance), 0,
+                       qRound(s.heart), 0, qRound(s.cadence), s.calories, s.elevation, ms / 1000, false, 0, 0, 0, 0,
+                       coordinate, QDateTime::fromMSecsSinceEpoch(wall));
+}
+
+static void copyUiFields(SessionLine &line, const SessionLine &ui) {
+    line.peloton_resistance = ui.peloton_resistance;
+    line.pace = ui.pace;
+    line.totalStrokes = ui.totalStrokes;
+    line.avgStrokesRate = ui.avgStrokesRate;
+    line.maxStrokesRate = ui.maxStrokesRate;
+    line.avgStrokesLength = ui.avgStrokesLength;
+    line.normalizedPower = ui.normalizedPower;
+    line.intensityFactor = ui.intensityFactor;
+    line.tss = ui.tss;
+    line.trimp = ui.trimp;
+    line.thresholdPower = ui.thresholdPower;
+}
+
+QList<SessionLine> samplebuffer::sessionLines(bool nativeRate, const QList<SessionLine> &session) const {
+    QList<SessionLine> lines;
+    if (m_samples.isEmpty()) {
+        return lines;
+    }
+
+    QHash<uint32_t, int> uiLines;
+    for (int i = 0; i < session.count(); i++) {
+        uiLines.insert(session.at(i).elapsedTime, i);
+    }
+    qint64 lapSecond = -1;
+    auto add = [&](const sample &s, qint64 ms, qint64 wall) {
+        SessionLine line = sessionLine(s, ms, wall);
+        const int ui = uiLines.value(line.elapsedTime, -1);
+        if (ui >= 0) {
+            copyUiFields(line, session.at(ui));
+            if (session.at(ui).lapTrigger && lapSecond != qint64(line.elapsedTime)) {
+                line.lapTrigger = true;
+                lapSecond = line.elapsedTime;
+            }
+        }
+        lines.append(line);
+    };
+
+    if (nativeRate) {
+        lines.reserve(m_samples.count());
+        for (const sample &s : m_samples) {
+            add(s, s.ms, s.wall);
+        }
+    } else {
+        // a line for every second, also the ones without samples (they repeat the previous one): the FIT records
+        // are stamped with the start plus their index
+        const qint64 first = m_samples.constFirst().ms / 1000;
+        const qint64 last = m_samples.constLast().ms / 1000;
+        lines.reserve(last - first + 1);
+        sample average = m_samples.constFirst();
+        int i = 0;
+        qint64 wall = average.wall - (average.ms - first * 1000);
+        for (qint64 second = first; second <= last; second++, wall += 1000) {
+            // the wall clock of the start of the second, it jumps forward after a pause
+            if (i < m_samples.count() && m_samples.at(i).ms / 1000 == second) {
+                wall = m_samples.at(i).wall - (m_samples.at(i).ms - second * 1000);
+            }
+            int n = 0;
+            double speed = 0, inclination = 0, watts = 0, cadence = 0, heart = 0, resistance = 0;
+            for (; i < m_samples.count() && m_samples.at(i).ms / 1000 == second; i++, n++) {
+                const sample &s = m_samples.at(i);
+                speed += s.speed;
+                inclination += s.inclination;
+                watts += s.watts;
+                cadence += s.cadence;
+                heart += s.heart;
+                resistance += s.resistance;
+                // cumulative values and position at the end of the second
+                average.calories = s.calories;
+                average.elevation = s.elevation;
+                average.distance = s.distance;
+                average.latitude = s.latitude;
+                average.longitude = s.longitude;
+                average.altitude = s.altitude;
+            }
+            if (n) {
+                average.speed = speed / n;
+                average.inclination = inclination / n;
+                average.watts = watts / n;
+                average.cadence = cadence / n;
+                average.heart = heart / n;
+                average.resistance = resistance / n;
+            }
+            add(average, second * 1000, wall);
+        }
+    }
+
+    // the totals of the training load are in the last line of the UI
+    if (!session.isEmpty()) {
+        const SessionLine &ui = session.constLast();
+        SessionLine &line = lines.last();
+        line.normalizedPower = ui.normalizedPower;
+        line.intensityFactor = ui.intensityFactor;
+        line.tss = ui.tss;
+        line.trimp = ui.trimp;
+        line.thresholdPower = ui.thresholdPower;
+    }
+    return lines;
+}
@@ -0,0 +1,53 @@
+#ifndef SAMPLEBUFFER_H
+#define SAMPLEBUFFER_H
+
+#include <QDateTime>
+#include <QList>
+#include <QVector>
+
+class SessionLine;
+
+// Recording of the workout at the rate of the device, filled by update_metrics at every update (up to maxRate Hz),
+// so it doesn't depend on the 1 Hz timer of the UI. The samples are stamped with the elapsed time of the device, that
+// comes from the monotonic clock and doesn't count the pauses, and with the wall clock for the times of the lines,
+// so after a pause they are the real ones. The exporters get the session from here, reduced to 1 Hz or at the
+// native rate.
+class samplebuffer {
+  public:
+    struct sample {
+        qint64 ms; // elapsed time of the device
+        qint64 wall; // ms since the epoch, set by append
+        float speed;
+        float inclination;
+        float watts;
+        float cadence;
+        float heart;
+        float resistance;
+        float calories;
+        float elevation;
+        double distance;
+        double latitude;
+        double longitude;
+        float altitude;
+    };
+
+    static const int maxRate = 8;
+
+    void clear();
+    // wall is the time of the sample, in ms since the epoch
+    void append(const sample &s, qint64 wall);
+    bool isEmpty() const { return m_samples.isEmpty(); }
+    int count() const { return m_samples.count(); }
+    QDateTime start() const { return m_start; }
+
+    // the session for the exporters: at 1 Hz every second is the average of its samples, with the cumulative values
+    // at its end, otherwise a line for every sample. The fields known only by the UI (Peloton resistance, pace,
+    // strokes, laps and training load) are taken from its 1 Hz session, by elapsed second
+    QList<SessionLine> sessionLines(bool nativeRate, const QList<SessionLine> &session) const;
+
+  private:
+    QVector<sample> m_samples;
+    QDateTime m_start;
+};
+
+#endif // SAMPLEBUFFER_H
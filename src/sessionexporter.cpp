@@ -0,0 +1,126 @@
+#include "sessionexporter.h"
+#include "gpx.h"
+#include "qdebugfixup.h"
+#include "qfit.h"
+#include "tcx.h"
+#include <QFileInfo>
+#include <QFuture>
+#include <QMetaObject>
+#include <QSettings>
+#include <QtConcurrent/QtConcurrentRun>
+
+sessionexporter::sessionexporter(QObject *parent) : QObject(parent) {
+    worker = new QObject();
+    worker->moveToThread(&thread);
+    connect(&thread, &QThread::finished, worker, &QObject::deleteLater);
+    thread.setObjectName(QStringLiteral("sessionexporter"));
+    thread.start(QThread::LowPriority);
+}
+
+sessionexporter::~sessionexporter() {
+    // flushing the pending exports before leaving, a workout must never be lost on exit
+    flush();
+    thread.quit();
+    thread.wait();
+}
+
+void sessionexporter::flush() {
+    QMetaObject::invokeMethod(
+        worker, []() {}, Qt::BlockingQueuedConnection);
+}
+
+void sessionexporter::exportSession(const QList<SessionLine> &session, const samplebuffer &recording,
+                                    bluetoothdevice::BLUETOOTH_TYPE type, const QString &filename, int formats,
+                                    uint32_t processFlag, FIT_SPORT overrideSport, bool wait, const upload &strava) {
+    if (session.isEmpty() || !formats) {
+        return;
+    }
+
+    emit exportStarted(filename);
+    // session and recording are captured by value: they're the immutable snapshots the worker will use
+    QMetaObject::invokeMethod(
+        worker, [this, session, recording, type, filename, formats, processFlag, overrideSport, strava]() {
+            run(session, recording, type, filename, formats, processFlag, overrideSport, strava);
+        },
+        wait ? Qt::BlockingQueuedConnection : Qt::QueuedConnection);
+}
+
+void sessionexporter::run(const QList<SessionLine> &uiSession, const samplebuffer &recording,
+                          bluetoothdevice::BLUETOOTH_TYPE type, const QString &filename, int formats,
+                          uint32_t processFlag, FIT_SPORT overrideSport, const upload &strava) {
+    QList<QPair<int, QFuture<bool>>> jobs;
+
+    // the FIT records have whole seconds timestamps, so FIT gets the recording at 1 Hz.
+    // GPX and TCX can have it at the rate of the device
+    QList<SessionLine> session = uiSession;
+    QList<SessionLine> track = uiSession;
+    if (!recording.isEmpty()) {
+        QSettings settings;
+        session = recording.sessionLines(false, uiSession);
+        track = settings.value(QStringLiteral("recording_native_rate"), false).toBool()
+                    ? recording.sessionLines(true, uiSession)
+                    : session;
+    }
+
+    // the FIT payload is kept in memory too, so the uploaders don't need to read the file back.
+    // It's safe to capture it by reference: all the jobs are finished before leaving this method
+    QByteArray fitData;
+    if (formats & FIT) {
+        jobs.append(qMakePair(int(FIT), QtConcurrent::run([&fitData, session, type, filename, processFlag,
+                                                           overrideSport]() {
+                                  fitData = qfit::encode(session, type, processFlag, overrideSport);
+                                  return qfit::write(filename + QStringLiteral(".fit"), fitData);
+                              })));
+    }
+    if (formats & GPX) {
+        jobs.append(qMakePair(int(GPX), QtConcurrent::run([=]() {
+                                  return gpx::save(filename + QStringLiteral(".gpx"), track, type);
+                              })));
+    }
+    if (formats & TCX) {
+        jobs.append(qMakePair(int(TCX), QtConcurrent::run([=]() {
+                                  return tcx::save(filename + QStringLiteral(".tcx"), track, type);
+                              })));
+    }
+
+    QStringList files;
+    int done = 0;
+    for (auto &job : jobs) {
+        const bool ok = job.second.result();
+        QString f = filename;
+        switch (job.first) {
+        case FIT:
+            f += QStringLiteral(".fit");
+            if (!ok) {
+                break;
+            }
+            emit fitEncoded(f, fitData);
+            if (strava.queue) {
+                if (fitData.isEmpty()) {
+                    qDebug() << QStringLiteral("sessionexporter: empty FIT, not queued for strava") << f;
+                } else {
+                    // enqueue() is thread safe, the queue does the work on its own thread
+                    strava.queue->enqueue(fitData, QFileInfo(f).baseName(), strava.name, strava.description,
+                                          strava.type);
+                }
+            }
+            break;
+        case GPX:
+            f += QStringLiteral(".gpx");
+            break;
+        default:
+            f += QStringLiteral(".tcx");
+            break;
+        }
+        if (ok) {
+            files.append(f);
+            qDebug() << QStringLiteral("sessionexporter: saved") << f;
+            emit exported(job.first, f);
+        } else {
+            qDebug() << QStringLiteral("sessionexporter: error saving") << f;
+            emit exportFailed(job.first, f);
+        }
+        emit progress(++done, jobs.count());
+    }
+    emit finished(files);
+}
@@ -0,0 +1,61 @@
+#ifndef SESSIONEXPORTER_H
+#define SESSIONEXPORTER_H
+
+#include "bluetoothdevice.h"
+#include "fit_profile.hpp"
+#include "sessionline.h"
+#include "stravauploadqueue.h"
+#include <QList>
+#include <QObject>
+#include <QStringList>
+#include <QThread>
+
+// Writes the workout files on a worker thread, so the UI doesn't freeze while a long session is saved.
+// The session is passed as a QList snapshot: it's implicitly shared, so the copy is free and the recording
+// can go on while the exporter is working. When the device has a recording at its own rate, the files are written
+// from it instead of the 1 Hz session of the UI.
+class sessionexporter : public QObject {
+    Q_OBJECT
+  public:
+    enum FORMAT { FIT = 1, GPX = 2, TCX = 4 };
+
+    // a FIT file for Strava: the worker queues it as soon as it's encoded, keyed by its file name, so it doesn't
+    // depend on the caller being still alive (e.g. the save on exit)
+    struct upload {
+        stravauploadqueue *queue = nullptr;
+        QString name;
+        QString description;
+        QString type;
+    };
+
+    explicit sessionexporter(QObject *parent = nullptr);
+    ~sessionexporter();
+
+    // waits for the pending exports
+    void flush();
+
+    // filename is without the extension: every requested format appends its own
+    void exportSession(const QList<SessionLine> &session, const samplebuffer &recording,
+                       bluetoothdevice::BLUETOOTH_TYPE type, const QString &filename, int formats,
+                       uint32_t processFlag = 0, FIT_SPORT overrideSport = FIT_SPORT_INVALID, bool wait = false,
+                       const upload &strava = upload());
+
+  signals:
+    void exportStarted(const QString &filename);
+    void progress(int done, int total);
+    void exported(int format, const QString &filename);
+    // the format couldn't be written: it isn't in the files of finished
+    void exportFailed(int format, const QString &filename);
+    void fitEncoded(const QString &filename, const QByteArray &data);
+    void finished(const QStringList &files);
+
+  private:
+    QThread thread;
+    QObject *worker = nullptr;
+
+    void run(const QList<SessionLine> &session, const samplebuffer &recording, bluetoothdevice::BLUETOOTH_TYPE type,
+             const QString &filename, int formats, uint32_t processFlag, FIT_SPORT overrideSport,
+             const upload &strava);
+};
+
+#endif // SESSIONEXPORTER_H
@@ -27,3 +27,11 @@ SessionLine::SessionLine(double speed, int8_t inclination, double distance, uint
 }
 
 SessionLine::SessionLine() {}
+
+void SessionLine::setTrainingLoad(const trainingload &load) {
+    normalizedPower = load.normalizedPower();
+    intensityFactor = load.intensityFactor();
+    tss = load.tss();
+    trimp = load.trimp();
+    thresholdPower = load.ftp();
+}
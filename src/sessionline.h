@@ -1,6 +1,7 @@
 #ifndef SESSIONLINE_H
 #define SESSIONLINE_H
 
+#include "trainingload.h"
 #include <QDateTime>
 #include <QGeoCoordinate>
 #include <QTimer>
@@ -28,6 +29,14 @@ class SessionLine {
     double avgStrokesLength;
     QGeoCoordinate coordinate;
 
+    // training load of the workout up to this line: the last line has the totals of the session
+    double normalizedPower = 0;
+    double intensityFactor = 0;
+    double tss = 0;
+    double trimp = 0;
+    double thresholdPower = 0;
+    void setTrainingLoad(const trainingload &load);
+
     SessionLine();
     SessionLine(double speed, int8_t inclination, double distance, uint16_t watt, int8_t resistance,
                 int8_t peloton_resistance, uint8_t heart, double pace, uint8_t cadence, double calories,
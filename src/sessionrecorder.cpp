@@ -0,0 +1,114 @@
+#include "sessionrecorder.h"
+#include "qdebugfixup.h"
+#include "bike.h"
+#include "elliptical.h"
+#include "qfit.h"
+#include "rower.h"
+#include "treadmill.h"
+#include <QDir>
+#include <QSettings>
+
+sessionrecorder::sessionrecorder(bluetooth *manager, const QString &folder, const QString &prefix, QObject *parent)
+    : QObject(parent), bt(manager), m_folder(folder), m_prefix(prefix) {
+    connect(&timer, &QTimer::timeout, this, &sessionrecorder::sample);
+    timer.start(1000);
+}
+
+sessionrecorder::~sessionrecorder() { save(); }
+
+void sessionrecorder::sample() {
+    bluetoothdevice *dev = bt->device();
+    if (!dev || !dev->connected()) {
+        // the machine has gone away: the session is closed here, a new one starts when it's back
+        if (!m_session.isEmpty()) {
+            save();
+        }
+        return;
+    }
+
+    m_type = dev->deviceType();
+    const QTime e = dev->elapsedTime();
+    const uint32_t elapsed = e.second() + (e.minute() * 60) + (e.hour() * 3600);
+    if (!dev->isPaused() && elapsed != lastElapsed) {
+        lastElapsed = elapsed;
+        m_session.append(line(dev));
+    }
+}
+
+// seconds per km to the pace of the session, 0 when it's stopped
+static double paceOf(double speed, const QTime &pace) {
+    const int seconds = pace.second() + (pace.minute() * 60);
+    if (!speed || seconds <= 0) {
+        return 0;
+    }
+    return 10000 / seconds;
+}
+
+SessionLine sessionrecorder::line(bluetoothdevice *dev, bool lap) {
+    QSettings settings;
+    double inclination = 0;
+    double resistance = 0;
+    double peloton_resistance = 0;
+    double pace = 0;
+    uint32_t totalStrokes = 0;
+    double avgStrokesRate = 0;
+    double maxStrokesRate = 0;
+    double avgStrokesLength = 0;
+    const double watts = settings.value(QStringLiteral("power_avg_5s"), false).toBool()
+                             ? dev->wattsMetric().average5s()
+                             : dev->wattsMetric().value();
+
+    switch (dev->deviceType()) {
+    case bluetoothdevice::TREADMILL:
+        pace = paceOf(dev->currentSpeed().value(), ((treadmill *)dev)->currentPace());
+        inclination = dev->currentInclination().value();
+        break;
+    case bluetoothdevice::BIKE:
+        // with the cadence sensor of the peloton the inclination is not the one of the bike
+        if (!settings.value(QStringLiteral("bike_cadence_sensor"), false).toBool()) {
+            inclination = dev->currentInclination().value();
+        }
+        resistance = dev->currentResistance().value();
+        peloton_resistance = ((bike *)dev)->pelotonResistance().value();
+        break;
+    case bluetoothdevice::ROWING: {
+        rower *r = (rower *)dev;
+        pace = paceOf(dev->currentSpeed().value(), r->currentPace());
+        resistance = r->currentResistance().value();
+        peloton_resistance = r->pelotonResistance().value();
+        totalStrokes = r->currentStrokesCount().value();
+        avgStrokesRate = r->currentCadence().average();
+        maxStrokesRate = r->currentCadence().max();
+        avgStrokesLength = r->currentStrokesLength().average();
+        break;
+    }
+    case bluetoothdevice::ELLIPTICAL:
+        resistance = dev->currentResistance().value();
+        inclination = dev->currentInclination().value();
+        break;
+    default:
+        break;
+    }
+
+    const QTime e = dev->elapsedTime();
+    SessionLine s(dev->currentSpeed().value(), inclination, dev->odometer(), watts, resistance, peloton_resistance,
+                  (uint8_t)dev->currentHeart().value(), pace, dev->currentCadence().value(), dev->calories().value(),
+                  dev->elevationGain().value(), e.second() + (e.minute() * 60) + (e.hour() * 3600), lap,
+                  totalStrokes, avgStrokesRate, maxStrokesRate, avgStrokesLength, dev->currentCordinate());
+    s.setTrainingLoad(dev->trainingLoad());
+    return s;
+}
+
+void sessionrecorder::save() {
+    if (m_session.count() > 1) {
+        QDir().mkpath(m_folder);
+        QString filename = m_folder + m_prefix +
+                           m_session.constFirst().time.toString().replace(QStringLiteral(":"), QStringLiteral("_")) +
+                           QStringLiteral(".fit");
+        qfit::save(filename, m_session, m_type);
+        qDebug() << QStringLiteral("sessionrecorder saved") << filename;
+        emit saved(filename);
+    }
+    m_session.clear();
+    lastElapsed = 0;
+}
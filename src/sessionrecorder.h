@@ -0,0 +1,45 @@
+#ifndef SESSIONRECORDER_H
+#define SESSIONRECORDER_H
+
+#include "bluetooth.h"
+#include "sessionline.h"
+#include <QList>
+#include <QObject>
+#include <QTimer>
+
+// Records the workout of a bluetooth manager without any UI: one line per second of elapsed time, like the app
+// does. The session is saved as FIT when the device disconnects and when the recorder is destroyed, so it's used
+// by the headless bridge and by every machine of the studio gateway. The line of a second is built by line(), that
+// is the one used by homeform too.
+class sessionrecorder : public QObject {
+    Q_OBJECT
+  public:
+    sessionrecorder(bluetooth *manager, const QString &folder, const QString &prefix = QString(),
+                    QObject *parent = nullptr);
+    ~sessionrecorder();
+
+    const QList<SessionLine> &session() const { return m_session; }
+
+    // the current second of the workout of the device
+    static SessionLine line(bluetoothdevice *dev, bool lap = false);
+
+  public slots:
+    void save();
+
+  signals:
+    void saved(const QString &filename);
+
+  private slots:
+    void sample();
+
+  private:
+    bluetooth *bt;
+    QString m_folder;
+    QString m_prefix;
+    QTimer timer;
+    QList<SessionLine> m_session;
+    bluetoothdevice::BLUETOOTH_TYPE m_type = bluetoothdevice::UNKNOWN;
+    uint32_t lastElapsed = 0;
+};
+
+#endif // SESSIONRECORDER_H
@@ -366,6 +366,25 @@ import Qt.labs.settings 1.0
 
             // from the version 2.10.62
             property string proformtdf4ip: ""
+
+            // from the version 2.10.67
+            property bool power_calibration: false
+            property bool tile_ghost_enabled: false
+            property int  tile_ghost_order: 33
+            property string studio_gateway_url: ""
+            property bool m3i_broadcast_listener: false
+            property bool bluetooth_fast_reconnect: false
+            property bool bluetooth_watchdog: false
+            property bool startup_profile: false
+            property bool tile_tss_enabled: false
+            property int  tile_tss_order: 34
+            property bool tile_trimp_enabled: false
+            property int  tile_trimp_order: 35
+            property bool tile_wprime_balance_enabled: false
+            property int  tile_wprime_balance_order: 36
+            property real heart_rate_resting: 60.0
+            property real w_prime: 20000.0
+            property bool recording_native_rate: false
         }
 
         function paddingZeros(text, limit) {
@@ -517,6 +536,56 @@ import Qt.labs.settings 1.0
                         }
                     }
 
+                    RowLayout {
+                        spacing: 10
+                        Label {
+                            id: labelHeartRateResting
+                            text: qsTr("Resting Heart Rate:")
+                            Layout.fillWidth: true
+                        }
+                        TextField {
+                            id: heartRateRestingTextField
+                            text: settings.heart_rate_resting
+                            horizontalAlignment: Text.AlignRight
+                            Layout.fillHeight: false
+                            Layout.alignment: Qt.AlignRight | Qt.AlignVCenter
+                            inputMethodHints: Qt.ImhDigitsOnly
+                            onAccepted: settings.heart_rate_resting = text
+                            onActiveFocusChanged: if(this.focus) this.cursorPosition = this.text.length
+                        }
+                        Button {
+                            id: okHeartRateRestingButton
+                            text: "OK"
+                            Layout.alignment: Qt.AlignRight | Qt.AlignVCenter
+                            onClicked: settings.heart_rate_resting = heartRateRestingTextField.text
+                        }
+                    }
+
+                    RowLayout {
+                        spacing: 10
+                        Label {
+                            id: labelWPrime
+                            text: qsTr("W' (J):")
+                            Layout.fillWidth: true
+                        }
+                        TextField {
+                            id: wPrimeTextField
+                            text: settings.w_prime
+                            horizontalAlignment: Text.AlignRight
+                            Layout.fillHeight: false
+                            Layout.alignment: Qt.AlignRight | Qt.AlignVCenter
+                            inputMethodHints: Qt.ImhDigitsOnly
+                            onAccepted: settings.w_prime = text
+                            onActiveFocusChanged: if(this.focus) this.cursorPosition = this.text.length
+                        }
+                        Button {
+                            id: okWPrimeButton
+                            text: "OK"
+                            Layout.alignment: Qt.AlignRight | Qt.AlignVCenter
+                            onClicked: settings.w_prime = wPrimeTextField.text
+                        }
+                    }
+
                     RowLayout {
                         spacing: 10
                         Label {
@@ -541,6 +610,31 @@ import Qt.labs.settings 1.0
                         }
                     }
 
+                    RowLayout {
+                        spacing: 10
+                        Label {
+                            id: labelStudioGateway
+                            text: qsTr("Studio Leaderboard:")
+                            Layout.fillWidth: true
+                        }
+                        TextField {
+                            id: studioGatewayTextField
+                            text: settings.studio_gateway_url
+                            placeholderText: "ws://192.168.1.10:4890"
+                            horizontalAlignment: Text.AlignRight
+                            Layout.fillHeight: false
+                            Layout.alignment: Qt.AlignRight | Qt.AlignVCenter
+                            onAccepted: settings.studio_gateway_url = text
+                            onActiveFocusChanged: if(this.focus) this.cursorPosition = this.text.length
+                        }
+                        Button {
+                            id: okStudioGatewayButton
+                            text: "OK"
+                            Layout.alignment: Qt.AlignRight | Qt.AlignVCenter
+                            onClicked: settings.studio_gateway_url = studioGatewayTextField.text
+                        }
+                    }
+
                     RowLayout {
                         spacing: 10
                         Label {
@@ -609,6 +703,21 @@ import Qt.labs.settings 1.0
                         Layout.fillWidth: true
                         onClicked: settings.continuous_moving = checked
                     }
+
+                    SwitchDelegate {
+                        id: recordingNativeRateDelegate
+                        text: qsTr("GPX/TCX at the Device Rate")
+                        spacing: 0
+                        bottomPadding: 0
+                        topPadding: 0
+                        rightPadding: 0
+                        leftPadding: 0
+                        clip: false
+                        checked: settings.recording_native_rate
+                        Layout.alignment: Qt.AlignLeft | Qt.AlignTop
+                        Layout.fillWidth: true
+                        onClicked: settings.recording_native_rate = checked
+                    }
                 }
             }
 
@@ -1838,6 +1947,21 @@ import Qt.labs.settings 1.0
                             Layout.fillWidth: true
                             onClicked: settings.m3i_bike_kcal = checked
                         }
+
+                        SwitchDelegate {
+                            id: m3iBroadcastListenerDelegate
+                            text: qsTr("Listen to all the M3i Bikes (Web Leaderboard)")
+                            spacing: 0
+                            bottomPadding: 0
+                            topPadding: 0
+                            rightPadding: 0
+                            leftPadding: 0
+                            clip: false
+                            checked: settings.m3i_broadcast_listener
+                            Layout.alignment: Qt.AlignLeft | Qt.AlignTop
+                            Layout.fillWidth: true
+                            onClicked: settings.m3i_broadcast_listener = checked
+                        }
                     }
                 }
             }
@@ -3248,6 +3372,134 @@ import Qt.labs.settings 1.0
                             }
                         }
                     }
+
+                    AccordionCheckElement {
+                        id: ghostAccordion
+                        title: qsTr("Ghost")
+                        linkedBoolSetting: "tile_ghost_enabled"
+                        settings: settings
+                        accordionContent: RowLayout {
+                            spacing: 10
+                            Label {
+                                id: labelGhostOrder
+                                text: qsTr("order index:")
+                                Layout.fillWidth: true
+                                horizontalAlignment: Text.AlignRight
+                            }
+                            ComboBox {
+                                id: ghostOrderTextField
+                                model: rootItem.tile_order
+                                displayText: settings.tile_ghost_order
+                                Layout.fillHeight: false
+                                Layout.alignment: Qt.AlignRight | Qt.AlignVCenter
+                                onActivated: {
+                                    displayText = ghostOrderTextField.currentValue
+                                 }
+                            }
+                            Button {
+                                id: okGhostOrderButton
+                                text: "OK"
+                                Layout.alignment: Qt.AlignRight | Qt.AlignVCenter
+                                onClicked: settings.tile_ghost_order = ghostOrderTextField.displayText
+                            }
+                        }
+                    }
+
+                    AccordionCheckElement {
+                        id: tssAccordion
+                        title: qsTr("TSS")
+                        linkedBoolSetting: "tile_tss_enabled"
+                        settings: settings
+                        accordionContent: RowLayout {
+                            spacing: 10
+                            Label {
+                                id: labelTssOrder
+                                text: qsTr("order index:")
+                                Layout.fillWidth: true
+                                horizontalAlignment: Text.AlignRight
+                            }
+                            ComboBox {
+                                id: tssOrderTextField
+                                model: rootItem.tile_order
+                                displayText: settings.tile_tss_order
+                                Layout.fillHeight: false
+                                Layout.alignment: Qt.AlignRight | Qt.AlignVCenter
+                                onActivated: {
+                                    displayText = tssOrderTextField.currentValue
+                                 }
+                            }
+                            Button {
+                                id: okTssOrderButton
+                                text: "OK"
+                                Layout.alignment: Qt.AlignRight | Qt.AlignVCenter
+                                onClicked: settings.tile_tss_order = tssOrderTextField.displayText
+                            }
+                        }
+                    }
+
+                    AccordionCheckElement {
+                        id: trimpAccordion
+                        title: qsTr("TRIMP")
+                        linkedBoolSetting: "tile_trimp_enabled"
+                        settings: settings
+                        accordionContent: RowLayout {
+                            spacing: 10
+                            Label {
+                                id: labelTrimpOrder
+                                text: qsTr("order index:")
+                                Layout.fillWidth: true
+                                horizontalAlignment: Text.AlignRight
+                            }
+                            ComboBox {
+                                id: trimpOrderTextField
+                                model: rootItem.tile_order
+                                displayText: settings.tile_trimp_order
+                                Layout.fillHeight: false
+                                Layout.alignment: Qt.AlignRight | Qt.AlignVCenter
+                                onActivated: {
+                                    displayText = trimpOrderTextField.currentValue
+                                 }
+                            }
+                            Button {
+                                id: okTrimpOrderButton
+                                text: "OK"
+                                Layout.alignment: Qt.AlignRight | Qt.AlignVCenter
+                                onClicked: settings.tile_trimp_order = trimpOrderTextField.displayText
+                            }
+                        }
+                    }
+
+                    AccordionCheckElement {
+                        id: wPrimeBalanceAccordion
+                        title: qsTr("W' Balance")
+                        linkedBoolSetting: "tile_wprime_balance_enabled"
+                        settings: settings
+                        accordionContent: RowLayout {
+                            spacing: 10
+                            Label {
+                                id: labelWPrimeBalanceOrder
+                                text: qsTr("order index:")
+                                Layout.fillWidth: true
+                                horizontalAlignment: Text.AlignRight
+                            }
+                            ComboBox {
+                                id: wPrimeBalanceOrderTextField
+                                model: rootItem.tile_order
+                                displayText: settings.tile_wprime_balance_order
+                                Layout.fillHeight: false
+                                Layout.alignment: Qt.AlignRight | Qt.AlignVCenter
+                                onActivated: {
+                                    displayText = wPrimeBalanceOrderTextField.currentValue
+                                 }
+                            }
+                            Button {
+                                id: okWPrimeBalanceOrderButton
+                                text: "OK"
+                                Layout.alignment: Qt.AlignRight | Qt.AlignVCenter
+                                onClicked: settings.tile_wprime_balance_order = wPrimeBalanceOrderTextField.displayText
+                            }
+                        }
+                    }
                 }
             }
 
@@ -4850,6 +5102,35 @@ import Qt.labs.settings 1.0
                         }
                     }
 
+                    SwitchDelegate {
+                        id: powerCalibrationDelegate
+                        text: qsTr("Learn Power Model from Power Meter")
+                        spacing: 0
+                        bottomPadding: 0
+                        topPadding: 0
+                        rightPadding: 0
+                        leftPadding: 0
+                        clip: false
+                        checked: settings.power_calibration
+                        Layout.alignment: Qt.AlignLeft | Qt.AlignTop
+                        Layout.fillWidth: true
+                        onClicked: settings.power_calibration = checked
+                    }
+
+                    Label {
+                        id: powerCalibrationLabel
+                        text: qsTr("While a power meter is connected, the bike learns its own cadence/resistance to watts model. When the power meter is removed, the learnt model replaces the built-in one.")
+                        font.bold: true
+                        font.italic: true
+                        font.pixelSize: 8
+                        textFormat: Text.PlainText
+                        wrapMode: Text.WordWrap
+                        verticalAlignment: Text.AlignVCenter
+                        Layout.alignment: Qt.AlignLeft | Qt.AlignTop
+                        Layout.fillWidth: true
+                        color: Material.color(Material.Red)
+                    }
+
                     Label {
                         id: stravaLabel
                         text: qsTr("Strava")
@@ -5703,6 +5984,36 @@ import Qt.labs.settings 1.0
                         onClicked: settings.bluetooth_30m_hangs = checked
                     }
 
+                    SwitchDelegate {
+                        id: bluetoothFastReconnectDelegate
+                        text: qsTr("Fast reconnect to the last device")
+                        spacing: 0
+                        bottomPadding: 0
+                        topPadding: 0
+                        rightPadding: 0
+                        leftPadding: 0
+                        clip: false
+                        checked: settings.bluetooth_fast_reconnect
+                        Layout.alignment: Qt.AlignLeft | Qt.AlignTop
+                        Layout.fillWidth: true
+                        onClicked: settings.bluetooth_fast_reconnect = checked
+                    }
+
+                    SwitchDelegate {
+                        id: bluetoothWatchdogDelegate
+                        text: qsTr("Reconnect when the device stops sending data")
+                        spacing: 0
+                        bottomPadding: 0
+                        topPadding: 0
+                        rightPadding: 0
+                        leftPadding: 0
+                        clip: false
+                        checked: settings.bluetooth_watchdog
+                        Layout.alignment: Qt.AlignLeft | Qt.AlignTop
+                        Layout.fillWidth: true
+                        onClicked: settings.bluetooth_watchdog = checked
+                    }
+
                     SwitchDelegate {
                         id: batteryServiceDelegate
                         text: qsTr("Simulate Battery Service")
@@ -6003,6 +6314,21 @@ import Qt.labs.settings 1.0
                         onClicked: settings.log_debug = checked
                     }
 
+                    SwitchDelegate {
+                        id: startupProfileDelegate
+                        text: qsTr("Startup Profile")
+                        spacing: 0
+                        bottomPadding: 0
+                        topPadding: 0
+                        rightPadding: 0
+                        leftPadding: 0
+                        clip: false
+                        checked: settings.startup_profile
+                        Layout.alignment: Qt.AlignLeft | Qt.AlignTop
+                        Layout.fillWidth: true
+                        onClicked: settings.startup_profile = checked
+                    }
+
                     Button {
                         id: clearLogs
                         text: "Clear History"
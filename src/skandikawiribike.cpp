@@ -1,4 +1,5 @@
 #include "skandikawiribike.h"
+#include "driverregistry.h"
 #include "keepawakehelper.h"
 #include "virtualbike.h"
 #include <QBluetoothLocalDevice>
@@ -11,6 +12,11 @@
 
 using namespace std::chrono_literals;
 
+DRIVERREGISTRY_ADD(skandikawiribike,
+                   new skandikawiribike(p.noWriteResistance, p.noHeartService, p.bikeResistanceOffset,
+                                        p.bikeResistanceGain),
+                   QStringLiteral("BFCP"));
+
 skandikawiribike::skandikawiribike(bool noWriteResistance, bool noHeartService, uint8_t bikeResistanceOffset,
                                    double bikeResistanceGain) {
     m_watt.setType(metric::METRIC_WATT);
@@ -1,4 +1,5 @@
 #include "sportsplusbike.h"
+#include "driverregistry.h"
 #include "keepawakehelper.h"
 #include "virtualbike.h"
 #include <QBluetoothLocalDevice>
@@ -12,6 +13,9 @@
 
 using namespace std::chrono_literals;
 
+DRIVERREGISTRY_ADD(sportsplusbike, new sportsplusbike(p.noWriteResistance, p.noHeartService),
+                   QStringLiteral("CARDIOFIT"));
+
 sportsplusbike::sportsplusbike(bool noWriteResistance, bool noHeartService) {
     m_watt.setType(metric::METRIC_WATT);
     Speed.setType(metric::METRIC_SPEED);
@@ -1,4 +1,5 @@
 #include "sportstechbike.h"
+#include "driverregistry.h"
 #include "keepawakehelper.h"
 #include "virtualbike.h"
 #include <QBluetoothLocalDevice>
@@ -12,6 +13,8 @@
 
 using namespace std::chrono_literals;
 
+DRIVERREGISTRY_ADD(sportstechbike, new sportstechbike(p.noWriteResistance, p.noHeartService), QStringLiteral("EW-BK"));
+
 sportstechbike::sportstechbike(bool noWriteResistance, bool noHeartService) {
     m_watt.setType(metric::METRIC_WATT);
     Speed.setType(metric::METRIC_SPEED);
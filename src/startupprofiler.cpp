@@ -0,0 +1,111 @@
+#include "startupprofiler.h"
+#include "appdir.h"
+#include "qdebugfixup.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+startupprofiler &startupprofiler::instance() {
+    static startupprofiler profiler;
+    if (!profiler.clock.isValid()) {
+        profiler.clock.start();
+    }
+    return profiler;
+}
+
+void startupprofiler::setEnabled(bool enabled) { instance().m_enabled = enabled; }
+
+bool startupprofiler::enabled() { return instance().m_enabled; }
+
+void startupprofiler::begin(const char *name) {
+    startupprofiler &p = instance();
+    if (p.finished) {
+        return;
+    }
+    event e;
+    e.name = name;
+    e.start = p.clock.nsecsElapsed() / 1000;
+    e.depth = p.open.count();
+    p.open.append(p.events.count());
+    p.events.append(e);
+}
+
+void startupprofiler::end() {
+    startupprofiler &p = instance();
+    if (p.finished || p.open.isEmpty()) {
+        return;
+    }
+    event &e = p.events[p.open.takeLast()];
+    e.duration = p.clock.nsecsElapsed() / 1000 - e.start;
+}
+
+void startupprofiler::mark(const char *name) {
+    startupprofiler &p = instance();
+    if (p.finished) {
+        return;
+    }
+    event e;
+    e.name = name;
+    e.start = p.clock.nsecsElapsed() / 1000;
+    e.depth = p.open.count();
+    p.events.append(e);
+}
+
+void startupprofiler::finish() {
+    startupprofiler &p = instance();
+    if (p.finished) {
+        return;
+    }
+    while (!p.open.isEmpty()) {
+        end();
+    }
+    p.finished = true;
+    if (!p.m_enabled) {
+        return;
+    }
+
+    for (const event &e : qAsConst(p.events)) {
+        QString line = QString(e.depth * 2, QLatin1Char(' ')) + QString::fromLatin1(e.name);
+        if (e.duration < 0) {
+            qDebug() << QStringLiteral("startup: %1 at %2 ms").arg(line).arg(e.start / 1000.0, 0, 'f', 1);
+        } else {
+            qDebug() << QStringLiteral("startup: %1 %2 ms (at %3 ms)")
+                            .arg(line)
+                            .arg(e.duration / 1000.0, 0, 'f', 1)
+                            .arg(e.start / 1000.0, 0, 'f', 1);
+        }
+    }
+
+    QFile file(appdir::getWritableAppDir() + QStringLiteral("startup_trace.json"));
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        file.write(p.trace());
+        qDebug() << QStringLiteral("startup: trace saved in") << file.fileName();
+    }
+}
+
+QByteArray startupprofiler::trace() const {
+    QJsonArray list;
+    const qint64 pid = QCoreApplication::applicationPid();
+    for (const event &e : events) {
+        QJsonObject o;
+        o[QStringLiteral("name")] = QString::fromLatin1(e.name);
+        o[QStringLiteral("cat")] = QStringLiteral("startup");
+        o[QStringLiteral("ts")] = e.start;
+        o[QStringLiteral("pid")] = pid;
+        o[QStringLiteral("tid")] = 1;
+        if (e.duration < 0) {
+            o[QStringLiteral("ph")] = QStringLiteral("i");
+            o[QStringLiteral("s")] = QStringLiteral("p");
+        } else {
+            o[QStringLiteral("ph")] = QStringLiteral("X");
+            o[QStringLiteral("dur")] = e.duration;
+        }
+        list.append(o);
+    }
+    QJsonObject root;
+    root[QStringLiteral("traceEvents")] = list;
+    root[QStringLiteral("displayTimeUnit")] = QStringLiteral("ms");
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
@@ -0,0 +1,47 @@
+#ifndef STARTUPPROFILER_H
+#define STARTUPPROFILER_H
+
+#include <QElapsedTimer>
+#include <QString>
+#include <QVector>
+
+// Timeline of the startup, from the start of main() to the first frame of the home page and the deferred
+// initialization after it. The phases are always recorded, it's a handful of timestamps; with -startup-profile or
+// the startup_profile setting the timeline is printed in the log and saved as a Chrome trace (chrome://tracing or
+// ui.perfetto.dev) in startup_trace.json of the writable folder. Main thread only.
+class startupprofiler {
+  public:
+    static void setEnabled(bool enabled);
+    static bool enabled();
+
+    static void begin(const char *name);
+    static void end();
+    static void mark(const char *name);
+    // the startup is over: prints the timeline and saves the trace, only the first time
+    static void finish();
+
+    class phase {
+      public:
+        explicit phase(const char *name) { begin(name); }
+        ~phase() { end(); }
+    };
+
+  private:
+    struct event {
+        const char *name;
+        qint64 start; // us from the start of main()
+        qint64 duration = -1;
+        int depth = 0;
+    };
+
+    static startupprofiler &instance();
+    QByteArray trace() const;
+
+    QElapsedTimer clock;
+    QVector<event> events;
+    QVector<int> open; // indexes of the phases not ended yet
+    bool m_enabled = false;
+    bool finished = false;
+};
+
+#endif // STARTUPPROFILER_H
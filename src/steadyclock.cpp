@@ -0,0 +1,14 @@
+#include "steadyclock.h"
+#include <chrono>
+
+static steadyclock realClock;
+static steadyclock *installed = &realClock;
+
+qint64 steadyclock::msecs() const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void steadyclock::install(steadyclock *clock) { installed = clock ? clock : &realClock; }
+
+steadyclock *steadyclock::current() { return installed; }
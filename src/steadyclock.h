@@ -0,0 +1,33 @@
+#ifndef STEADYCLOCK_H
+#define STEADYCLOCK_H
+
+#include <QtGlobal>
+
+// Process wide monotonic clock for the metrics, the drivers and everything measuring intervals.
+// The milliseconds start from an arbitrary origin (not the epoch), they never go back and they don't jump with
+// NTP or a timezone change; use QDateTime only for the timestamps that are shown or saved.
+// A virtualclock can be installed in its place, so a whole workout can be simulated faster than real time.
+class steadyclock {
+  public:
+    virtual ~steadyclock() {}
+    virtual qint64 msecs() const;
+
+    // the tick of the installed clock
+    static qint64 now() { return current()->msecs(); }
+    // nullptr restores the real clock; the caller keeps the ownership
+    static void install(steadyclock *clock);
+    static steadyclock *current();
+};
+
+// virtual time: it moves only when asked
+class virtualclock : public steadyclock {
+  public:
+    explicit virtualclock(qint64 start = 1) : t(start) {}
+    qint64 msecs() const override { return t; }
+    void advance(qint64 ms) { t += qMax<qint64>(0, ms); }
+
+  private:
+    qint64 t;
+};
+
+#endif // STEADYCLOCK_H
@@ -0,0 +1,356 @@
+#include "stravauploadqueue.h"
+#include "qdebugfixup.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHttpMultiPart>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMetaObject>
+#include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QSettings>
+#include <QUrlQuery>
+#include <QVector>
+
+stravauploadqueue::stravauploadqueue(const QString &path, const QUrl &uploadUrl, const QUrl &tokenUrl)
+    : QObject(nullptr), m_path(path), m_uploadUrl(uploadUrl), m_tokenUrl(tokenUrl) {
+    QDir().mkpath(m_path);
+}
+
+void stravauploadqueue::setClientCredentials(const QString &clientId, const QString &clientSecret) {
+    m_clientId = clientId;
+    m_clientSecret = clientSecret;
+}
+
+// the network objects must be created in the thread where the queue lives, so call it after the moveToThread
+void stravauploadqueue::start() {
+    if (!manager) {
+        manager = new QNetworkAccessManager(this);
+        retryTimer = new QTimer(this);
+        retryTimer->setSingleShot(true);
+        connect(retryTimer, &QTimer::timeout, this, &stravauploadqueue::processQueue);
+    }
+    processQueue();
+}
+
+void stravauploadqueue::enqueue(const QByteArray &fit, const QString &externalId, const QString &activityName,
+                                const QString &description, const QString &activityType) {
+    if (fit.isEmpty()) {
+        qDebug() << QStringLiteral("stravauploadqueue: empty FIT, not queued") << externalId;
+        return;
+    }
+    QMetaObject::invokeMethod(this, [this, fit, externalId, activityName, description, activityType]() {
+        enqueueInner(fit, externalId, activityName, description, activityType);
+    });
+}
+
+void stravauploadqueue::enqueueInner(const QByteArray &fit, const QString &externalId, const QString &activityName,
+                                     const QString &description, const QString &activityType) {
+    // the timestamp in front keeps the queue in FIFO order
+    QString safeId = externalId;
+    safeId.replace(QRegularExpression(QStringLiteral("[^A-Za-z0-9_-]")), QStringLiteral("_"));
+    QString job = m_path + QDateTime::currentDateTime().toString(QStringLiteral("yyyyMMddhhmmsszzz")) +
+                  QStringLiteral("_") + safeId;
+
+    QFile payload(job + QStringLiteral(".fit.gz"));
+    if (!payload.open(QIODevice::WriteOnly)) {
+        qDebug() << QStringLiteral("stravauploadqueue: unable to write") << payload.fileName();
+        return;
+    }
+    payload.write(gzip(fit));
+    payload.close();
+
+    QJsonObject meta;
+    meta[QStringLiteral("external_id")] = externalId;
+    meta[QStringLiteral("name")] = activityName;
+    meta[QStringLiteral("description")] = description;
+    meta[QStringLiteral("activity_type")] = activityType;
+    meta[QStringLiteral("attempts")] = 0;
+    meta[QStringLiteral("next_attempt")] = 0;
+    QFile metaFile(job + QStringLiteral(".json"));
+    if (metaFile.open(QIODevice::WriteOnly)) {
+        metaFile.write(QJsonDocument(meta).toJson(QJsonDocument::Compact));
+        metaFile.close();
+    }
+
+    qDebug() << QStringLiteral("stravauploadqueue: queued") << job << fit.size() << QStringLiteral("bytes");
+    if (manager) {
+        processQueue();
+    }
+}
+
+QString stravauploadqueue::nextJob(qint64 *waitMs) {
+    *waitMs = -1;
+    QDir dir(m_path);
+    const QStringList jobs = dir.entryList(QStringList() << QStringLiteral("*.json"), QDir::Files, QDir::Name);
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (const QString &j : jobs) {
+        QString job = m_path + QFileInfo(j).completeBaseName();
+        QFile metaFile(job + QStringLiteral(".json"));
+        if (!QFile::exists(job + QStringLiteral(".fit.gz")) || !metaFile.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+        QJsonObject meta = QJsonDocument::fromJson(metaFile.readAll()).object();
+        qint64 next = (qint64)meta[QStringLiteral("next_attempt")].toDouble();
+        if (next <= now) {
+            return job;
+        }
+        if (*waitMs < 0 || next - now < *waitMs) {
+            *waitMs = next - now;
+        }
+    }
+    return QString();
+}
+
+void stravauploadqueue::processQueue() {
+    if (m_busy || !manager) {
+        return;
+    }
+
+    QSettings settings;
+    if (settings.value(QStringLiteral("strava_refreshtoken")).toString().isEmpty()) {
+        qDebug() << QStringLiteral("stravauploadqueue: strava is not connected, keeping the uploads in the queue");
+        return;
+    }
+
+    qint64 waitMs;
+    QString job = nextJob(&waitMs);
+    if (job.isEmpty()) {
+        if (waitMs >= 0) {
+            retryTimer->start((int)qMin(waitMs, (qint64)retryMaxSeconds * 1000));
+        }
+        return;
+    }
+
+    m_busy = true;
+    m_currentJob = job;
+    if (tokenExpired()) {
+        refreshToken();
+    } else {
+        upload(job);
+    }
+}
+
+bool stravauploadqueue::tokenExpired() {
+    QSettings settings;
+    if (settings.value(QStringLiteral("strava_accesstoken")).toString().isEmpty()) {
+        return true;
+    }
+    // a minute of margin, in order to not start an upload with a token that is going to expire
+    qint64 expires = settings.value(QStringLiteral("strava_expires"), 0).toLongLong();
+    return expires <= QDateTime::currentSecsSinceEpoch() + 60;
+}
+
+void stravauploadqueue::refreshToken() {
+    QSettings settings;
+    QNetworkRequest request(m_tokenUrl);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, QStringLiteral("application/x-www-form-urlencoded"));
+
+    QUrlQuery params;
+    params.addQueryItem(QStringLiteral("client_id"), m_clientId);
+    if (!m_clientSecret.isEmpty()) {
+        params.addQueryItem(QStringLiteral("client_secret"), m_clientSecret);
+    }
+    params.addQueryItem(QStringLiteral("refresh_token"),
+                        settings.value(QStringLiteral("strava_refreshtoken")).toString());
+    params.addQueryItem(QStringLiteral("grant_type"), QStringLiteral("refresh_token"));
+
+    qDebug() << QStringLiteral("stravauploadqueue: refreshing the token");
+    QNetworkReply *reply = manager->post(request, params.query(QUrl::FullyEncoded).toUtf8());
+    connect(reply, &QNetworkReply::finished, this, &stravauploadqueue::tokenRefreshFinished);
+}
+
+void stravauploadqueue::tokenRefreshFinished() {
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    reply->deleteLater();
+
+    if (reply->error() != QNetworkReply::NoError) {
+        jobFailed(m_currentJob, QStringLiteral("token refresh: ") + reply->errorString(), true);
+        return;
+    }
+
+    QJsonDocument document = QJsonDocument::fromJson(reply->readAll());
+    QString access_token = document[QStringLiteral("access_token")].toString();
+    if (access_token.isEmpty()) {
+        jobFailed(m_currentJob, QStringLiteral("token refresh: invalid response"), true);
+        return;
+    }
+
+    QSettings settings;
+    settings.setValue(QStringLiteral("strava_accesstoken"), access_token);
+    settings.setValue(QStringLiteral("strava_refreshtoken"), document[QStringLiteral("refresh_token")].toString());
+    settings.setValue(QStringLiteral("strava_expires"), document[QStringLiteral("expires_at")].toVariant());
+    settings.setValue(QStringLiteral("strava_lastrefresh"), QDateTime::currentDateTime());
+
+    upload(m_currentJob);
+}
+
+void stravauploadqueue::upload(const QString &job) {
+    QFile payload(job + QStringLiteral(".fit.gz"));
+    QFile metaFile(job + QStringLiteral(".json"));
+    if (!payload.open(QIODevice::ReadOnly) || !metaFile.open(QIODevice::ReadOnly)) {
+        jobFailed(job, QStringLiteral("queue file missing"), false);
+        return;
+    }
+    QJsonObject meta = QJsonDocument::fromJson(metaFile.readAll()).object();
+    QSettings settings;
+
+    QHttpMultiPart *multiPart = new QHttpMultiPart(QHttpMultiPart::FormDataType);
+    multiPart->setBoundary(QByteArray::number(QRandomGenerator::global()->generate64(), 16) +
+                           QByteArray::number(QRandomGenerator::global()->generate64(), 16));
+
+    auto appendPart = [multiPart](const QString &name, const QByteArray &body, bool utf8) {
+        QHttpPart part;
+        part.setHeader(QNetworkRequest::ContentDispositionHeader,
+                       QVariant(QStringLiteral("form-data; name=\"") + name + QStringLiteral("\"")));
+        if (utf8) {
+            part.setHeader(QNetworkRequest::ContentTypeHeader, QVariant(QStringLiteral("text/plain;charset=utf-8")));
+        }
+        part.setBody(body);
+        multiPart->append(part);
+    };
+
+    appendPart(QStringLiteral("access_token"),
+               settings.value(QStringLiteral("strava_accesstoken")).toString().toLatin1(), false);
+    appendPart(QStringLiteral("activity_type"), meta[QStringLiteral("activity_type")].toString().toLatin1(), false);
+    if (!meta[QStringLiteral("name")].toString().isEmpty()) {
+        appendPart(QStringLiteral("name"), meta[QStringLiteral("name")].toString().toUtf8(), true);
+    }
+    if (!meta[QStringLiteral("description")].toString().isEmpty()) {
+        appendPart(QStringLiteral("description"), meta[QStringLiteral("description")].toString().toUtf8(), true);
+    }
+    appendPart(QStringLiteral("data_type"), QByteArrayLiteral("fit.gz"), false);
+    appendPart(QStringLiteral("external_id"), meta[QStringLiteral("external_id")].toString().toUtf8(), false);
+
+    QString remotename = meta[QStringLiteral("external_id")].toString() + QStringLiteral(".fit.gz");
+    QHttpPart filePart;
+    filePart.setHeader(QNetworkRequest::ContentTypeHeader, QVariant(QStringLiteral("application/octet-stream")));
+    filePart.setHeader(QNetworkRequest::ContentDispositionHeader,
+                       QVariant(QStringLiteral("form-data; name=\"file\"; filename=\"") + remotename +
+                                QStringLiteral("\"; type=\"application/octet-stream\"")));
+    filePart.setBody(payload.readAll());
+    multiPart->append(filePart);
+
+    // the token goes in the header, as in the documentation of the API, and in the form like before
+    QNetworkRequest request(m_uploadUrl);
+    request.setRawHeader(QByteArrayLiteral("Authorization"),
+                         QByteArrayLiteral("Bearer ") +
+                             settings.value(QStringLiteral("strava_accesstoken")).toString().toLatin1());
+    QNetworkReply *reply = manager->post(request, multiPart);
+    multiPart->setParent(reply);
+    connect(reply, &QNetworkReply::finished, this, &stravauploadqueue::uploadFinished);
+}
+
+void stravauploadqueue::uploadFinished() {
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    reply->deleteLater();
+
+    int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    QByteArray response = reply->readAll();
+    qDebug() << QStringLiteral("stravauploadqueue: upload reply") << statusCode << response;
+
+    if (reply->error() == QNetworkReply::NoError && statusCode >= 200 && statusCode < 300) {
+        QFile metaFile(m_currentJob + QStringLiteral(".json"));
+        QString externalId;
+        if (metaFile.open(QIODevice::ReadOnly)) {
+            QJsonObject meta = QJsonDocument::fromJson(metaFile.readAll()).object();
+            externalId = meta[QStringLiteral("external_id")].toString();
+            metaFile.close();
+        }
+        QFile::remove(m_currentJob + QStringLiteral(".fit.gz"));
+        QFile::remove(m_currentJob + QStringLiteral(".json"));
+        emit uploaded(externalId);
+        m_busy = false;
+        m_currentJob.clear();
+        scheduleNext();
+        return;
+    }
+
+    if (statusCode == 401) {
+        // the token has been revoked or it's expired earlier than expected
+        QSettings settings;
+        settings.setValue(QStringLiteral("strava_expires"), 0);
+        jobFailed(m_currentJob, QStringLiteral("unauthorized"), true);
+    } else if (statusCode >= 400 && statusCode < 500 && statusCode != 429) {
+        // duplicated or malformed activity, retrying won't change anything
+        jobFailed(m_currentJob, QString::fromUtf8(response), false);
+    } else {
+        jobFailed(m_currentJob, reply->errorString(), true);
+    }
+}
+
+void stravauploadqueue::jobFailed(const QString &job, const QString &error, bool retry) {
+    QFile metaFile(job + QStringLiteral(".json"));
+    QJsonObject meta;
+    if (metaFile.open(QIODevice::ReadOnly)) {
+        meta = QJsonDocument::fromJson(metaFile.readAll()).object();
+        metaFile.close();
+    }
+    int attempts = meta[QStringLiteral("attempts")].toInt() + 1;
+    QString externalId = meta[QStringLiteral("external_id")].toString();
+    qDebug() << QStringLiteral("stravauploadqueue: upload failed") << job << attempts << error;
+
+    if (!retry) {
+        QFile::remove(job + QStringLiteral(".fit.gz"));
+        QFile::remove(job + QStringLiteral(".json"));
+    } else {
+        int delay = retryBaseSeconds << qMin(attempts - 1, 16);
+        if (delay > retryMaxSeconds || delay <= 0) {
+            delay = retryMaxSeconds;
+        }
+        meta[QStringLiteral("attempts")] = attempts;
+        meta[QStringLiteral("next_attempt")] = (double)(QDateTime::currentMSecsSinceEpoch() + (qint64)delay * 1000);
+        if (metaFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            metaFile.write(QJsonDocument(meta).toJson(QJsonDocument::Compact));
+            metaFile.close();
+        }
+    }
+
+    emit uploadFailed(externalId, attempts, error);
+    m_busy = false;
+    m_currentJob.clear();
+    scheduleNext();
+}
+
+void stravauploadqueue::scheduleNext() {
+    QMetaObject::invokeMethod(this, &stravauploadqueue::processQueue, Qt::QueuedConnection);
+}
+
+QByteArray stravauploadqueue::gzip(const QByteArray &data) {
+    static const QVector<quint32> crcTable = []() {
+        QVector<quint32> t(256);
+        for (quint32 i = 0; i < 256; i++) {
+            quint32 c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+
+    quint32 crc = 0xFFFFFFFFu;
+    for (int i = 0; i < data.size(); i++) {
+        crc = crcTable[(crc ^ (quint8)data.at(i)) & 0xFF] ^ (crc >> 8);
+    }
+    crc ^= 0xFFFFFFFFu;
+
+    // qCompress returns a 4 bytes size, the 2 bytes zlib header, the deflate stream and the adler32:
+    // the gzip container needs just the deflate stream
+    QByteArray zlib = qCompress(data, 9);
+    QByteArray out;
+    out.reserve(zlib.size() + 18);
+    const char header[10] = {'\x1f', '\x8b', '\x08', 0, 0, 0, 0, 0, 0, '\xff'};
+    out.append(header, sizeof(header));
+    out.append(zlib.constData() + 6, zlib.size() - 10);
+    for (int i = 0; i < 4; i++) {
+        out.append((char)((crc >> (8 * i)) & 0xFF));
+    }
+    quint32 size = (quint32)data.size();
+    for (int i = 0; i < 4; i++) {
+        out.append((char)((size >> (8 * i)) & 0xFF));
+    }
+    return out;
+}
@@ -0,0 +1,66 @@
+#ifndef STRAVAUPLOADQUEUE_H
+#define STRAVAUPLOADQUEUE_H
+
+#include <QByteArray>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QUrl>
+
+// Persistent queue of the Strava uploads.
+// Every workout is stored as a gzipped FIT file plus a small json with its metadata in the queue folder, and
+// it's removed only when Strava accepts it. Failed uploads are retried with an exponential backoff, also after
+// a restart of the app. The object is meant to live on its own thread: enqueue() can be called from any thread.
+class stravauploadqueue : public QObject {
+    Q_OBJECT
+  public:
+    explicit stravauploadqueue(const QString &path,
+                               const QUrl &uploadUrl = QUrl(QStringLiteral("https://www.strava.com/api/v3/uploads")),
+                               const QUrl &tokenUrl = QUrl(QStringLiteral("https://www.strava.com/oauth/token")));
+    void setClientCredentials(const QString &clientId, const QString &clientSecret);
+    void enqueue(const QByteArray &fit, const QString &externalId, const QString &activityName,
+                 const QString &description, const QString &activityType);
+
+    static QByteArray gzip(const QByteArray &data);
+
+  public slots:
+    void start();
+
+  signals:
+    void uploaded(const QString &externalId);
+    void uploadFailed(const QString &externalId, int attempts, const QString &error);
+
+  private slots:
+    void processQueue();
+    void uploadFinished();
+    void tokenRefreshFinished();
+
+  private:
+    QString m_path;
+    QUrl m_uploadUrl;
+    QUrl m_tokenUrl;
+    QString m_clientId;
+    QString m_clientSecret;
+
+    QNetworkAccessManager *manager = nullptr;
+    QTimer *retryTimer = nullptr;
+    QString m_currentJob;
+    bool m_busy = false;
+
+    QString nextJob(qint64 *waitMs);
+    void upload(const QString &job);
+    void refreshToken();
+    bool tokenExpired();
+    void jobFailed(const QString &job, const QString &error, bool retry);
+    void scheduleNext();
+
+    void enqueueInner(const QByteArray &fit, const QString &externalId, const QString &activityName,
+                      const QString &description, const QString &activityType);
+
+    static const int retryBaseSeconds = 30;
+    static const int retryMaxSeconds = 3600;
+};
+
+#endif // STRAVAUPLOADQUEUE_H
@@ -0,0 +1,183 @@
+#include "studiogateway.h"
+#include "appdir.h"
+#include "qdebugfixup.h"
+#include <QJsonDocument>
+#include <QMutexLocker>
+#include <QSettings>
+#include <algorithm>
+
+studiorider::studiorider(const QString &name, int slot, const QString &folder)
+    : m_name(name), m_slot(slot), m_folder(folder) {
+    m_status[QStringLiteral("name")] = name;
+    m_status[QStringLiteral("connected")] = false;
+}
+
+void studiorider::deviceDiscovered(const QBluetoothDeviceInfo &device) {
+    if (!bt) {
+        QSettings settings;
+        bt = new bluetooth(false, m_name, false, true, 200, true, false,
+                           settings.value(QStringLiteral("bike_resistance_offset"), 4).toInt(),
+                           settings.value(QStringLiteral("bike_resistance_gain_f"), 1.0).toDouble(), m_slot);
+        recorder = new sessionrecorder(bt, m_folder, m_name + QStringLiteral(" "), this);
+        timer = new QTimer(this);
+        connect(timer, &QTimer::timeout, this, &studiorider::sample);
+        timer->start(1000);
+    }
+    qDebug() << QStringLiteral("studiorider") << m_slot << m_name << device.address();
+    bt->gatewayDeviceDiscovered(device);
+}
+
+void studiorider::sample() {
+    bluetoothdevice *dev = bt->device();
+    bool connected = dev && dev->connected();
+
+    QJsonObject s;
+    s[QStringLiteral("name")] = m_name;
+    s[QStringLiteral("connected")] = connected;
+    if (dev) {
+        const QTime e = dev->elapsedTime();
+        const uint32_t elapsed = e.second() + (e.minute() * 60) + (e.hour() * 3600);
+        s[QStringLiteral("elapsed")] = int(elapsed);
+        s[QStringLiteral("watt")] = dev->wattsMetric().value();
+        s[QStringLiteral("avg_watt")] = dev->wattsMetric().average();
+        s[QStringLiteral("kj")] = dev->jouls().value() / 1000.0;
+        s[QStringLiteral("calories")] = dev->calories().value();
+        s[QStringLiteral("distance")] = dev->odometer();
+        s[QStringLiteral("speed")] = dev->currentSpeed().value();
+        s[QStringLiteral("cadence")] = dev->currentCadence().value();
+        s[QStringLiteral("heart")] = dev->currentHeart().value();
+    }
+
+    QMutexLocker locker(&statusMutex);
+    m_status = s;
+}
+
+QJsonObject studiorider::status() {
+    QMutexLocker locker(&statusMutex);
+    return m_status;
+}
+
+void studiorider::stop() {
+    if (timer) {
+        timer->stop();
+    }
+    // the recorder saves the session, it must go before its bluetooth manager
+    delete recorder;
+    recorder = nullptr;
+    delete bt;
+    bt = nullptr;
+}
+
+studiogateway::studiogateway(const QStringList &machines, quint16 leaderboardPort, QObject *parent)
+    : QObject(parent) {
+    qRegisterMetaType<QBluetoothDeviceInfo>();
+    const int threadCount = qMax(1, qMin(machines.count(), QThread::idealThreadCount()));
+    for (int i = 0; i < threadCount; i++) {
+        QThread *t = new QThread(this);
+        t->setObjectName(QStringLiteral("studiogateway%1").arg(i));
+        t->start();
+        threads.append(t);
+    }
+
+    const QString folder = appdir::getWritableAppDir() + QStringLiteral("studio/");
+    for (int i = 0; i < machines.count(); i++) {
+        studiorider *r = new studiorider(machines.at(i).trimmed(), i, folder);
+        QThread *t = threads.at(i % threadCount);
+        r->moveToThread(t);
+        connect(t, &QThread::finished, r, &QObject::deleteLater);
+        riders.append(r);
+        assigned.append(false);
+    }
+    qDebug() << QStringLiteral("studiogateway") << riders.count() << QStringLiteral("machines on") << threadCount
+             << QStringLiteral("threads");
+
+    leaderboardServer = new QWebSocketServer(QStringLiteral("QZ studio leaderboard"),
+                                             QWebSocketServer::NonSecureMode, this);
+    if (leaderboardServer->listen(QHostAddress::Any, leaderboardPort)) {
+        connect(leaderboardServer, &QWebSocketServer::newConnection, this, &studiogateway::newLeaderboardClient);
+    } else {
+        qDebug() << QStringLiteral("studiogateway: leaderboard port unavailable") << leaderboardPort;
+    }
+    connect(&leaderboardTimer, &QTimer::timeout, this, &studiogateway::publishLeaderboard);
+    leaderboardTimer.start(1000);
+
+    discoveryAgent = new QBluetoothDeviceDiscoveryAgent(this);
+    discoveryAgent->setLowEnergyDiscoveryTimeout(10000);
+    connect(discoveryAgent, &QBluetoothDeviceDiscoveryAgent::deviceDiscovered, this,
+            &studiogateway::deviceDiscovered);
+    connect(discoveryAgent, &QBluetoothDeviceDiscoveryAgent::finished, this, &studiogateway::discoveryFinished);
+    discoveryAgent->start(QBluetoothDeviceDiscoveryAgent::LowEnergyMethod);
+}
+
+studiogateway::~studiogateway() {
+    discoveryAgent->stop();
+    // every rider saves its session on its own thread before leaving
+    for (studiorider *r : qAsConst(riders)) {
+        QMetaObject::invokeMethod(r, "stop", Qt::BlockingQueuedConnection);
+    }
+    for (QThread *t : qAsConst(threads)) {
+        t->quit();
+        t->wait();
+    }
+}
+
+void studiogateway::deviceDiscovered(const QBluetoothDeviceInfo &device) {
+    for (int i = 0; i < riders.count(); i++) {
+        if (!assigned.at(i) && !device.name().compare(riders.at(i)->name(), Qt::CaseInsensitive)) {
+            assigned[i] = true;
+            QMetaObject::invokeMethod(riders.at(i), "deviceDiscovered", Qt::QueuedConnection,
+                                      Q_ARG(QBluetoothDeviceInfo, device));
+            break;
+        }
+    }
+    if (!assigned.contains(false)) {
+        discoveryAgent->stop();
+    }
+}
+
+void studiogateway::discoveryFinished() {
+    // keep looking for the machines that are still off
+    if (assigned.contains(false)) {
+        discoveryAgent->start(QBluetoothDeviceDiscoveryAgent::LowEnergyMethod);
+    }
+}
+
+QJsonArray studiogateway::leaderboard() {
+    QList<QJsonObject> list;
+    list.reserve(riders.count());
+    for (studiorider *r : qAsConst(riders)) {
+        list.append(r->status());
+    }
+    std::sort(list.begin(), list.end(), [](const QJsonObject &a, const QJsonObject &b) {
+        return a.value(QStringLiteral("kj")).toDouble() > b.value(QStringLiteral("kj")).toDouble();
+    });
+    QJsonArray out;
+    for (const QJsonObject &o : qAsConst(list)) {
+        out.append(o);
+    }
+    return out;
+}
+
+void studiogateway::newLeaderboardClient() {
+    while (leaderboardServer->hasPendingConnections()) {
+        QWebSocket *client = leaderboardServer->nextPendingConnection();
+        connect(client, &QWebSocket::disconnected, this, [this, client]() {
+            leaderboardClients.removeAll(client);
+            client->deleteLater();
+        });
+        leaderboardClients.append(client);
+    }
+}
+
+void studiogateway::publishLeaderboard() {
+    if (leaderboardClients.isEmpty()) {
+        return;
+    }
+    QJsonObject main;
+    main[QStringLiteral("msg")] = QStringLiteral("leaderboard");
+    main[QStringLiteral("content")] = leaderboard();
+    const QString text = QString::fromUtf8(QJsonDocument(main).toJson(QJsonDocument::Compact));
+    for (QWebSocket *client : qAsConst(leaderboardClients)) {
+        client->sendTextMessage(text);
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef STUDIOGATEWAY_H
+#define STUDIOGATEWAY_H
+
+#include "bluetooth.h"
+#include "sessionrecorder.h"
+#include <QBluetoothDeviceDiscoveryAgent>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QStringList>
+#include <QThread>
+#include <QTimer>
+#include <QWebSocket>
+#include <QWebSocketServer>
+
+// A single machine of the studio gateway.
+// It lives on one of the gateway threads and owns a whole bluetooth manager filtered on its machine, so the driver,
+// the metrics, the dircon output and the template context are its own. It records its session and saves it as FIT
+// when the machine disconnects or the gateway stops.
+class studiorider : public QObject {
+    Q_OBJECT
+  public:
+    studiorider(const QString &name, int slot, const QString &folder);
+    QString name() const { return m_name; }
+    // last snapshot of the metrics for the leaderboard, it can be called from any thread
+    QJsonObject status();
+
+  public slots:
+    void deviceDiscovered(const QBluetoothDeviceInfo &device);
+    void stop();
+
+  private slots:
+    void sample();
+
+  private:
+    QString m_name;
+    int m_slot;
+    QString m_folder;
+    bluetooth *bt = nullptr;
+    sessionrecorder *recorder = nullptr;
+    QTimer *timer = nullptr;
+
+    QMutex statusMutex;
+    QJsonObject m_status;
+};
+
+// One process driving many machines, for the studios.
+// A single discovery agent feeds the riders, that are spread on a pool of threads sized on the cpu cores, so 20+
+// machines don't compete for the main event loop. The leaderboard is published every second as json to the web
+// socket clients, e.g. the Classifica page of the apps in the room.
+class studiogateway : public QObject {
+    Q_OBJECT
+  public:
+    studiogateway(const QStringList &machines, quint16 leaderboardPort, QObject *parent = nullptr);
+    ~studiogateway();
+
+    QJsonArray leaderboard();
+
+  private slots:
+    void deviceDiscovered(const QBluetoothDeviceInfo &device);
+    void discoveryFinished();
+    void newLeaderboardClient();
+    void publishLeaderboard();
+
+  private:
+    QList<QThread *> threads;
+    QList<studiorider *> riders;
+    QList<bool> assigned;
+    QBluetoothDeviceDiscoveryAgent *discoveryAgent = nullptr;
+    QWebSocketServer *leaderboardServer = nullptr;
+    QList<QWebSocket *> leaderboardClients;
+    QTimer leaderboardTimer;
+};
+
+#endif // STUDIOGATEWAY_H
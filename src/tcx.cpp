@@ -0,0 +1,150 @@
+#include "tcx.h"
+#include "qdebugfixup.h"
+#include <QXmlStreamWriter>
+
+tcx::tcx(QObject *parent) : QObject(parent) {}
+
+bool tcx::save(const QString &filename, const QList<SessionLine> &session, bluetoothdevice::BLUETOOTH_TYPE type) {
+    if (session.isEmpty()) {
+        return false;
+    }
+
+    QFile output(filename);
+    if (!output.open(QIODevice::WriteOnly)) {
+        qDebug() << QStringLiteral("tcx::save error opening") << filename << output.errorString();
+        return false;
+    }
+    QXmlStreamWriter stream(&output);
+    stream.setAutoFormatting(true);
+    stream.writeStartDocument();
+
+    const QString timeFormat = QStringLiteral("yyyy-MM-ddTHH:mm:ssZ");
+    // the trackpoints can be closer than 1 s when the session is at the rate of the device
+    const QString pointTimeFormat = QStringLiteral("yyyy-MM-ddTHH:mm:ss.zzzZ");
+    const double startingDistance = session.constFirst().distance;
+
+    stream.writeStartElement(QStringLiteral("TrainingCenterDatabase"));
+    stream.writeAttribute(QStringLiteral("xmlns"),
+                          QStringLiteral("http://www.garmin.com/xmlschemas/TrainingCenterDatabase/v2"));
+    stream.writeAttribute(QStringLiteral("xmlns:ns3"),
+                          QStringLiteral("http://www.garmin.com/xmlschemas/ActivityExtension/v2"));
+    stream.writeAttribute(QStringLiteral("xmlns:xsi"), QStringLiteral("http://www.w3.org/2001/XMLSchema-instance"));
+    stream.writeAttribute(QStringLiteral("xsi:schemaLocation"),
+                          QStringLiteral("http://www.garmin.com/xmlschemas/TrainingCenterDatabase/v2 "
+                                         "http://www.garmin.com/xmlschemas/TrainingCenterDatabasev2.xsd"));
+
+    stream.writeStartElement(QStringLiteral("Activities"));
+    stream.writeStartElement(QStringLiteral("Activity"));
+    if (type == bluetoothdevice::TREADMILL || type == bluetoothdevice::ELLIPTICAL) {
+        stream.writeAttribute(QStringLiteral("Sport"), QStringLiteral("Running"));
+    } else if (type == bluetoothdevice::BIKE) {
+        stream.writeAttribute(QStringLiteral("Sport"), QStringLiteral("Biking"));
+    } else {
+        stream.writeAttribute(QStringLiteral("Sport"), QStringLiteral("Other"));
+    }
+    stream.writeTextElement(QStringLiteral("Id"), session.constFirst().time.toUTC().toString(timeFormat));
+
+    // the lap totals must be written before the trackpoints, so every lap looks ahead to its last line.
+    // Each line is visited twice at most, and the points are streamed straight to the file.
+    int lapStart = 0;
+    while (lapStart < session.length()) {
+        int lapEnd = lapStart;
+        while (lapEnd < session.length() - 1 && !session.at(lapEnd).lapTrigger) {
+            lapEnd++;
+        }
+
+        const SessionLine &first = session.at(lapStart);
+        const SessionLine &last = session.at(lapEnd);
+        double maxSpeed = 0;
+        double totHeart = 0;
+        uint8_t maxHeart = 0;
+        double totCadence = 0;
+        for (int i = lapStart; i <= lapEnd; i++) {
+            const SessionLine &s = session.at(i);
+            if (s.speed > maxSpeed)
+                maxSpeed = s.speed;
+            if (s.heart > maxHeart)
+                maxHeart = s.heart;
+            totHeart += s.heart;
+            totCadence += s.cadence;
+        }
+        const int lapLines = lapEnd - lapStart + 1;
+
+        stream.writeStartElement(QStringLiteral("Lap"));
+        stream.writeAttribute(QStringLiteral("StartTime"), first.time.toUTC().toString(timeFormat));
+        stream.writeTextElement(QStringLiteral("TotalTimeSeconds"),
+                                QString::number(first.time.secsTo(last.time) + 1));
+        stream.writeTextElement(QStringLiteral("DistanceMeters"),
+                                QString::number((last.distance - first.distance) * 1000.0, 'f', 1));
+        stream.writeTextElement(QStringLiteral("MaximumSpeed"), QString::number(maxSpeed / 3.6, 'f', 2));
+        stream.writeTextElement(QStringLiteral("Calories"),
+                                QString::number(qMax(0, qRound(last.calories - first.calories))));
+        if (maxHeart > 0) {
+            stream.writeStartElement(QStringLiteral("AverageHeartRateBpm"));
+            stream.writeTextElement(QStringLiteral("Value"), QString::number(qRound(totHeart / lapLines)));
+            stream.writeEndElement();
+            stream.writeStartElement(QStringLiteral("MaximumHeartRateBpm"));
+            stream.writeTextElement(QStringLiteral("Value"), QString::number(maxHeart));
+            stream.writeEndElement();
+        }
+        stream.writeTextElement(QStringLiteral("Intensity"), QStringLiteral("Active"));
+        if (type == bluetoothdevice::BIKE) {
+            stream.writeTextElement(QStringLiteral("Cadence"), QString::number(qRound(totCadence / lapLines)));
+        }
+        stream.writeTextElement(QStringLiteral("TriggerMethod"), QStringLiteral("Manual"));
+
+        stream.writeStartElement(QStringLiteral("Track"));
+        for (int i = lapStart; i <= lapEnd; i++) {
+            const SessionLine &s = session.at(i);
+            stream.writeStartElement(QStringLiteral("Trackpoint"));
+            stream.writeTextElement(QStringLiteral("Time"), s.time.toUTC().toString(pointTimeFormat));
+            if (s.coordinate.isValid()) {
+                stream.writeStartElement(QStringLiteral("Position"));
+                stream.writeTextElement(QStringLiteral("LatitudeDegrees"),
+                                        QString::number(s.coordinate.latitude(), 'f', 7));
+                stream.writeTextElement(QStringLiteral("LongitudeDegrees"),
+                                        QString::number(s.coordinate.longitude(), 'f', 7));
+                stream.writeEndElement(); // Position
+            }
+            // the elevation gain is a total, not an altitude: only a real coordinate has one
+            if (s.coordinate.isValid() && !qIsNaN(s.coordinate.altitude())) {
+                stream.writeTextElement(QStringLiteral("AltitudeMeters"),
+                                        QString::number(s.coordinate.altitude(), 'f', 1));
+            }
+            stream.writeTextElement(QStringLiteral("DistanceMeters"),
+                                    QString::number((s.distance - startingDistance) * 1000.0, 'f', 1));
+            if (s.heart > 0) {
+                stream.writeStartElement(QStringLiteral("HeartRateBpm"));
+                stream.writeTextElement(QStringLiteral("Value"), QString::number(s.heart));
+                stream.writeEndElement(); // HeartRateBpm
+            }
+            if (type == bluetoothdevice::BIKE) {
+                stream.writeTextElement(QStringLiteral("Cadence"), QString::number(s.cadence));
+            }
+            stream.writeStartElement(QStringLiteral("Extensions"));
+            stream.writeStartElement(QStringLiteral("ns3:TPX"));
+            stream.writeTextElement(QStringLiteral("ns3:Speed"), QString::number(s.speed / 3.6, 'f', 2));
+            stream.writeTextElement(QStringLiteral("ns3:Watts"), QString::number(s.watt));
+            if (type != bluetoothdevice::BIKE) {
+                stream.writeTextElement(QStringLiteral("ns3:RunCadence"), QString::number(s.cadence));
+            }
+            stream.writeEndElement(); // ns3:TPX
+            stream.writeEndElement(); // Extensions
+            stream.writeEndElement(); // Trackpoint
+        }
+        stream.writeEndElement(); // Track
+        stream.writeEndElement(); // Lap
+
+        lapStart = lapEnd + 1;
+    }
+
+    stream.writeEndElement(); // Activity
+    stream.writeEndElement(); // Activities
+    stream.writeEndElement(); // TrainingCenterDatabase
+    stream.writeEndDocument();
+    if (stream.hasError()) {
+        qDebug() << QStringLiteral("tcx::save error writing") << filename << output.errorString();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,19 @@
+#ifndef TCX_H
+#define TCX_H
+
+#include "bluetoothdevice.h"
+#include "sessionline.h"
+#include <QFile>
+#include <QObject>
+
+class tcx : public QObject {
+    Q_OBJECT
+  public:
+    explicit tcx(QObject *parent = nullptr);
+    // false if the file couldn't be written
+    static bool save(const QString &filename, const QList<SessionLine> &session, bluetoothdevice::BLUETOOTH_TYPE type);
+
+  signals:
+};
+
+#endif // TCX_H
@@ -0,0 +1,41 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <QMutex>
+#include <QtGlobal>
+
+// Last live values of a device, published by bluetoothdevice on its own thread and readable from any thread.
+// The consumers that run elsewhere, like the Dircon servers on the I/O thread, read a copy of these values instead
+// of calling the driver.
+class telemetry {
+  public:
+    struct snapshot {
+        int deviceType = 0; // bluetoothdevice::BLUETOOTH_TYPE
+        double speed = 0;
+        double cadence = 0;
+        double watts = 0;
+        double heart = 0;
+        uint8_t heartOverride = 0; // metrics_override_heartrate()
+        double resistance = 0;
+        double inclination = 0;
+        double odometer = 0;
+        double crankRevolutions = 0;
+        uint16_t lastCrankEventTime = 0;
+        qint64 timestamp = 0; // steadyclock
+    };
+
+    void publish(const snapshot &s) {
+        QMutexLocker locker(&mutex);
+        m_last = s;
+    }
+    snapshot last() const {
+        QMutexLocker locker(&mutex);
+        return m_last;
+    }
+
+  private:
+    mutable QMutex mutex;
+    snapshot m_last;
+};
+
+#endif // TELEMETRY_H
@@ -26,7 +26,7 @@ bool TemplateInfoSender::update(QJSEngine *eng) {
         if (!jsv.isError()) {
             QString evalres = jsv.toString();
             qDebug() << QStringLiteral("eval res ") << evalres;
-            return send(evalres);
+            return sendWorkout(evalres);
         } else {
 #if (QT_VERSION < QT_VERSION_CHECK(5, 12, 0))
             int errorType = 255;
@@ -41,6 +41,13 @@ bool TemplateInfoSender::update(QJSEngine *eng) {
     }
 }
 
+bool TemplateInfoSender::update(const QJsonObject &workout) {
+    Q_UNUSED(workout);
+    return false;
+}
+
+void TemplateInfoSender::publish(const QJsonObject &workout) { Q_UNUSED(workout); }
+
 QString TemplateInfoSender::js() const { return jscript; }
 
 QString TemplateInfoSender::getId() const { return templateId; }
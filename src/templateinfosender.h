@@ -1,6 +1,7 @@
 #ifndef TEMPLATEINFOSENDER_H
 #define TEMPLATEINFOSENDER_H
 #include <QJSEngine>
+#include <QJsonObject>
 #include <QObject>
 #include <QSettings>
 #include <QTimer>
@@ -15,6 +16,12 @@ class TemplateInfoSender : public QObject {
     bool init(const QString &script);
     void stop();
     bool update(QJSEngine *eng);
+    // the native senders don't run the script: they get the workout snapshot instead
+    virtual bool needsScript() const { return true; }
+    virtual bool update(const QJsonObject &workout);
+    // live subscriptions of the clients, fed with the snapshot many times per second
+    virtual bool hasSubscribers() const { return false; }
+    virtual void publish(const QJsonObject &workout);
     QString js() const;
     QString getId() const;
   signals:
@@ -22,6 +29,8 @@ class TemplateInfoSender : public QObject {
 
   protected:
     virtual bool init() = 0;
+    // the workout made by the script; the senders with subscriptions can leave out the subscribed clients
+    virtual bool sendWorkout(const QString &data) { return send(data); }
     virtual void innerStop();
     QString templateId;
     QSettings settings;
@@ -1,18 +1,26 @@
 #include "templateinfosenderbuilder.h"
+#include "activitystore.h"
 #include "bike.h"
+#include "m3ibroadcastlistener.h"
+#include "rower.h"
 #include "treadmill.h"
+#include <QDateTime>
 #include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QNetworkInterface>
 #include <QStandardPaths>
+#include <QTextStream>
 #include <QTime>
 #ifdef Q_HTTPSERVER
 #include "webserverinfosender.h"
 #endif
-#include "homeform.h"
+#include "appdir.h"
 #include "tcpclientinfosender.h"
+#include "timeseriesinfosender.h"
 #include "trainprogram.h"
 #include <chrono>
 
@@ -20,28 +28,60 @@ using namespace std::chrono_literals;
 
 QHash<QString, TemplateInfoSenderBuilder *> TemplateInfoSenderBuilder::instanceMap;
 TemplateInfoSenderBuilder::TemplateInfoSenderBuilder(QObject *parent) : QObject(parent) {
-    engine = new QJSEngine(this);
-    engine->installExtensions(QJSEngine::AllExtensions);
     connect(&updateTimer, &QTimer::timeout, this, &TemplateInfoSenderBuilder::onUpdateTimeout);
     updateTimer.setSingleShot(false);
+    connect(&liveTimer, &QTimer::timeout, this, &TemplateInfoSenderBuilder::onLiveTimeout);
+    liveTimer.setInterval(100ms);
+    connect(&m3iTimer, &QTimer::timeout, this, &TemplateInfoSenderBuilder::onM3iTimeout);
+    m3iTimer.setInterval(1s);
 }
 
 TemplateInfoSenderBuilder::~TemplateInfoSenderBuilder() { stop(); }
 
+QJSEngine *TemplateInfoSenderBuilder::scriptEngine() {
+    if (!engine) {
+        engine = new QJSEngine(this);
+        engine->installExtensions(QJSEngine::AllExtensions);
+    }
+    return engine;
+}
+
 void TemplateInfoSenderBuilder::onUpdateTimeout() {
-    buildContext();
     QHash<QString, TemplateInfoSender *>::Iterator it;
+    bool script = false;
+    for (it = templateInfoMap.begin(); it != templateInfoMap.end(); it++) {
+        script = script || it.value()->needsScript();
+    }
+    buildContext(false, script);
     bool rv;
     for (it = templateInfoMap.begin(); it != templateInfoMap.end(); it++) {
-        rv = it.value()->update(engine);
+        rv = it.value()->needsScript() ? it.value()->update(scriptEngine()) : it.value()->update(snapshot);
         if (!rv) {
             qDebug() << QStringLiteral("Error updating") << it.key() << QStringLiteral("template");
         }
     }
 }
 
+void TemplateInfoSenderBuilder::onLiveTimeout() {
+    bool subscribers = false;
+    for (auto it = templateInfoMap.constBegin(); it != templateInfoMap.constEnd() && !subscribers; ++it) {
+        subscribers = it.value()->hasSubscribers();
+    }
+    if (!subscribers) {
+        return;
+    }
+    // only the native snapshot: no script and no session array at this rate
+    buildContext(false, false, false);
+    for (auto it = templateInfoMap.constBegin(); it != templateInfoMap.constEnd(); ++it) {
+        it.value()->publish(snapshot);
+    }
+}
+
 void TemplateInfoSenderBuilder::stop() {
     updateTimer.stop();
+    liveTimer.stop();
+    m3iTimer.stop();
+    m3iSenders.clear();
     QHash<QString, TemplateInfoSender *>::Iterator it;
     for (it = templateInfoMap.begin(); it != templateInfoMap.end(); it++) {
         it.value()->stop();
@@ -60,7 +100,9 @@ TemplateInfoSenderBuilder *TemplateInfoSenderBuilder::getInstance(const QString
     }
 }
 
-bool TemplateInfoSenderBuilder::validFileTemplateType(const QString &tp) const { return tp == TEMPLATE_TYPE_TCPCLIENT; }
+bool TemplateInfoSenderBuilder::validFileTemplateType(const QString &tp) const {
+    return tp == TEMPLATE_TYPE_TCPCLIENT || tp == TEMPLATE_TYPE_TIMESERIES;
+}
 
 void TemplateInfoSenderBuilder::createTemplatesFromFolder(const QString &idInfo, const QString &folder,
                                                           QStringList &dirTemplates) {
@@ -175,6 +217,8 @@ TemplateInfoSender *TemplateInfoSenderBuilder::newTemplate(const QString &id, co
 #endif
         if (tp == TEMPLATE_TYPE_TCPCLIENT) {
         tempInfo = new TcpClientInfoSender(id, this);
+    } else if (tp == TEMPLATE_TYPE_TIMESERIES) {
+        tempInfo = new TimeSeriesInfoSender(id, this);
     }
     if (tempInfo) {
         TemplateInfoSender *old;
@@ -206,6 +250,7 @@ void TemplateInfoSenderBuilder::start(bluetoothdevice *dev) {
     device = dev;
     activityDescription = QLatin1String("");
     updateTimer.start(1s);
+    liveTimer.start();
 }
 
 QStringList TemplateInfoSenderBuilder::templateIdList() const { return templateFilesList.keys(); }
@@ -407,7 +452,7 @@ void TemplateInfoSenderBuilder::onLoadTrainingPrograms(const QJsonValue &msgCont
     QJsonObject outObj;
     QString fileXml;
     if ((fileXml = msgContent.toString()).isEmpty()) {
-        QDirIterator it(homeform::getWritableAppDir() + QStringLiteral("training"));
+        QDirIterator it(appdir::getWritableAppDir() + QStringLiteral("training"));
         QString fileName, filePath;
         QFileInfo fileInfo;
         while (it.hasNext()) {
@@ -419,12 +464,16 @@ void TemplateInfoSenderBuilder::onLoadTrainingPrograms(const QJsonValue &msgCont
             }
         }
     } else {
-        QList<trainrow> lst = trainprogram::loadXML(homeform::getWritableAppDir() + QStringLiteral("training/") +
+        // a ramp is a single row: the editor shows its start, the end goes back as it is with the save
+        QList<trainrow> lst = trainprogram::loadXML(appdir::getWritableAppDir() + QStringLiteral("training/") +
                                                     fileXml + QStringLiteral(".xml"));
         for (auto &row : lst) {
             QJsonObject item;
             item[QStringLiteral("duration")] = row.duration.toString();
             item[QStringLiteral("speed")] = row.speed;
+            item[QStringLiteral("speed_end")] = row.speed_end;
+            item[QStringLiteral("power")] = row.power;
+            item[QStringLiteral("power_end")] = row.power_end;
             item[QStringLiteral("fanspeed")] = row.fanspeed;
             item[QStringLiteral("inclination")] = row.inclination;
             item[QStringLiteral("resistance")] = row.resistance;
@@ -476,6 +525,68 @@ void TemplateInfoSenderBuilder::onGetSessionArray(TemplateInfoSender *tempSender
     tempSender->send(out.toJson());
 }
 
+void TemplateInfoSenderBuilder::onGetHistory(const QJsonValue &msgContent, TemplateInfoSender *tempSender) {
+    QJsonObject content = msgContent.toObject();
+    QString query = content.value(QStringLiteral("query")).toString();
+    QDateTime from = QDateTime::fromSecsSinceEpoch(content.value(QStringLiteral("from")).toVariant().toLongLong());
+    QDateTime to = content.contains(QStringLiteral("to"))
+                       ? QDateTime::fromSecsSinceEpoch(content.value(QStringLiteral("to")).toVariant().toLongLong())
+                       : QDateTime::currentDateTime();
+    activitystore *store = activitystore::instance();
+    QJsonObject outObj;
+    outObj[QStringLiteral("query")] = query;
+    if (query == QStringLiteral("weekly")) {
+        outObj[QStringLiteral("list")] =
+            QJsonArray::fromVariantList(store->weeklyTotals(content.value(QStringLiteral("weeks")).toInt(12)));
+    } else if (query == QStringLiteral("best")) {
+        int seconds = content.value(QStringLiteral("seconds")).toInt(1200);
+        outObj[QStringLiteral("seconds")] = seconds;
+        outObj[QStringLiteral("watt")] = store->bestPower(seconds, from, to);
+    } else if (query == QStringLiteral("records")) {
+        outObj[QStringLiteral("list")] = QJsonArray::fromVariantList(store->personalRecords());
+    } else if (query == QStringLiteral("series")) {
+        outObj[QStringLiteral("list")] = QJsonArray::fromVariantList(
+            store->series(content.value(QStringLiteral("id")).toVariant().toLongLong()));
+    } else {
+        outObj[QStringLiteral("list")] = QJsonArray::fromVariantList(store->sessions(from, to));
+    }
+    QJsonObject main;
+    main[QStringLiteral("content")] = outObj;
+    main[QStringLiteral("msg")] = QStringLiteral("R_gethistory");
+    QJsonDocument out(main);
+    tempSender->send(out.toJson());
+}
+
+void TemplateInfoSenderBuilder::onGetM3iBikes(TemplateInfoSender *tempSender) {
+    sendM3iBikes(tempSender);
+    m3iSenders.insert(tempSender);
+    if (!m3iTimer.isActive()) {
+        m3iTimer.start();
+    }
+}
+
+void TemplateInfoSenderBuilder::onM3iTimeout() {
+    // only the senders still loaded: the set is just a filter, its pointers are never followed
+    for (auto it = templateInfoMap.constBegin(); it != templateInfoMap.constEnd(); ++it) {
+        if (m3iSenders.contains(it.value())) {
+            sendM3iBikes(it.value());
+        }
+    }
+}
+
+void TemplateInfoSenderBuilder::sendM3iBikes(TemplateInfoSender *tempSender) {
+    // the bikes are only listened to: no connection is opened to answer this
+    QJsonObject outObj;
+    m3ibroadcastlistener *listener = m3ibroadcastlistener::instance();
+    outObj[QStringLiteral("listening")] = listener->isRunning();
+    outObj[QStringLiteral("list")] = listener->table(steadyclock::now());
+    QJsonObject main;
+    main[QStringLiteral("content")] = outObj;
+    main[QStringLiteral("msg")] = QStringLiteral("R_getm3ibikes");
+    QJsonDocument out(main);
+    tempSender->send(out.toJson());
+}
+
 void TemplateInfoSenderBuilder::onStart(TemplateInfoSender *tempSender) {
     if (!device->isPaused()) {
         device->clearStats();
@@ -534,6 +645,15 @@ void TemplateInfoSenderBuilder::onSaveTrainingProgram(const QJsonValue &msgConte
             if (row.contains(QStringLiteral("speed"))) {
                 tR.speed = row[QStringLiteral("speed")].toDouble();
             }
+            if (row.contains(QStringLiteral("speed_end"))) {
+                tR.speed_end = row[QStringLiteral("speed_end")].toDouble();
+            }
+            if (row.contains(QStringLiteral("power"))) {
+                tR.power = row[QStringLiteral("power")].toInt();
+            }
+            if (row.contains(QStringLiteral("power_end"))) {
+                tR.power_end = row[QStringLiteral("power_end")].toInt();
+            }
             if (row.contains(QStringLiteral("fanspeed"))) {
                 tR.fanspeed = row[QStringLiteral("fanspeed")].toInt();
             }
@@ -571,7 +691,7 @@ void TemplateInfoSenderBuilder::onSaveTrainingProgram(const QJsonValue &msgConte
         }
     }
     QJsonObject main, outObj;
-    QString trainingDir(homeform::getWritableAppDir() + QStringLiteral("training/"));
+    QString trainingDir(appdir::getWritableAppDir() + QStringLiteral("training/"));
     QDir dir(trainingDir);
     if (!dir.exists()) {
         dir.mkpath(QStringLiteral("."));
@@ -597,15 +717,18 @@ void TemplateInfoSenderBuilder::onSaveChart(const QJsonValue &msgContent, Templa
         (image = content.value(QStringLiteral("image")).toString()).isEmpty()) {
         return;
     }
-    QString path = homeform::getWritableAppDir();
+    QString path = appdir::getWritableAppDir();
     QJsonObject main, outObj;
     QString filenameScreenshot =
         path + QDateTime::currentDateTime().toString().replace(QStringLiteral(":"), QStringLiteral("_")) +
         QStringLiteral("_") + filename.replace(QStringLiteral(":"), QStringLiteral("_")) + QStringLiteral(".png");
 
-    QPixmap imagep;
-    imagep.loadFromData(QByteArray::fromBase64(image.toLocal8Bit().replace("data:image/png;base64,", "")));
-    imagep.save(filenameScreenshot);
+    // the chart is already a png: it's written as it is, no image decoding (and no gui) needed
+    QFile imageFile(filenameScreenshot);
+    if (imageFile.open(QIODevice::WriteOnly)) {
+        imageFile.write(QByteArray::fromBase64(image.toLocal8Bit().replace("data:image/png;base64,", "")));
+        imageFile.close();
+    }
 
     emit chartSaved(filenameScreenshot);
 
@@ -667,6 +790,12 @@ void TemplateInfoSenderBuilder::onDataReceived(const QByteArray &data) {
                 } else if (msg == QStringLiteral("getsessionarray")) {
                     onGetSessionArray(sender);
                     return;
+                } else if (msg == QStringLiteral("gethistory")) {
+                    onGetHistory(jsonObject[QStringLiteral("content")], sender);
+                    return;
+                } else if (msg == QStringLiteral("getm3ibikes")) {
+                    onGetM3iBikes(sender);
+                    return;
                 } 
                 if (msg == QStringLiteral("start")) {
                     onStart(sender);
@@ -686,53 +815,62 @@ void TemplateInfoSenderBuilder::onDataReceived(const QByteArray &data) {
     qDebug() << QStringLiteral("Unrecognized message") << data;
 }
 
-void TemplateInfoSenderBuilder::buildContext(bool forceReinit) {
-    QJSValue glob = engine->globalObject();
+void TemplateInfoSenderBuilder::buildContext(bool forceReinit, bool toScript, bool record) {
+    // the workout is collected natively first: the native senders use it as it is, and it's copied
+    // into the script engine only when a script template needs it
+    snapshot = QJsonObject();
     QJSValue obj;
-    if (!glob.hasOwnProperty(QStringLiteral("workout")) || forceReinit) {
-        obj = engine->newObject();
-        glob.setProperty(QStringLiteral("workout"), obj);
-    } else
-        obj = glob.property(QStringLiteral("workout"));
-
-    if (!glob.hasOwnProperty(QStringLiteral("settings")) || forceReinit) {
-        QJSValue sett = engine->newObject();
-        glob.setProperty(QStringLiteral("settings"), sett);
-        QVariant::Type typesett;
-        QVariant valsett;
-        int i = 0;
-        auto allKeys_list = settings.allKeys();
-        for (const auto &key : allKeys_list) {
-            valsett.setValue(settings.value(key));
-            typesett = valsett.type();
-            if (typesett == QVariant::Int) {
-                sett.setProperty(key, valsett.toInt());
-            } else if (typesett == QVariant::Double) {
-                sett.setProperty(key, valsett.toDouble());
-            } else if (typesett == QVariant::String) {
-                sett.setProperty(key, valsett.toString());
-            } else if (typesett == QVariant::Bool) {
-                sett.setProperty(key, valsett.toBool());
-            } else if (typesett == QVariant::UInt) {
-                sett.setProperty(key, valsett.toUInt());
-            } else if (typesett == QVariant::StringList) {
-                QStringList settL = valsett.toStringList();
-                QJSValue settLJ = engine->newArray(settL.size());
-                i = 0;
-                for (const auto &settLK : qAsConst(settL)) {
-                    settLJ.setProperty(i++, settLK);
+    if (toScript) {
+        forceReinit = forceReinit || scriptReinit;
+        scriptReinit = false;
+        QJSValue glob = scriptEngine()->globalObject();
+        if (!glob.hasOwnProperty(QStringLiteral("workout")) || forceReinit) {
+            obj = engine->newObject();
+            glob.setProperty(QStringLiteral("workout"), obj);
+        } else
+            obj = glob.property(QStringLiteral("workout"));
+
+        if (!glob.hasOwnProperty(QStringLiteral("settings")) || forceReinit) {
+            QJSValue sett = engine->newObject();
+            glob.setProperty(QStringLiteral("settings"), sett);
+            QVariant::Type typesett;
+            QVariant valsett;
+            int i = 0;
+            auto allKeys_list = settings.allKeys();
+            for (const auto &key : allKeys_list) {
+                valsett.setValue(settings.value(key));
+                typesett = valsett.type();
+                if (typesett == QVariant::Int) {
+                    sett.setProperty(key, valsett.toInt());
+                } else if (typesett == QVariant::Double) {
+                    sett.setProperty(key, valsett.toDouble());
+                } else if (typesett == QVariant::String) {
+                    sett.setProperty(key, valsett.toString());
+                } else if (typesett == QVariant::Bool) {
+                    sett.setProperty(key, valsett.toBool());
+                } else if (typesett == QVariant::UInt) {
+                    sett.setProperty(key, valsett.toUInt());
+                } else if (typesett == QVariant::StringList) {
+                    QStringList settL = valsett.toStringList();
+                    QJSValue settLJ = engine->newArray(settL.size());
+                    i = 0;
+                    for (const auto &settLK : qAsConst(settL)) {
+                        settLJ.setProperty(i++, settLK);
+                    }
+                    sett.setProperty(key, settLJ);
                 }
-                sett.setProperty(key, settLJ);
             }
+            obj.setProperty(QStringLiteral("BIKE_TYPE"), (int)bluetoothdevice::BIKE);
+            obj.setProperty(QStringLiteral("ELLIPTICAL_TYPE"), (int)bluetoothdevice::ELLIPTICAL);
+            obj.setProperty(QStringLiteral("ROWING_TYPE"), (int)bluetoothdevice::ROWING);
+            obj.setProperty(QStringLiteral("TREADMILL_TYPE"), (int)bluetoothdevice::TREADMILL);
+            obj.setProperty(QStringLiteral("UNKNOWN_TYPE"), (int)bluetoothdevice::UNKNOWN);
         }
-        obj.setProperty(QStringLiteral("BIKE_TYPE"), (int)bluetoothdevice::BIKE);
-        obj.setProperty(QStringLiteral("ELLIPTICAL_TYPE"), (int)bluetoothdevice::ELLIPTICAL);
-        obj.setProperty(QStringLiteral("ROWING_TYPE"), (int)bluetoothdevice::ROWING);
-        obj.setProperty(QStringLiteral("TREADMILL_TYPE"), (int)bluetoothdevice::TREADMILL);
-        obj.setProperty(QStringLiteral("UNKNOWN_TYPE"), (int)bluetoothdevice::UNKNOWN);
+    } else {
+        scriptReinit = scriptReinit || forceReinit;
     }
     if (!device) {
-        obj.setProperty(QStringLiteral("deviceId"), QJSValue());
+        snapshot[QStringLiteral("deviceId")] = QJsonValue();
     } else {
         QTime el = device->elapsedTime();
         QString name;
@@ -741,87 +879,97 @@ void TemplateInfoSenderBuilder::buildContext(bool forceReinit) {
 
         metric dep;
 #ifdef Q_OS_IOS
-        obj.setProperty("deviceId", device->bluetoothDevice.deviceUuid().toString());
+        snapshot[QStringLiteral("deviceId")] = device->bluetoothDevice.deviceUuid().toString();
 #else
-        obj.setProperty(QStringLiteral("deviceId"), device->bluetoothDevice.address().toString());
+        snapshot[QStringLiteral("deviceId")] = device->bluetoothDevice.address().toString();
 #endif
-        obj.setProperty(QStringLiteral("deviceName"),
-                        (name = device->bluetoothDevice.name()).isEmpty() ? QString(QStringLiteral("N/A")) : name);
-        obj.setProperty(QStringLiteral("deviceRSSI"), device->bluetoothDevice.rssi());
-        obj.setProperty(QStringLiteral("deviceType"), (int)device->deviceType());
-        obj.setProperty(QStringLiteral("deviceConnected"), (bool)device->connected());
-        obj.setProperty(QStringLiteral("devicePaused"), (bool)device->isPaused());
-        obj.setProperty(QStringLiteral("elapsed_s"), el.second());
-        obj.setProperty(QStringLiteral("elapsed_m"), el.minute());
-        obj.setProperty(QStringLiteral("elapsed_h"), el.hour());
+        snapshot[QStringLiteral("deviceName")] =
+            (name = device->bluetoothDevice.name()).isEmpty() ? QString(QStringLiteral("N/A")) : name;
+        snapshot[QStringLiteral("deviceRSSI")] = device->bluetoothDevice.rssi();
+        snapshot[QStringLiteral("deviceType")] = (int)device->deviceType();
+        snapshot[QStringLiteral("deviceConnected")] = (bool)device->connected();
+        snapshot[QStringLiteral("devicePaused")] = (bool)device->isPaused();
+        snapshot[QStringLiteral("linkStalls")] = device->linkWatchdog()->stalls();
+        snapshot[QStringLiteral("linkRecoveryMs")] = device->linkWatchdog()->lastRecoveryMs();
+        snapshot[QStringLiteral("elapsed_s")] = el.second();
+        snapshot[QStringLiteral("elapsed_m")] = el.minute();
+        snapshot[QStringLiteral("elapsed_h")] = el.hour();
         el = device->currentPace();
-        obj.setProperty(QStringLiteral("pace_s"), el.second());
-        obj.setProperty(QStringLiteral("pace_m"), el.minute());
-        obj.setProperty(QStringLiteral("pace_h"), el.hour());
+        snapshot[QStringLiteral("pace_s")] = el.second();
+        snapshot[QStringLiteral("pace_m")] = el.minute();
+        snapshot[QStringLiteral("pace_h")] = el.hour();
         el = device->movingTime();
-        obj.setProperty(QStringLiteral("moving_s"), el.second());
-        obj.setProperty(QStringLiteral("moving_m"), el.minute());
-        obj.setProperty(QStringLiteral("moving_h"), el.hour());
-        obj.setProperty(QStringLiteral("speed"), (dep = device->currentSpeed()).value());
-        obj.setProperty(QStringLiteral("speed_avg"), dep.average());
-        obj.setProperty(QStringLiteral("calories"), device->calories().value());
-        obj.setProperty(QStringLiteral("distance"), device->odometer());
-        obj.setProperty(QStringLiteral("heart"), (dep = device->currentHeart()).value());
-        obj.setProperty(QStringLiteral("heart_avg"), dep.average());
-        obj.setProperty(QStringLiteral("heart_max"), dep.max());
-        obj.setProperty(QStringLiteral("jouls"), device->jouls().value());
-        obj.setProperty(QStringLiteral("elevation"), device->elevationGain().value());
-        obj.setProperty(QStringLiteral("difficult"), device->difficult());
-        obj.setProperty(QStringLiteral("watts"), (dep = device->wattsMetric()).value());
-        obj.setProperty(QStringLiteral("watts_avg"), dep.average());
-        obj.setProperty(QStringLiteral("watts_max"), dep.max());
-        obj.setProperty(QStringLiteral("kgwatts"), (dep = device->wattKg()).value());
-        obj.setProperty(QStringLiteral("kgwatts_avg"), dep.average());
-        obj.setProperty(QStringLiteral("kgwatts_max"), dep.max());
-        obj.setProperty(QStringLiteral("workoutName"), workoutName);
-        obj.setProperty(QStringLiteral("workoutStartDate"), workoutStartDate);
-        obj.setProperty(QStringLiteral("instructorName"), instructorName);
-        obj.setProperty(QStringLiteral("latitude"), device->currentCordinate().latitude());
-        obj.setProperty(QStringLiteral("longitude"), device->currentCordinate().longitude());
-        obj.setProperty(
-            QStringLiteral("nickName"),
+        snapshot[QStringLiteral("moving_s")] = el.second();
+        snapshot[QStringLiteral("moving_m")] = el.minute();
+        snapshot[QStringLiteral("moving_h")] = el.hour();
+        snapshot[QStringLiteral("speed")] = (dep = device->currentSpeed()).value();
+        snapshot[QStringLiteral("speed_avg")] = dep.average();
+        snapshot[QStringLiteral("calories")] = device->calories().value();
+        snapshot[QStringLiteral("distance")] = device->odometer();
+        snapshot[QStringLiteral("heart")] = (dep = device->currentHeart()).value();
+        snapshot[QStringLiteral("heart_avg")] = dep.average();
+        snapshot[QStringLiteral("heart_max")] = dep.max();
+        snapshot[QStringLiteral("jouls")] = device->jouls().value();
+        snapshot[QStringLiteral("elevation")] = device->elevationGain().value();
+        snapshot[QStringLiteral("difficult")] = device->difficult();
+        snapshot[QStringLiteral("watts")] = (dep = device->wattsMetric()).value();
+        snapshot[QStringLiteral("watts_avg")] = dep.average();
+        snapshot[QStringLiteral("watts_max")] = dep.max();
+        snapshot[QStringLiteral("kgwatts")] = (dep = device->wattKg()).value();
+        snapshot[QStringLiteral("kgwatts_avg")] = dep.average();
+        snapshot[QStringLiteral("kgwatts_max")] = dep.max();
+        const trainingload &training = device->trainingLoad();
+        snapshot[QStringLiteral("np")] = training.normalizedPower();
+        snapshot[QStringLiteral("if")] = training.intensityFactor();
+        snapshot[QStringLiteral("tss")] = training.tss();
+        snapshot[QStringLiteral("trimp")] = training.trimp();
+        snapshot[QStringLiteral("wbal")] = training.wPrimeBalance();
+        snapshot[QStringLiteral("workoutName")] = workoutName;
+        snapshot[QStringLiteral("workoutStartDate")] = workoutStartDate;
+        snapshot[QStringLiteral("instructorName")] = instructorName;
+        snapshot[QStringLiteral("latitude")] = device->currentCordinate().latitude();
+        snapshot[QStringLiteral("longitude")] = device->currentCordinate().longitude();
+        snapshot[QStringLiteral("nickName")] =
             (nickName = settings.value(QStringLiteral("user_nickname"), QStringLiteral("")).toString()).isEmpty()
                 ? QString(QStringLiteral("N/A"))
-                : nickName);
+                : nickName;
         if (tp == bluetoothdevice::BIKE) {
-            obj.setProperty(QStringLiteral("peloton_resistance"),
-                            (dep = ((bike *)device)->pelotonResistance()).value());
-            obj.setProperty(QStringLiteral("peloton_req_resistance"),
-                            (dep = ((bike *)device)->lastRequestedPelotonResistance()).value());
-            obj.setProperty(QStringLiteral("peloton_resistance_avg"), dep.average());
-            obj.setProperty(QStringLiteral("cadence"), (dep = ((bike *)device)->currentCadence()).value());
-            obj.setProperty(QStringLiteral("cadence_avg"), dep.average());
-            obj.setProperty(QStringLiteral("resistance"), (dep = ((bike *)device)->currentResistance()).value());
-            obj.setProperty(QStringLiteral("resistance_avg"), dep.average());
-            obj.setProperty(QStringLiteral("cranks"), ((bike *)device)->currentCrankRevolutions());
-            obj.setProperty(QStringLiteral("cranktime"), ((bike *)device)->lastCrankEventTime());
-            obj.setProperty(QStringLiteral("req_power"), (dep = ((bike *)device)->lastRequestedPower()).value());
-            obj.setProperty(QStringLiteral("req_cadence"), (dep = ((bike *)device)->lastRequestedCadence()).value());
-            obj.setProperty(QStringLiteral("req_resistance"),
-                            (dep = ((bike *)device)->lastRequestedResistance()).value());
+            snapshot[QStringLiteral("peloton_resistance")] = (dep = ((bike *)device)->pelotonResistance()).value();
+            snapshot[QStringLiteral("peloton_req_resistance")] =
+                (dep = ((bike *)device)->lastRequestedPelotonResistance()).value();
+            snapshot[QStringLiteral("peloton_resistance_avg")] = dep.average();
+            snapshot[QStringLiteral("cadence")] = (dep = ((bike *)device)->currentCadence()).value();
+            snapshot[QStringLiteral("cadence_avg")] = dep.average();
+            snapshot[QStringLiteral("resistance")] = (dep = ((bike *)device)->currentResistance()).value();
+            snapshot[QStringLiteral("resistance_avg")] = dep.average();
+            snapshot[QStringLiteral("cranks")] = ((bike *)device)->currentCrankRevolutions();
+            snapshot[QStringLiteral("cranktime")] = ((bike *)device)->lastCrankEventTime();
+            snapshot[QStringLiteral("req_power")] = (dep = ((bike *)device)->lastRequestedPower()).value();
+            snapshot[QStringLiteral("req_cadence")] = (dep = ((bike *)device)->lastRequestedCadence()).value();
+            snapshot[QStringLiteral("req_resistance")] = (dep = ((bike *)device)->lastRequestedResistance()).value();
         } else if (tp == bluetoothdevice::ROWING) {
-            obj.setProperty(QStringLiteral("peloton_resistance"),
-                            (dep = ((rower *)device)->pelotonResistance()).value());
-            obj.setProperty(QStringLiteral("peloton_resistance_avg"), dep.average());
-            obj.setProperty(QStringLiteral("cadence"), (dep = ((rower *)device)->currentCadence()).value());
-            obj.setProperty(QStringLiteral("cadence_avg"), dep.average());
-            obj.setProperty(QStringLiteral("resistance"), (dep = ((rower *)device)->currentResistance()).value());
-            obj.setProperty(QStringLiteral("resistance_avg"), dep.average());
-            obj.setProperty(QStringLiteral("cranks"), ((rower *)device)->currentCrankRevolutions());
-            obj.setProperty(QStringLiteral("cranktime"), ((rower *)device)->lastCrankEventTime());
-            obj.setProperty(QStringLiteral("strokescount"), ((rower *)device)->currentStrokesCount().value());
-            obj.setProperty(QStringLiteral("strokeslength"), ((rower *)device)->currentStrokesLength().value());
+            snapshot[QStringLiteral("peloton_resistance")] = (dep = ((rower *)device)->pelotonResistance()).value();
+            snapshot[QStringLiteral("peloton_resistance_avg")] = dep.average();
+            snapshot[QStringLiteral("cadence")] = (dep = ((rower *)device)->currentCadence()).value();
+            snapshot[QStringLiteral("cadence_avg")] = dep.average();
+            snapshot[QStringLiteral("resistance")] = (dep = ((rower *)device)->currentResistance()).value();
+            snapshot[QStringLiteral("resistance_avg")] = dep.average();
+            snapshot[QStringLiteral("cranks")] = ((rower *)device)->currentCrankRevolutions();
+            snapshot[QStringLiteral("cranktime")] = ((rower *)device)->lastCrankEventTime();
+            snapshot[QStringLiteral("strokescount")] = ((rower *)device)->currentStrokesCount().value();
+            snapshot[QStringLiteral("strokeslength")] = ((rower *)device)->currentStrokesLength().value();
         } else {
-            obj.setProperty(QStringLiteral("inclination"), (dep = ((treadmill *)device)->currentInclination()).value());
-            obj.setProperty(QStringLiteral("inclination_avg"), dep.average());
+            snapshot[QStringLiteral("inclination")] = (dep = ((treadmill *)device)->currentInclination()).value();
+            snapshot[QStringLiteral("inclination_avg")] = dep.average();
+        }
+        if (!device->isPaused() && record) {
+            sessionArray.append(snapshot);
         }
-        if (!device->isPaused()) {
-            sessionArray.append(QJsonObject::fromVariantMap(obj.toVariant().toMap()));
+    }
+
+    if (toScript) {
+        for (auto it = snapshot.constBegin(); it != snapshot.constEnd(); ++it) {
+            obj.setProperty(it.key(), engine->toScriptValue(it.value().toVariant()));
         }
     }
 }
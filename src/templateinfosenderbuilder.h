@@ -5,10 +5,13 @@
 #include <QHash>
 #include <QJSEngine>
 #include <QJsonArray>
+#include <QJsonObject>
+#include <QSet>
 #include <QSettings>
 
 #define TEMPLATE_TYPE_TCPCLIENT QStringLiteral("TcpClient")
 #define TEMPLATE_TYPE_WEBSERVER QStringLiteral("WebServer")
+#define TEMPLATE_TYPE_TIMESERIES QStringLiteral("TimeSeries")
 #define TEMPLATE_PRIVATE_WEBSERVER_ID "QZWS"
 
 class TemplateInfoSenderBuilder : public QObject {
@@ -27,17 +30,27 @@ class TemplateInfoSenderBuilder : public QObject {
 
   private:
     bool validFileTemplateType(const QString &tp) const;
-    void buildContext(bool forceReinit = false);
+    // record: the snapshot goes in the session array too
+    void buildContext(bool forceReinit = false, bool toScript = true, bool record = true);
     QString activityDescription;
     void createTemplatesFromFolder(const QString &idInfo, const QString &folder, QStringList &dirTemplates);
     void clearSessionArray();
     bluetoothdevice *device = nullptr;
     QTimer updateTimer;
+    QTimer liveTimer;
+    // the senders that asked for the M3i table: it's pushed to them every second from then on
+    QTimer m3iTimer;
+    QSet<TemplateInfoSender *> m3iSenders;
+    void sendM3iBikes(TemplateInfoSender *tempSender);
     QString masterId;
     QStringList foldersToLook;
     QJsonArray sessionArray;
+    QJsonObject snapshot;
     QHash<QString, QVariant> context;
+    // created at the first script template: most setups never need one
     QJSEngine *engine = nullptr;
+    QJSEngine *scriptEngine();
+    bool scriptReinit = false;
     TemplateInfoSenderBuilder(QObject *parent);
     void load(const QString &idInfo, const QStringList &folders);
     static QHash<QString, TemplateInfoSenderBuilder *> instanceMap;
@@ -58,6 +71,8 @@ class TemplateInfoSenderBuilder : public QObject {
     void onLoadTrainingPrograms(const QJsonValue &msgContent, TemplateInfoSender *tempSender);
     void onAppendActivityDescription(const QJsonValue &msgContent, TemplateInfoSender *tempSender);
     void onGetSessionArray(TemplateInfoSender *tempSender);
+    void onGetHistory(const QJsonValue &msgContent, TemplateInfoSender *tempSender);
+    void onGetM3iBikes(TemplateInfoSender *tempSender);
     void onStart(TemplateInfoSender *tempSender);
     void onPause(TemplateInfoSender *tempSender);
     void onStop(TemplateInfoSender *tempSender);
@@ -66,6 +81,8 @@ class TemplateInfoSenderBuilder : public QObject {
     QString instructorName = QStringLiteral("");
   private slots:
     void onUpdateTimeout();
+    void onLiveTimeout();
+    void onM3iTimeout();
     void onDataReceived(const QByteArray &data);
   public slots:
     void onWorkoutNameChanged(QString name) { workoutName = name; }
@@ -0,0 +1,455 @@
+#include "characteristicnotifier2a37.h"
+#include "characteristicnotifier2a5b.h"
+#include "characteristicnotifier2a63.h"
+#include "characteristicnotifier2acd.h"
+#include "characteristicnotifier2ad2.h"
+#include "chartseries.h"
+#include "dirconpacket.h"
+#include "domyosbike.h"
+#include "domyostreadmill.h"
+#include "gpx.h"
+#include "m3ibroadcastlistener.h"
+#include "metric.h"
+#include "qfit.h"
+#include "samplebuffer.h"
+#include "sessionline.h"
+#include "templateinfosenderbuilder.h"
+#include "trainingload.h"
+#include "trainprogram.h"
+#include "zwiftworkout.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QTemporaryFile>
+#include <QTextStream>
+#include <QXmlStreamReader>
+#include <QtMath>
+#include <QtTest>
+
+// a driver as it is after the discovery, without a real device: the parsers only ask the controller for its error
+template <class T> class benchdevice : public T {
+  public:
+    benchdevice() { this->m_control = QLowEnergyController::createCentral(QBluetoothDeviceInfo(), this); }
+    using bluetoothdevice::update_metrics;
+};
+
+static QtMessageHandler previousHandler = nullptr;
+
+// the drivers log every packet: the benchmarks measure the code, not the console
+static void quietHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg) {
+    if (type != QtDebugMsg && type != QtInfoMsg && previousHandler) {
+        previousHandler(type, context, msg);
+    }
+}
+
+class bench : public QObject {
+    Q_OBJECT
+
+  signals:
+    // the drivers are fed like QLowEnergyService does, through their private slot
+    void bikePacket(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue);
+    void treadmillPacket(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue);
+    void updateTemplates();
+
+  private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void metricSetValue();
+    void updateMetrics();
+    void trainingLoadSample();
+    void sampleBufferSessionLines();
+    void chartSeriesAppend();
+    void domyosBikeCharacteristicChanged();
+    void domyosTreadmillCharacteristicChanged();
+    void m3iBroadcast_data();
+    void m3iBroadcast();
+    void notify_data();
+    void notify();
+    void dirconParse();
+    void dirconEncode();
+    void qfitSave();
+    void gpxSave();
+    void gpxOpen();
+    void zwiftWorkoutLoad();
+    void trainProgramLookup();
+    void trainProgramExpandRamps();
+    void templateBuildContext();
+
+  private:
+    CharacteristicNotifier *createNotifier(int uuid);
+
+    QTemporaryDir dir;
+    benchdevice<domyosbike> *bike = nullptr;
+    benchdevice<domyostreadmill> *treadmill = nullptr;
+    // 26 bytes status packet of the domyos consoles: 20 km/h, 90 rpm, resistance 8, 120 bpm
+    const QByteArray domyosStatus = QByteArray::fromHex("f0bcffffff0400c8ff5a0000000a08ffffff78ffff00000000ff");
+    QList<SessionLine> session;
+    QByteArray workout;
+};
+
+void bench::initTestCase() {
+    previousHandler = qInstallMessageHandler(quietHandler);
+    qRegisterMetaType<QLowEnergyCharacteristic>();
+    QVERIFY(dir.isValid());
+
+    bike = new benchdevice<domyosbike>();
+    treadmill = new benchdevice<domyostreadmill>();
+    connect(this, SIGNAL(bikePacket(QLowEnergyCharacteristic, QByteArray)), bike,
+            SLOT(characteristicChanged(QLowEnergyCharacteristic, QByteArray)));
+    connect(this, SIGNAL(treadmillPacket(QLowEnergyCharacteristic, QByteArray)), treadmill,
+            SLOT(characteristicChanged(QLowEnergyCharacteristic, QByteArray)));
+    emit bikePacket(QLowEnergyCharacteristic(), domyosStatus);
+    emit treadmillPacket(QLowEnergyCharacteristic(), domyosStatus);
+    bike->publishTelemetry();
+    treadmill->publishTelemetry();
+
+    // one hour at 1 Hz
+    const QDateTime start = QDateTime::currentDateTime();
+    for (uint32_t i = 0; i < 3600; i++) {
+        const double speed = 25.0 + qSin(i / 60.0) * 5.0;
+        session.append(SessionLine(speed, 1, i * 25.0 / 3600.0, 150 + i % 100, 10, 30, 120 + i % 40, 2.4, 85,
+                                   i * 0.2, i * 0.01, i, i % 600 == 0, 0, 0, 0, 0,
+                                   QGeoCoordinate(45.0 + i * 0.00001, 9.0 + i * 0.00001, 120), start.addSecs(i)));
+    }
+
+    workout = QByteArrayLiteral(
+        "<workout_file><sportType>bike</sportType><workout>"
+        "<Warmup Duration=\"600\" PowerLow=\"0.25\" PowerHigh=\"0.75\"/>"
+        "<IntervalsT Repeat=\"10\" OnDuration=\"60\" OffDuration=\"120\" OnPower=\"1.2\" OffPower=\"0.5\"/>"
+        "<SteadyState Duration=\"1200\" Power=\"0.8\" Cadence=\"90\"/>"
+        "<Cooldown Duration=\"600\" PowerLow=\"0.7\" PowerHigh=\"0.3\"/>"
+        "</workout></workout_file>");
+}
+
+void bench::cleanupTestCase() {
+    delete bike;
+    delete treadmill;
+    qInstallMessageHandler(previousHandler);
+}
+
+void bench::metricSetValue() {
+    metric m;
+    double value = 0;
+    QBENCHMARK { m.setValue(value++); }
+    QVERIFY(m.max() > 0);
+}
+
+void bench::updateMetrics() {
+    QBENCHMARK { bike->update_metrics(true, 150); }
+}
+
+void bench::trainingLoadSample() {
+    trainingload load;
+    int i = 0;
+    QBENCHMARK { load.sample(0.25, 150 + (i++ % 100), 140); }
+    QVERIFY(load.trimp() > 0);
+}
+
+void bench::sampleBufferSessionLines() {
+    // one hour at 4 Hz, reduced to 1 Hz as for the FIT export
+    samplebuffer recording;
+    for (int i = 0; i < 3600 * 4; i++) {
+        samplebuffer::sample s = {i * 250, 0, 30, 1, float(150 + i % 100), 90, 140, 8, i * 0.01f, 0,
+                                  i * 2.0, qQNaN(), 0, 0};
+        recording.append(s, i * 250);
+    }
+    QList<SessionLine> lines;
+    QBENCHMARK { lines = recording.sessionLines(false, QList<SessionLine>()); }
+    QCOMPARE(lines.count(), 3600);
+}
+
+void bench::chartSeriesAppend() {
+    // a refresh of the desktop charts: one sample appended, the whole workout replaced in the series
+    chartseries points;
+    int i = 0;
+    QBENCHMARK {
+        points.append(i, 150 + (i % 100));
+        points.points();
+        i++;
+    }
+    QVERIFY(points.points().count() <= 1000);
+}
+
+void bench::domyosBikeCharacteristicChanged() {
+    QBENCHMARK { emit bikePacket(QLowEnergyCharacteristic(), domyosStatus); }
+    QVERIFY(bike->currentCadence().value() > 0);
+}
+
+void bench::domyosTreadmillCharacteristicChanged() {
+    QBENCHMARK { emit treadmillPacket(QLowEnergyCharacteristic(), domyosStatus); }
+    QVERIFY(treadmill->currentSpeed().value() > 0);
+}
+
+void bench::m3iBroadcast_data() {
+    QTest::addColumn<int>("bikes");
+    QTest::newRow("1") << 1;
+    QTest::newRow("10") << 10;
+    QTest::newRow("50") << 50;
+}
+
+// a spin room: a minute of advertisements of every bike, at about the rate of the M3i
+void bench::m3iBroadcast() {
+    QFETCH(int, bikes);
+    const int framesPerSecond = 4;
+    const int frames = 60 * framesPerSecond;
+    QVector<QByteArray> room;
+    room.reserve(bikes * frames);
+    for (int t = 0; t < frames; t++) {
+        const int sec = t / framesPerSecond;
+        for (int b = 0; b < bikes; b++) {
+            const int watt = 100 + (b * 13 + sec) % 150;
+            room.append(m3ibroadcastlistener::encodeFrame(b, 800 + (b * 37 + t) % 300, 1200 + b * 10, watt,
+                                                          watt * sec / 1000, sec, sec * (25.0 + b % 10) / 3600.0,
+                                                          10 + b % 14));
+        }
+    }
+
+    m3ibroadcastlistener listener;
+    qint64 now = 1;
+    QBENCHMARK {
+        int i = 0;
+        for (int t = 0; t < frames; t++, now += 1000 / framesPerSecond) {
+            for (int b = 0; b < bikes; b++) {
+                listener.processAdvertising(room.at(i++), now);
+            }
+        }
+    }
+    QCOMPARE(listener.table(now).count(), bikes);
+}
+
+CharacteristicNotifier *bench::createNotifier(int uuid) {
+    switch (uuid) {
+    case 0x2A37:
+        return new CharacteristicNotifier2A37(bike);
+    case 0x2A5B:
+        return new CharacteristicNotifier2A5B(bike);
+    case 0x2A63:
+        return new CharacteristicNotifier2A63(bike);
+    case 0x2ACD:
+        return new CharacteristicNotifier2ACD(treadmill);
+    default:
+        return new CharacteristicNotifier2AD2(bike);
+    }
+}
+
+void bench::notify_data() {
+    QTest::addColumn<int>("uuid");
+    QTest::newRow("2A37") << 0x2A37;
+    QTest::newRow("2A5B") << 0x2A5B;
+    QTest::newRow("2A63") << 0x2A63;
+    QTest::newRow("2ACD") << 0x2ACD;
+    QTest::newRow("2AD2") << 0x2AD2;
+}
+
+void bench::notify() {
+    QFETCH(int, uuid);
+    QScopedPointer<CharacteristicNotifier> notifier(createNotifier(uuid));
+    QByteArray out;
+    QBENCHMARK {
+        out.clear();
+        notifier->notify(out);
+    }
+    QVERIFY(!out.isEmpty());
+}
+
+void bench::dirconParse() {
+    // write of 0x2AD9 (set target power 200 W) from the app
+    const QByteArray request = QByteArray::fromHex("010401000013"
+                                                   "00002ad900001000800000805f9b34fb"
+                                                   "05c800");
+    int rv = 0;
+    QBENCHMARK {
+        DirconPacket pkt;
+        rv = pkt.parse(request, 0);
+    }
+    QVERIFY(rv > 0);
+}
+
+void bench::dirconEncode() {
+    DirconPacket pkt;
+    pkt.Identifier = DPKT_MSGID_UNSOLICITED_CHARACTERISTIC_NOTIFICATION;
+    pkt.uuid = 0x2AD2;
+    CharacteristicNotifier2AD2(bike).notify(pkt.additional_data);
+    QByteArray out;
+    QBENCHMARK { out = pkt.encode(0); }
+    QVERIFY(!out.isEmpty());
+}
+
+void bench::qfitSave() {
+    const QString file = dir.filePath(QStringLiteral("bench.fit"));
+    QBENCHMARK { qfit::save(file, session, bluetoothdevice::BIKE); }
+    QVERIFY(QFileInfo(file).size() > 0);
+}
+
+void bench::gpxSave() {
+    const QString file = dir.filePath(QStringLiteral("bench.gpx"));
+    QBENCHMARK { gpx::save(file, session, bluetoothdevice::BIKE); }
+    QVERIFY(QFileInfo(file).size() > 0);
+}
+
+void bench::gpxOpen() {
+    const QString file = dir.filePath(QStringLiteral("open.gpx"));
+    gpx::save(file, session, bluetoothdevice::BIKE);
+    QList<gpx_altitude_point_for_treadmill> points;
+    QBENCHMARK {
+        gpx g;
+        points = g.open(file);
+    }
+    QVERIFY(!points.isEmpty());
+}
+
+void bench::zwiftWorkoutLoad() {
+    QList<trainrow> rows;
+    QBENCHMARK { rows = zwiftworkout::load(workout); }
+    QVERIFY(!rows.isEmpty());
+}
+
+void bench::trainProgramLookup() {
+    trainprogram program(zwiftworkout::load(workout), nullptr);
+    program.increaseElapsedTime(QTime(0, 0, 0).secsTo(program.duration()) / 2);
+    QTime remaining;
+    QBENCHMARK {
+        program.currentRowElapsedTime();
+        program.currentRowRemainingTime();
+        remaining = program.remainingTime();
+    }
+    QVERIFY(remaining.isValid());
+}
+
+void bench::trainProgramExpandRamps() {
+    const QList<trainrow> rows = zwiftworkout::load(workout);
+    QList<trainrow> expanded;
+    QBENCHMARK { expanded = trainprogram::expandRamps(rows); }
+    QVERIFY(expanded.count() >= rows.count());
+}
+
+void bench::templateBuildContext() {
+    // without templates the update is just the native buildContext of the second, like for the web server pages
+    TemplateInfoSenderBuilder *templates =
+        TemplateInfoSenderBuilder::getInstance(QStringLiteral("bench"), QStringList(), this);
+    templates->start(bike);
+    templates->stop();
+    connect(this, SIGNAL(updateTemplates()), templates, SLOT(onUpdateTimeout()));
+    QBENCHMARK { emit updateTemplates(); }
+}
+
+// the QtTest xml log, as json: {"qt", "date", "results": [{"name", "tag", "metric", "value", "iterations"}]}
+// with value for a single iteration
+static QJsonObject results(const QString &xmlFile) {
+    QJsonArray list;
+    QFile file(xmlFile);
+    if (file.open(QIODevice::ReadOnly)) {
+        QXmlStreamReader xml(&file);
+        QString function;
+        while (!xml.atEnd()) {
+            if (xml.readNext() != QXmlStreamReader::StartElement) {
+                continue;
+            }
+            const QXmlStreamAttributes atts = xml.attributes();
+            if (xml.name() == QLatin1String("TestFunction")) {
+                function = atts.value(QStringLiteral("name")).toString();
+            } else if (xml.name() == QLatin1String("BenchmarkResult")) {
+                QJsonObject r;
+                r[QStringLiteral("name")] = function;
+                r[QStringLiteral("tag")] = atts.value(QStringLiteral("tag")).toString();
+                r[QStringLiteral("metric")] = atts.value(QStringLiteral("metric")).toString();
+                r[QStringLiteral("value")] = atts.value(QStringLiteral("value")).toDouble();
+                r[QStringLiteral("iterations")] = atts.value(QStringLiteral("iterations")).toInt();
+                list.append(r);
+            }
+        }
+    }
+    QJsonObject root;
+    root[QStringLiteral("qt")] = QString::fromLatin1(qVersion());
+    root[QStringLiteral("date")] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    root[QStringLiteral("results")] = list;
+    return root;
+}
+
+static QString key(const QJsonObject &r) {
+    QString k = r[QStringLiteral("name")].toString();
+    if (!r[QStringLiteral("tag")].toString().isEmpty()) {
+        k += QStringLiteral(":") + r[QStringLiteral("tag")].toString();
+    }
+    return k;
+}
+
+// it's the report of the run, so it goes to the console whatever the message handler is
+static void compare(const QJsonObject &current, const QString &baselineFile) {
+    QFile file(baselineFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        QTextStream(stderr) << QStringLiteral("bench: can't open ") << baselineFile << QStringLiteral("\n");
+        return;
+    }
+    QTextStream out(stdout);
+    QHash<QString, double> baseline;
+    const QJsonArray old = QJsonDocument::fromJson(file.readAll()).object()[QStringLiteral("results")].toArray();
+    for (const QJsonValue &v : old) {
+        baseline.insert(key(v.toObject()), v.toObject()[QStringLiteral("value")].toDouble());
+    }
+    const QJsonArray list = current[QStringLiteral("results")].toArray();
+    for (const QJsonValue &v : list) {
+        const QJsonObject r = v.toObject();
+        const double value = r[QStringLiteral("value")].toDouble();
+        const double before = baseline.value(key(r), 0);
+        QString line = QStringLiteral("bench: %1 %2 %3")
+                           .arg(key(r), -40)
+                           .arg(value, 0, 'g', 4)
+                           .arg(r[QStringLiteral("metric")].toString());
+        if (before > 0) {
+            line += QStringLiteral(" (%1%2%)")
+                        .arg(value >= before ? QStringLiteral("+") : QStringLiteral(""))
+                        .arg((value - before) * 100.0 / before, 0, 'f', 1);
+        }
+        out << line << QStringLiteral("\n");
+    }
+}
+
+// -json <file>: saves the results as json
+// -baseline <file>: compares the results with the json of a previous run
+// the other arguments are the ones of QtTest
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    // not the settings of the app
+    app.setOrganizationName(QStringLiteral("qdomyos-zwift-bench"));
+    app.setApplicationName(QStringLiteral("qdomyos-zwift-bench"));
+
+    QStringList args = app.arguments();
+    QString jsonFile, baselineFile;
+    for (int i = 1; i < args.count() - 1;) {
+        if (args.at(i) == QStringLiteral("-json")) {
+            jsonFile = args.takeAt(i + 1);
+            args.removeAt(i);
+        } else if (args.at(i) == QStringLiteral("-baseline")) {
+            baselineFile = args.takeAt(i + 1);
+            args.removeAt(i);
+        } else {
+            i++;
+        }
+    }
+
+    QTemporaryFile xml;
+    if (!xml.open()) {
+        return 1;
+    }
+    args << QStringLiteral("-o") << xml.fileName() + QStringLiteral(",xml") << QStringLiteral("-o")
+         << QStringLiteral("-,txt");
+
+    bench b;
+    const int rv = QTest::qExec(&b, args);
+
+    const QJsonObject json = results(xml.fileName());
+    if (!jsonFile.isEmpty()) {
+        QFile file(jsonFile);
+        if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            file.write(QJsonDocument(json).toJson());
+        }
+    }
+    if (!baselineFile.isEmpty()) {
+        compare(json, baselineFile);
+    }
+    return rv;
+}
+
+#include "bench.moc"
@@ -0,0 +1,22 @@
+# QBENCHMARK suite of the hot paths: metrics, driver parsers, M3i broadcasts, Dircon, exports, workouts and
+# templates.
+# It's built on the headless bridge, so it doesn't need the user interface.
+#
+# cd src/test/bench
+# qmake
+# make
+# ./qdomyos-zwift-bench -json before.json
+# ./qdomyos-zwift-bench -json after.json -baseline before.json
+#
+# Any other argument goes to QtTest, e.g. a single benchmark: ./qdomyos-zwift-bench metricSetValue
+
+include($$PWD/../../bridge/qdomyos-zwift-bridge.pro)
+
+TARGET = qdomyos-zwift-bench
+QT += testlib
+CONFIG += console
+
+SOURCES -= main.cpp
+SOURCES += $$PWD/bench.cpp
+
+target.path = /opt/$${TARGET}/bin
@@ -0,0 +1,648 @@
+#include "bike.h"
+#include "chartseries.h"
+#include "linkwatchdog.h"
+#include "powercalibration.h"
+#include "samplebuffer.h"
+#include "sessionline.h"
+#include "steadyclock.h"
+#include "stravauploadqueue.h"
+#include "trainingload.h"
+#include "workoutlibrary.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QSettings>
+#include <QSharedPointer>
+#include <QSignalSpy>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QtMath>
+#include <QtTest>
+
+// a bike without a driver: the test sets its speed and calls update_metrics as the parser of a packet would
+class simbike : public bike {
+  public:
+    using bluetoothdevice::update_metrics;
+    void setSpeed(double kmh) { Speed = kmh; }
+};
+
+// HTTP server on localhost: it answers the requests, in order, with the replies of the list (500 when it's empty)
+// and it keeps them for the checks
+class stubserver : public QTcpServer {
+  public:
+    QList<QPair<int, QByteArray>> replies;
+    QList<QByteArray> requests;
+
+    stubserver() {
+        connect(this, &QTcpServer::newConnection, this, [this]() {
+            QTcpSocket *socket = nextPendingConnection();
+            auto buffer = QSharedPointer<QByteArray>::create();
+            connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            connect(socket, &QTcpSocket::readyRead, socket, [this, socket, buffer]() {
+                buffer->append(socket->readAll());
+                const int end = buffer->indexOf("\r\n\r\n");
+                if (end < 0) {
+                    return;
+                }
+                const QRegularExpressionMatch length =
+                    QRegularExpression(QStringLiteral("content-length:\\s*(\\d+)"),
+                                       QRegularExpression::CaseInsensitiveOption)
+                        .match(QString::fromLatin1(buffer->left(end)));
+                if (buffer->size() < end + 4 + (length.hasMatch() ? length.captured(1).toInt() : 0)) {
+                    return;
+                }
+                requests.append(*buffer);
+                buffer->clear();
+                const QPair<int, QByteArray> reply =
+                    replies.isEmpty() ? qMakePair(500, QByteArray()) : replies.takeFirst();
+                socket->write("HTTP/1.1 " + QByteArray::number(reply.first) +
+                              " Stub\r\nContent-Type: application/json\r\nContent-Length: " +
+                              QByteArray::number(reply.second.size()) + "\r\nConnection: close\r\n\r\n" +
+                              reply.second);
+                socket->disconnectFromHost();
+            });
+        });
+        listen(QHostAddress::LocalHost);
+    }
+
+    QUrl url(const QString &path) const {
+        return QUrl(QStringLiteral("http://127.0.0.1:") + QString::number(serverPort()) + path);
+    }
+};
+
+class unit : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void init();
+    void stravaUploadQueueRefreshAndUpload();
+    void stravaUploadQueueRetry();
+    void stravaUploadQueueEmptyFit();
+    void trainingLoadConstantPower_data();
+    void trainingLoadConstantPower();
+    void trainingLoadWPrimeBalance();
+    void updateMetricsVirtualClock();
+    void sampleBufferAverages();
+    void sampleBufferGap();
+    void sampleBufferPause();
+    void sampleBufferUiFields();
+    void workoutLibraryZwo();
+    void workoutLibraryNoFtp();
+    void linkWatchdogStall();
+    void linkWatchdogBackoff();
+    void linkWatchdogArming();
+    void chartSeriesMerge();
+    void chartSeriesWindow();
+    void chartSeriesBackwards();
+    void powerCalibrationConvergence();
+    void powerCalibrationBounds();
+    void powerCalibrationLoadBounds();
+
+  private:
+    static int pendingJobs(const QString &path);
+    static samplebuffer::sample recorded(qint64 ms, float watts, double distance);
+};
+
+void unit::init() { QSettings().clear(); }
+
+int unit::pendingJobs(const QString &path) {
+    return QDir(path).entryList(QStringList() << QStringLiteral("*.fit.gz"), QDir::Files).count();
+}
+
+void unit::stravaUploadQueueRefreshAndUpload() {
+    QTemporaryDir dir;
+    stubserver server;
+    QVERIFY(server.isListening());
+    const QByteArray token = "{\"access_token\":\"fresh-access\",\"refresh_token\":\"refresh2\",\"expires_at\":" +
+                             QByteArray::number(QDateTime::currentSecsSinceEpoch() + 3600) + "}";
+    server.replies.append(qMakePair(200, token));
+    server.replies.append(qMakePair(201, QByteArrayLiteral("{\"id\":1}")));
+
+    // no access token: the queue has to refresh it before the upload
+    QSettings settings;
+    settings.setValue(QStringLiteral("strava_refreshtoken"), QStringLiteral("refresh"));
+
+    stravauploadqueue queue(dir.path() + QStringLiteral("/"), server.url(QStringLiteral("/api/v3/uploads")),
+                            server.url(QStringLiteral("/oauth/token")));
+    queue.setClientCredentials(QStringLiteral("1"), QStringLiteral("secret"));
+    QSignalSpy uploaded(&queue, &stravauploadqueue::uploaded);
+    queue.start();
+    queue.enqueue(QByteArrayLiteral("fit payload"), QStringLiteral("workout"), QStringLiteral("Ride"), QString(),
+                  QStringLiteral("ride"));
+
+    QVERIFY(uploaded.wait(5000));
+    QCOMPARE(uploaded.at(0).at(0).toString(), QStringLiteral("workout"));
+    QCOMPARE(server.requests.count(), 2);
+    QVERIFY(server.requests.at(0).startsWith("POST /oauth/token"));
+    QVERIFY(server.requests.at(0).contains("grant_type=refresh_token"));
+    QVERIFY(server.requests.at(1).startsWith("POST /api/v3/uploads"));
+    QVERIFY(server.requests.at(1).contains("\r\nAuthorization: Bearer fresh-access\r\n"));
+    QVERIFY(server.requests.at(1).contains("\x1f\x8b\x08"));
+    QCOMPARE(QSettings().value(QStringLiteral("strava_refreshtoken")).toString(), QStringLiteral("refresh2"));
+    QCOMPARE(pendingJobs(dir.path()), 0);
+}
+
+void unit::stravaUploadQueueRetry() {
+    QTemporaryDir dir;
+    stubserver server;
+    server.replies.append(qMakePair(503, QByteArray()));
+
+    QSettings settings;
+    settings.setValue(QStringLiteral("strava_refreshtoken"), QStringLiteral("refresh"));
+    settings.setValue(QStringLiteral("strava_accesstoken"), QStringLiteral("access"));
+    settings.setValue(QStringLiteral("strava_expires"), QDateTime::currentSecsSinceEpoch() + 3600);
+
+    stravauploadqueue queue(dir.path() + QStringLiteral("/"), server.url(QStringLiteral("/api/v3/uploads")),
+                            server.url(QStringLiteral("/oauth/token")));
+    QSignalSpy failed(&queue, &stravauploadqueue::uploadFailed);
+    queue.start();
+    queue.enqueue(QByteArrayLiteral("fit payload"), QStringLiteral("workout"), QStringLiteral("Ride"), QString(),
+                  QStringLiteral("ride"));
+
+    // the token is still valid, so there is only the upload, and the job stays on disk for the next attempt
+    QVERIFY(failed.wait(5000));
+    QCOMPARE(failed.at(0).at(1).toInt(), 1);
+    QCOMPARE(server.requests.count(), 1);
+    QCOMPARE(pendingJobs(dir.path()), 1);
+
+    const QStringList meta = QDir(dir.path()).entryList(QStringList() << QStringLiteral("*.json"), QDir::Files);
+    QCOMPARE(meta.count(), 1);
+    QFile metaFile(dir.filePath(meta.first()));
+    QVERIFY(metaFile.open(QIODevice::ReadOnly));
+    const QJsonObject job = QJsonDocument::fromJson(metaFile.readAll()).object();
+    QCOMPARE(job[QStringLiteral("attempts")].toInt(), 1);
+    QVERIFY(job[QStringLiteral("next_attempt")].toDouble() > QDateTime::currentMSecsSinceEpoch());
+}
+
+void unit::stravaUploadQueueEmptyFit() {
+    QTemporaryDir dir;
+    stravauploadqueue queue(dir.path() + QStringLiteral("/"));
+    queue.enqueue(QByteArray(), QStringLiteral("workout"), QStringLiteral("Ride"), QString(), QStringLiteral("ride"));
+    QCoreApplication::processEvents();
+    QCOMPARE(pendingJobs(dir.path()), 0);
+}
+
+// one hour at the FTP is the definition of 100 TSS, whatever the rate of the device
+void unit::trainingLoadConstantPower_data() {
+    QTest::addColumn<double>("seconds");
+    QTest::newRow("1 Hz") << 1.0;
+    QTest::newRow("4 Hz") << 0.25;
+}
+
+void unit::trainingLoadConstantPower() {
+    QFETCH(double, seconds);
+    QSettings().setValue(QStringLiteral("ftp"), 200.0);
+    trainingload load;
+    for (int i = 0; i < qRound(3600 / seconds); i++) {
+        load.sample(seconds, 200, 0);
+    }
+    QVERIFY(qAbs(load.normalizedPower() - 200.0) < 0.01);
+    QVERIFY(qAbs(load.intensityFactor() - 1.0) < 0.0001);
+    QVERIFY(qAbs(load.tss() - 100.0) < 0.01);
+    QCOMPARE(load.wPrimeBalance(), load.wPrime());
+}
+
+void unit::trainingLoadWPrimeBalance() {
+    QSettings settings;
+    settings.setValue(QStringLiteral("ftp"), 200.0);
+    settings.setValue(QStringLiteral("w_prime"), 20000.0);
+    trainingload load;
+
+    // 100 W above the FTP for a minute drains 6 kJ
+    for (int i = 0; i < 60; i++) {
+        load.sample(1, 300, 0);
+    }
+    QVERIFY(qAbs(load.wPrimeBalance() - 14000.0) < 0.01);
+
+    // below the FTP it recovers exponentially, with the FTP - watts gap over W' as rate
+    for (int i = 0; i < 600; i++) {
+        load.sample(1, 100, 0);
+    }
+    QVERIFY(load.wPrimeBalance() > 14000.0);
+    QVERIFY(load.wPrimeBalance() < 20000.0);
+    QVERIFY(qAbs(load.wPrimeBalance() - (20000.0 - 6000.0 * qExp(-3.0))) < 0.01);
+}
+
+// an hour of workout and a pause, in no time: the metrics only see the installed clock
+void unit::updateMetricsVirtualClock() {
+    QSettings().setValue(QStringLiteral("ftp"), 200.0);
+    virtualclock clock;
+    steadyclock::install(&clock);
+    // also when a check fails, the next tests must get the real clock back
+    struct restore {
+        ~restore() { steadyclock::install(nullptr); }
+    } restoreClock;
+    simbike b;
+    b.setSpeed(30);
+    b.update_metrics(true, 200);
+    for (int i = 0; i < 3600; i++) {
+        clock.advance(1000);
+        b.update_metrics(true, 200);
+    }
+    QCOMPARE(b.elapsedTime(), QTime(1, 0, 0));
+    // the power of an update is counted from the next one
+    QVERIFY(qAbs(b.jouls().value() - 200.0 * 3599) < 0.01);
+    QVERIFY(qAbs(b.trainingLoad().tss() - 100.0) < 0.01);
+    QCOMPARE(b.recording().count(), 3600);
+
+    b.setPaused(true);
+    for (int i = 0; i < 600; i++) {
+        clock.advance(1000);
+        b.update_metrics(true, 200);
+    }
+    QCOMPARE(b.elapsedTime(), QTime(1, 0, 0));
+    QCOMPARE(b.recording().count(), 3600);
+}
+
+samplebuffer::sample unit::recorded(qint64 ms, float watts, double distance) {
+    samplebuffer::sample s = {ms, 0, 30, 0, watts, 90, 120, 5, 0, 0, distance, qQNaN(), 0, 0};
+    return s;
+}
+
+// 4 Hz reduced to 1 Hz: the average of the second, the cumulative values at its end
+void unit::sampleBufferAverages() {
+    const qint64 wall = QDateTime(QDate(2024, 1, 1), QTime(10, 0)).toMSecsSinceEpoch();
+    samplebuffer recording;
+    const float watts[] = {100, 200, 300, 400, 200, 200, 200, 200};
+    for (int i = 0; i < 8; i++) {
+        recording.append(recorded(i * 250, watts[i], i * 0.01), wall + i * 250);
+    }
+    // closer than 1000 / maxRate: dropped
+    recording.append(recorded(7 * 250 + 10, 1000, 1), wall + 7 * 250 + 10);
+    QCOMPARE(recording.count(), 8);
+
+    const QList<SessionLine> lines = recording.sessionLines(false, QList<SessionLine>());
+    QCOMPARE(lines.count(), 2);
+    QCOMPARE(int(lines.at(0).watt), 250);
+    QCOMPARE(int(lines.at(1).watt), 200);
+    QCOMPARE(lines.at(0).distance, 0.03);
+    QCOMPARE(lines.at(1).distance, 0.07);
+    QCOMPARE(lines.at(1).elapsedTime, 1u);
+    QCOMPARE(lines.at(0).time.toMSecsSinceEpoch(), wall);
+    QCOMPARE(lines.at(1).time.toMSecsSinceEpoch(), wall + 1000);
+
+    const QList<SessionLine> native = recording.sessionLines(true, QList<SessionLine>());
+    QCOMPARE(native.count(), 8);
+    QCOMPARE(int(native.at(3).watt), 400);
+    QCOMPARE(native.at(3).time.toMSecsSinceEpoch(), wall + 750);
+}
+
+// the seconds without samples repeat the previous one
+void unit::sampleBufferGap() {
+    const qint64 wall = QDateTime(QDate(2024, 1, 1), QTime(10, 0)).toMSecsSinceEpoch();
+    samplebuffer recording;
+    recording.append(recorded(0, 100, 0), wall);
+    recording.append(recorded(3000, 300, 0.03), wall + 3000);
+
+    const QList<SessionLine> lines = recording.sessionLines(false, QList<SessionLine>());
+    QCOMPARE(lines.count(), 4);
+    for (int i = 0; i < 3; i++) {
+        QCOMPARE(int(lines.at(i).watt), 100);
+        QCOMPARE(lines.at(i).distance, 0.0);
+        QCOMPARE(lines.at(i).elapsedTime, uint32_t(i));
+        QCOMPARE(lines.at(i).time.toMSecsSinceEpoch(), wall + i * 1000);
+    }
+    QCOMPARE(int(lines.at(3).watt), 300);
+    QCOMPARE(lines.at(3).distance, 0.03);
+}
+
+// a minute of pause: the elapsed time doesn't see it, the times of the lines do
+void unit::sampleBufferPause() {
+    const qint64 wall = QDateTime(QDate(2024, 1, 1), QTime(10, 0)).toMSecsSinceEpoch();
+    samplebuffer recording;
+    recording.append(recorded(0, 100, 0), wall);
+    recording.append(recorded(1000, 100, 0.01), wall + 1000);
+    recording.append(recorded(2000, 100, 0.02), wall + 62000);
+    recording.append(recorded(2500, 100, 0.025), wall + 62500);
+    QCOMPARE(recording.start().toMSecsSinceEpoch(), wall);
+
+    const QList<SessionLine> lines = recording.sessionLines(false, QList<SessionLine>());
+    QCOMPARE(lines.count(), 3);
+    QCOMPARE(lines.at(1).time.toMSecsSinceEpoch(), wall + 1000);
+    QCOMPARE(lines.at(2).elapsedTime, 2u);
+    QCOMPARE(lines.at(2).time.toMSecsSinceEpoch(), wall + 62000);
+
+    const QList<SessionLine> native = recording.sessionLines(true, QList<SessionLine>());
+    QCOMPARE(native.count(), 4);
+    QCOMPARE(native.at(3).time.toMSecsSinceEpoch(), wall + 62500);
+}
+
+// the fields known only by the UI come from its line of the same second, a lap only once
+void unit::sampleBufferUiFields() {
+    const qint64 wall = QDateTime(QDate(2024, 1, 1), QTime(10, 0)).toMSecsSinceEpoch();
+    samplebuffer recording;
+    for (int i = 0; i < 12; i++) {
+        recording.append(recorded(i * 250, 150, i * 0.01), wall + i * 250);
+    }
+    QList<SessionLine> ui;
+    for (uint32_t second = 0; second < 3; second++) {
+        ui.append(SessionLine(30, 0, 0, 150, 5, 20 + second, 120, 2.5, 90, 0, 0, second, second == 1, 0, 0, 0, 0,
+                              QGeoCoordinate()));
+    }
+    ui.last().tss = 42;
+
+    const QList<SessionLine> lines = recording.sessionLines(false, ui);
+    QCOMPARE(lines.count(), 3);
+    QCOMPARE(int(lines.at(2).peloton_resistance), 22);
+    QCOMPARE(lines.at(0).pace, 2.5);
+    QVERIFY(!lines.at(0).lapTrigger);
+    QVERIFY(lines.at(1).lapTrigger);
+    QCOMPARE(lines.at(2).tss, 42.0);
+
+    const QList<SessionLine> native = recording.sessionLines(true, ui);
+    QCOMPARE(native.count(), 12);
+    int laps = 0;
+    for (const SessionLine &l : native) {
+        laps += l.lapTrigger ? 1 : 0;
+    }
+    QCOMPARE(laps, 1);
+    QVERIFY(native.at(4).lapTrigger);
+    QCOMPARE(int(native.at(5).peloton_resistance), 21);
+}
+
+// five minutes at half the ftp and five at the ftp
+void unit::workoutLibraryZwo() {
+    QTemporaryDir dir;
+    QDir().mkpath(dir.filePath(QStringLiteral("training/rides")));
+    QFile zwo(dir.filePath(QStringLiteral("training/rides/steps.zwo")));
+    QVERIFY(zwo.open(QIODevice::WriteOnly));
+    zwo.write("<workout_file><sportType>bike</sportType><workout>"
+              "<SteadyState Duration=\"300\" Power=\"0.5\"/><SteadyState Duration=\"300\" Power=\"1.0\"/>"
+              "</workout></workout_file>");
+    zwo.close();
+    QSettings().setValue(QStringLiteral("ftp"), 250.0);
+
+    const QString cache = dir.filePath(QStringLiteral("library.sqlite"));
+    {
+        workoutlibrary library(dir.filePath(QStringLiteral("training/")), cache);
+        QSignalSpy changed(&library, &workoutlibrary::workoutsChanged);
+        QVERIFY(changed.wait(5000));
+
+        const QVariantList list = library.workouts();
+        QCOMPARE(list.count(), 1);
+        const QVariantMap w = list.first().toMap();
+        QCOMPARE(w[QStringLiteral("name")].toString(), QStringLiteral("rides/steps"));
+        QCOMPARE(w[QStringLiteral("duration")].toInt(), 600);
+        QVERIFY(w[QStringLiteral("power")].toBool());
+        const double intensity = w[QStringLiteral("intensity")].toDouble();
+        QVERIFY(intensity > 0.75 && intensity < 1.0);
+        QVERIFY(qAbs(w[QStringLiteral("tss")].toDouble() - intensity * intensity * 600.0 / 36.0) < 1e-6);
+
+        const QVariantList profile = w[QStringLiteral("profile")].toList();
+        QCOMPARE(profile.count(), workoutlibrary::profileSize);
+        QCOMPARE(profile.first().toFloat(), 0.5f);
+        QCOMPARE(profile.at(workoutlibrary::profileSize / 2 - 1).toFloat(), 0.5f);
+        QCOMPARE(profile.at(workoutlibrary::profileSize / 2).toFloat(), 1.0f);
+        QCOMPARE(profile.last().toFloat(), 1.0f);
+    }
+
+    // the cache key: modification time, size and ftp of the file
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("unit"));
+        db.setDatabaseName(cache);
+        QVERIFY(db.open());
+        QSqlQuery q(db);
+        QVERIFY(q.exec(QStringLiteral("SELECT mtime, size, ftp, duration FROM workouts")));
+        QVERIFY(q.next());
+        const QFileInfo info(zwo);
+        QCOMPARE(q.value(0).toLongLong(), info.lastModified().toMSecsSinceEpoch());
+        QCOMPARE(q.value(1).toLongLong(), info.size());
+        QCOMPARE(q.value(2).toDouble(), 250.0);
+        QCOMPARE(q.value(3).toInt(), 600);
+        QVERIFY(!q.next());
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("unit"));
+}
+
+// a zero ftp in the settings falls back to 200 instead of dividing by zero
+void unit::workoutLibraryNoFtp() {
+    trainrow row;
+    row.duration = QTime(0, 10, 0);
+    row.power = 200;
+    const workoutlibrary::workout w = workoutlibrary::describe({row}, 0);
+    QCOMPARE(w.duration, 600);
+    QVERIFY(qIsFinite(w.intensity));
+    QCOMPARE(w.intensity, 1.0);
+    QCOMPARE(w.profile.first(), 1.0f);
+}
+
+// a device notifying every second: the stall is after 4 missed intervals, but never before minStallMs
+void unit::linkWatchdogStall() {
+    virtualclock clock;
+    steadyclock::install(&clock);
+    struct restore {
+        ~restore() { steadyclock::install(nullptr); }
+    } restoreClock;
+    bool moving = true;
+    linkwatchdog watchdog;
+    watchdog.setMoving([&moving]() { return moving; });
+    watchdog.feed();
+    for (int i = 0; i < 10; i++) {
+        clock.advance(1000);
+        watchdog.feed();
+    }
+    QCOMPARE(watchdog.intervalMs(), qint64(1000));
+
+    // the silence doesn't count while disarmed
+    clock.advance(10000);
+    QVERIFY(!watchdog.stalled(clock.msecs()));
+    // arming starts a new grace period
+    watchdog.setArmed(true);
+    clock.advance(linkwatchdog::minStallMs);
+    QVERIFY(!watchdog.stalled(clock.msecs()));
+    clock.advance(1);
+    QVERIFY(watchdog.stalled(clock.msecs()));
+    // an idle machine is silent by design
+    moving = false;
+    QVERIFY(!watchdog.stalled(clock.msecs()));
+    moving = true;
+
+    // a slower cadence gives a longer limit
+    for (int i = 0; i < 50; i++) {
+        clock.advance(3000);
+        watchdog.feed();
+    }
+    QVERIFY(qAbs(watchdog.intervalMs() - 3000) <= 10);
+    clock.advance(watchdog.intervalMs() * linkwatchdog::missedIntervals - 10);
+    QVERIFY(!watchdog.stalled(clock.msecs()));
+    clock.advance(20);
+    QVERIFY(watchdog.stalled(clock.msecs()));
+}
+
+void unit::linkWatchdogBackoff() {
+    QCOMPARE(linkwatchdog::backoffMs(0), qint64(1000));
+    QCOMPARE(linkwatchdog::backoffMs(1), qint64(2000));
+    QCOMPARE(linkwatchdog::backoffMs(4), qint64(16000));
+    QCOMPARE(linkwatchdog::backoffMs(5), qint64(linkwatchdog::maxBackoffMs));
+    QCOMPARE(linkwatchdog::backoffMs(100), qint64(linkwatchdog::maxBackoffMs));
+}
+
+// the device arms its watchdog at the connection and disarms it while the workout is paused or stopped
+void unit::linkWatchdogArming() {
+    simbike b;
+    QVERIFY(!b.linkWatchdog()->armed());
+    emit b.connectedAndDiscovered();
+    QVERIFY(b.linkWatchdog()->armed());
+    b.setPaused(true);
+    QVERIFY(!b.linkWatchdog()->armed());
+    emit b.connectedAndDiscovered();
+    QVERIFY(!b.linkWatchdog()->armed());
+    b.setPaused(false);
+    QVERIFY(b.linkWatchdog()->armed());
+}
+
+// without a window the buckets are merged in pairs when the ring is full: the points stay few and the peaks stay
+void unit::chartSeriesMerge() {
+    chartseries series(0, 10);
+    for (int x = 0; x < 10; x++) {
+        series.append(x, x);
+    }
+    QCOMPARE(series.points().count(), 10);
+
+    // the 11th bucket doesn't fit: the 10 become 5 of 2 seconds, each one with its minimum and maximum
+    series.append(10, 10);
+    const QVector<QPointF> merged = series.points();
+    QCOMPARE(merged.count(), 11);
+    QCOMPARE(merged.at(0), QPointF(0, 0));
+    QCOMPARE(merged.at(1), QPointF(1, 1));
+    QCOMPARE(merged.last(), QPointF(10, 10));
+
+    chartseries peaks(0, 10);
+    for (int x = 0; x < 1000; x++) {
+        peaks.append(x, x == 437 ? 500 : 100);
+    }
+    const QVector<QPointF> points = peaks.points();
+    QVERIFY(points.count() <= 2 * 10);
+    QVERIFY(points.contains(QPointF(437, 500)));
+    QCOMPARE(peaks.maxY(), 500.0);
+    QCOMPARE(peaks.minY(), 100.0);
+    QCOMPARE(peaks.minX(), 0.0);
+    for (int i = 1; i < points.count(); i++) {
+        QVERIFY(points.at(i - 1).x() < points.at(i).x());
+    }
+}
+
+// with a window only its last part is kept, one bucket per second here
+void unit::chartSeriesWindow() {
+    chartseries series(60, 60);
+    for (int x = 0; x < 200; x++) {
+        series.append(x, x % 7);
+    }
+    const QVector<QPointF> points = series.points();
+    QCOMPARE(series.maxX(), 199.0);
+    QVERIFY(series.minX() >= 199.0 - 61);
+    QVERIFY(series.minX() <= 199.0 - 60);
+    QVERIFY(points.count() <= 62);
+
+    series.clear();
+    QVERIFY(series.isEmpty());
+    QVERIFY(series.points().isEmpty());
+}
+
+// x going back (a new session without a clear) doesn't open a bucket: it stays in the last one
+void unit::chartSeriesBackwards() {
+    chartseries series(0, 10);
+    series.append(5, 10);
+    series.append(6, 20);
+    series.append(2, 50);
+    const QVector<QPointF> points = series.points();
+    QCOMPARE(points.count(), 3);
+    QCOMPARE(points.at(0), QPointF(5, 10));
+    QVERIFY(points.contains(QPointF(2, 50)));
+    QCOMPARE(series.maxY(), 50.0);
+    QCOMPARE(series.maxX(), 6.0);
+}
+
+// the power of a bike that follows the model exactly, with a little noise
+static double modelWatts(double cadence, double resistance) {
+    const double c = cadence / 100.0, r = resistance / 100.0;
+    return 20.0 + 150.0 * c + 900.0 * c * r + 400.0 * c * r * r;
+}
+
+void unit::powerCalibrationConvergence() {
+    powercalibration model;
+    QRandomGenerator random(42);
+    for (int i = 0; i < 3000; i++) {
+        const double cadence = 60.0 + random.bounded(40.0);
+        const double resistance = 10.0 + random.bounded(30.0);
+        QVERIFY(model.addSample(cadence, resistance, modelWatts(cadence, resistance) + random.bounded(2.0) - 1.0));
+    }
+    QVERIFY(model.isReady());
+    for (const QPointF &p : {QPointF(70, 15), QPointF(90, 35), QPointF(80, 25)}) {
+        const double expected = modelWatts(p.x(), p.y());
+        QVERIFY2(qAbs(model.predict(p.x(), p.y()) - expected) < expected * 0.02,
+                 qPrintable(QString::number(model.predict(p.x(), p.y())) + QStringLiteral(" instead of ") +
+                            QString::number(expected)));
+    }
+    // coasting and no power are not samples
+    QVERIFY(!model.addSample(0, 20, 100));
+    QVERIFY(!model.addSample(80, 20, 0));
+}
+
+void unit::powerCalibrationBounds() {
+    powercalibration model;
+    QRandomGenerator random(7);
+    // a power meter reading 2 kW more than the bike: the coefficients stay in their range
+    for (int i = 0; i < 2000; i++) {
+        const double cadence = 1.0 + random.bounded(119.0);
+        const double resistance = random.bounded(100.0);
+        model.addSample(cadence, resistance, 2000.0 + modelWatts(cadence, resistance));
+    }
+    QVERIFY(qAbs(model.coefficient(0)) <= powercalibration::maxOffset);
+    for (uint8_t i = 1; i < powercalibration::features; i++) {
+        QVERIFY(qAbs(model.coefficient(i)) <= powercalibration::maxGain);
+    }
+
+    // hours at the same cadence and resistance: without excitation P would grow without limit
+    model.reset();
+    for (int i = 0; i < 100000; i++) {
+        model.addSample(80, 20, 250);
+    }
+    for (uint8_t i = 0; i < powercalibration::features; i++) {
+        QVERIFY(qIsFinite(model.variance(i)));
+        QVERIFY(model.variance(i) <= powercalibration::maxVariance);
+        QVERIFY(model.variance(i) >= powercalibration::minVariance);
+    }
+    // so a different sample doesn't throw away what was learnt
+    QVERIFY(model.addSample(100, 40, 400));
+    QVERIFY(qAbs(model.predict(80, 20) - 250.0) < 5.0);
+}
+
+// a model saved before the limits is clamped when it's loaded
+void unit::powerCalibrationLoadBounds() {
+    QVariantList saved = {500, 5000.0, -1e6, 1e6, 10.0};
+    for (uint8_t i = 0; i < powercalibration::features; i++) {
+        for (uint8_t j = 0; j < powercalibration::features; j++) {
+            saved.append(i == j ? 1e9 : 0.0);
+        }
+    }
+    QSettings().setValue(QStringLiteral("power_calibration_model/unit"), saved);
+
+    powercalibration model;
+    QVERIFY(model.load(QStringLiteral("unit")));
+    QCOMPARE(model.samples(), uint32_t(500));
+    QCOMPARE(model.coefficient(0), powercalibration::maxOffset);
+    QCOMPARE(model.coefficient(1), -powercalibration::maxGain);
+    QCOMPARE(model.coefficient(2), powercalibration::maxGain);
+    QCOMPARE(model.coefficient(3), 10.0);
+    for (uint8_t i = 0; i < powercalibration::features; i++) {
+        QVERIFY(qFuzzyCompare(model.variance(i), powercalibration::maxVariance));
+    }
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    // not the settings of the app
+    app.setOrganizationName(QStringLiteral("qdomyos-zwift-unit"));
+    app.setApplicationName(QStringLiteral("qdomyos-zwift-unit"));
+    unit test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "unit.moc"
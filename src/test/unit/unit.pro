@@ -0,0 +1,17 @@
+# QtTest unit tests of the core classes, on the headless bridge like the benchmarks.
+#
+# cd src/test/unit
+# qmake
+# make
+# ./qdomyos-zwift-unit
+
+include($$PWD/../../bridge/qdomyos-zwift-bridge.pro)
+
+TARGET = qdomyos-zwift-unit
+QT += testlib
+CONFIG += console testcase
+
+SOURCES -= main.cpp
+SOURCES += $$PWD/unit.cpp
+
+target.path = /opt/$${TARGET}/bin
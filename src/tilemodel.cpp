@@ -0,0 +1,123 @@
+#include "tilemodel.h"
+#include "homeform.h"
+#include <QTimer>
+
+void tilemodel::setTiles(const QList<QObject *> &tiles) {
+    beginResetModel();
+    for (DataObject *tile : qAsConst(m_tiles)) {
+        tile->m_model = nullptr;
+    }
+    m_tiles.clear();
+    m_rows.clear();
+    for (QObject *o : tiles) {
+        DataObject *tile = static_cast<DataObject *>(o);
+        tile->m_model = this;
+        m_rows.insert(tile, m_tiles.count());
+        m_tiles.append(tile);
+    }
+    dirtyFirst = dirtyLast = -1;
+    dirtyRoles.clear();
+    endResetModel();
+}
+
+void tilemodel::markDirty(DataObject *tile, int role) {
+    const int row = m_rows.value(tile, -1);
+    if (row < 0) {
+        return;
+    }
+    if (dirtyFirst < 0) {
+        dirtyFirst = dirtyLast = row;
+        QTimer::singleShot(0, this, &tilemodel::flush);
+    } else {
+        dirtyFirst = qMin(dirtyFirst, row);
+        dirtyLast = qMax(dirtyLast, row);
+    }
+    dirtyRoles.insert(role);
+}
+
+void tilemodel::flush() {
+    if (dirtyFirst < 0) {
+        return;
+    }
+    QVector<int> roles;
+    roles.reserve(dirtyRoles.count());
+    for (int r : qAsConst(dirtyRoles)) {
+        roles.append(r);
+    }
+    const QModelIndex first = index(dirtyFirst), last = index(dirtyLast);
+    dirtyFirst = dirtyLast = -1;
+    dirtyRoles.clear();
+    emit dataChanged(first, last, roles);
+}
+
+int tilemodel::rowCount(const QModelIndex &parent) const { return parent.isValid() ? 0 : m_tiles.count(); }
+
+QVariant tilemodel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= m_tiles.count()) {
+        return QVariant();
+    }
+    DataObject *tile = m_tiles.at(index.row());
+    switch (role) {
+    case NameRole:
+        return tile->name();
+    case IconRole:
+        return tile->icon();
+    case ValueRole:
+        // formatted here, so only for the tiles on the screen
+        return tile->value();
+    case SecondLineRole:
+        return tile->secondLine();
+    case ValueFontSizeRole:
+        return tile->valueFontSize();
+    case ValueFontColorRole:
+        return tile->valueFontColor();
+    case LabelFontSizeRole:
+        return tile->labelFontSize();
+    case WritableRole:
+        return tile->writable();
+    case VisibleItemRole:
+        return tile->visibleItem();
+    case PlusNameRole:
+        return tile->plusName();
+    case MinusNameRole:
+        return tile->minusName();
+    case IdentificatorRole:
+        return tile->identificator();
+    case GridIdRole:
+        return tile->gridId();
+    case NumberRole:
+        return qIsNaN(tile->number()) ? QVariant() : QVariant(tile->number());
+    }
+    return QVariant();
+}
+
+QHash<int, QByteArray> tilemodel::roleNames() const {
+    return {
+        {NameRole, "name"},
+        {IconRole, "icon"},
+        {ValueRole, "value"},
+        {SecondLineRole, "secondLine"},
+        {ValueFontSizeRole, "valueFontSize"},
+        {ValueFontColorRole, "valueFontColor"},
+        {LabelFontSizeRole, "labelFontSize"},
+        {WritableRole, "writable"},
+        {VisibleItemRole, "visibleItem"},
+        {PlusNameRole, "plusName"},
+        {MinusNameRole, "minusName"},
+        {IdentificatorRole, "identificator"},
+        {GridIdRole, "gridId"},
+        {NumberRole, "number"},
+    };
+}
+
+QVariantMap tilemodel::get(int row) const {
+    QVariantMap m;
+    if (row < 0 || row >= m_tiles.count()) {
+        return m;
+    }
+    const QHash<int, QByteArray> roles = roleNames();
+    for (auto it = roles.constBegin(); it != roles.constEnd(); ++it) {
+        m.insert(QString::fromLatin1(it.value()), data(index(row), it.key()));
+    }
+    return m;
+}
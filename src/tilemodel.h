@@ -0,0 +1,55 @@
+#ifndef TILEMODEL_H
+#define TILEMODEL_H
+
+#include <QAbstractListModel>
+#include <QHash>
+#include <QList>
+#include <QSet>
+
+class DataObject;
+
+// The tiles of the home page as a single list model.
+// The tiles tell the model what changed and the model sends a single dataChanged, with the union of the rows and of
+// the roles, at the end of the event loop iteration: one per update tick, and none when nothing changed.
+class tilemodel : public QAbstractListModel {
+    Q_OBJECT
+  public:
+    enum ROLES {
+        NameRole = Qt::UserRole + 1,
+        IconRole,
+        ValueRole,
+        SecondLineRole,
+        ValueFontSizeRole,
+        ValueFontColorRole,
+        LabelFontSizeRole,
+        WritableRole,
+        VisibleItemRole,
+        PlusNameRole,
+        MinusNameRole,
+        IdentificatorRole,
+        GridIdRole,
+        NumberRole, // the value as a number, undefined for the text tiles
+    };
+
+    explicit tilemodel(QObject *parent = nullptr) : QAbstractListModel(parent) {}
+
+    void setTiles(const QList<QObject *> &tiles);
+    void markDirty(DataObject *tile, int role);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+    // all the roles of a tile, by their names
+    Q_INVOKABLE QVariantMap get(int row) const;
+
+  private:
+    QList<DataObject *> m_tiles;
+    QHash<DataObject *, int> m_rows;
+    int dirtyFirst = -1;
+    int dirtyLast = -1;
+    QSet<int> dirtyRoles;
+
+    void flush();
+};
+
+#endif // TILEMODEL_H
@@ -0,0 +1,226 @@
+#include "timeseriesinfosender.h"
+#include "appdir.h"
+#include "qdebugfixup.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+
+TimeSeriesInfoSender::TimeSeriesInfoSender(const QString &id, QObject *parent) : TcpClientInfoSender(id, parent) {}
+
+TimeSeriesInfoSender::~TimeSeriesInfoSender() {
+    // the samples of the last batch are kept for the next run
+    spoolPending();
+}
+
+static QString escapeLineProtocol(QString s, bool tag) {
+    s.replace(QStringLiteral("\\"), QStringLiteral("\\\\"));
+    if (tag) {
+        s.replace(QStringLiteral(","), QStringLiteral("\\,"));
+        s.replace(QStringLiteral("="), QStringLiteral("\\="));
+        s.replace(QStringLiteral(" "), QStringLiteral("\\ "));
+    } else {
+        s.replace(QStringLiteral("\""), QStringLiteral("\\\""));
+    }
+    return s;
+}
+
+QByteArray TimeSeriesInfoSender::encode(const QJsonObject &workout, const QString &measurement, FORMAT format,
+                                        qint64 msecs) {
+    static const QStringList tags = {QStringLiteral("deviceId"), QStringLiteral("deviceName"),
+                                     QStringLiteral("deviceType")};
+    if (format == NDJSON) {
+        QJsonObject tagObj;
+        for (const QString &tag : tags) {
+            tagObj[tag] = workout.value(tag);
+        }
+        QJsonObject out;
+        out[QStringLiteral("measurement")] = measurement;
+        out[QStringLiteral("time")] = msecs;
+        out[QStringLiteral("tags")] = tagObj;
+        out[QStringLiteral("fields")] = workout;
+        return QJsonDocument(out).toJson(QJsonDocument::Compact) + '\n';
+    }
+
+    // measurement,tag=value,... field=value,... timestamp(ns)
+    QString line = escapeLineProtocol(measurement, true);
+    for (const QString &tag : tags) {
+        QJsonValue v = workout.value(tag);
+        QString s = v.isDouble() ? QString::number(v.toDouble()) : v.toString();
+        if (!s.isEmpty()) {
+            line += QLatin1Char(',') + tag + QLatin1Char('=') + escapeLineProtocol(s, true);
+        }
+    }
+    QChar separator = QLatin1Char(' ');
+    for (auto it = workout.constBegin(); it != workout.constEnd(); ++it) {
+        if (tags.contains(it.key())) {
+            continue;
+        }
+        QString value;
+        switch (it.value().type()) {
+        case QJsonValue::Double:
+            value = QString::number(it.value().toDouble(), 'g', 12);
+            break;
+        case QJsonValue::Bool:
+            value = it.value().toBool() ? QStringLiteral("true") : QStringLiteral("false");
+            break;
+        case QJsonValue::String:
+            value = QLatin1Char('"') + escapeLineProtocol(it.value().toString(), false) + QLatin1Char('"');
+            break;
+        default:
+            continue;
+        }
+        line += separator + escapeLineProtocol(it.key(), true) + QLatin1Char('=') + value;
+        separator = QLatin1Char(',');
+    }
+    line += QLatin1Char(' ') + QString::number(msecs * 1000000LL) + QLatin1Char('\n');
+    return line.toUtf8();
+}
+
+bool TimeSeriesInfoSender::init() {
+    // defaults from the template file, the settings win
+    QString fileFormat = QStringLiteral("influx");
+    measurement = QStringLiteral("workout_measurement_live");
+    int fileBatch = 10;
+    int fileSpoolKb = 8192;
+    const QStringList lines = jscript.split(QLatin1Char('\n'));
+    for (const QString &l : lines) {
+        int idx = l.indexOf(QLatin1Char('='));
+        if (idx <= 0 || l.trimmed().startsWith(QLatin1Char('#'))) {
+            continue;
+        }
+        QString key = l.left(idx).trimmed();
+        QString value = l.mid(idx + 1).trimmed();
+        if (key == QStringLiteral("format")) {
+            fileFormat = value;
+        } else if (key == QStringLiteral("measurement") && !value.isEmpty()) {
+            measurement = value;
+        } else if (key == QStringLiteral("batch")) {
+            fileBatch = value.toInt();
+        } else if (key == QStringLiteral("spool_kb")) {
+            fileSpoolKb = value.toInt();
+        }
+    }
+    QString prefix = QStringLiteral("template_") + templateId;
+    format = settings.value(prefix + QStringLiteral("_format"), fileFormat).toString() == QStringLiteral("ndjson")
+                 ? NDJSON
+                 : LINE_PROTOCOL;
+    batchSize = qMax(1, settings.value(prefix + QStringLiteral("_batch"), fileBatch).toInt());
+    spoolMaxBytes = qMax(64, settings.value(prefix + QStringLiteral("_spool_kb"), fileSpoolKb).toInt()) * 1024LL;
+
+    spoolDir = appdir::getWritableAppDir() + QStringLiteral("spool/") + templateId + QStringLiteral("/");
+    QDir().mkpath(spoolDir);
+    loadSpool();
+    replayLeft = 0;
+
+    if (!TcpClientInfoSender::init()) {
+        return false;
+    }
+    connect(tcpSocket, &QAbstractSocket::connected, this, &TimeSeriesInfoSender::replaySpool);
+    connect(tcpSocket, &QIODevice::bytesWritten, this, &TimeSeriesInfoSender::bytesWritten);
+    return true;
+}
+
+bool TimeSeriesInfoSender::update(const QJsonObject &workout) {
+    if (workout.value(QStringLiteral("deviceId")).toString().isEmpty()) {
+        return true; // no device, nothing to record
+    }
+    pending += encode(workout, measurement, format, QDateTime::currentMSecsSinceEpoch());
+    if (++pendingSamples >= batchSize) {
+        flush();
+    }
+    return true;
+}
+
+void TimeSeriesInfoSender::flush() {
+    if (pending.isEmpty()) {
+        return;
+    }
+    // the spool goes first, so the samples always reach the database in order
+    if (isRunning() && spool.isEmpty() && tcpSocket->write(pending) == pending.size()) {
+        pending.clear();
+        pendingSamples = 0;
+        return;
+    }
+    spoolPending();
+    replaySpool();
+}
+
+void TimeSeriesInfoSender::spoolPending() {
+    if (pending.isEmpty() || spoolDir.isEmpty()) {
+        return;
+    }
+    QString name = QStringLiteral("%1-%2.spool")
+                       .arg(QDateTime::currentMSecsSinceEpoch(), 13, 10, QLatin1Char('0'))
+                       .arg(spoolSeq++ % 1000000, 6, 10, QLatin1Char('0'));
+    QFile f(spoolDir + name);
+    if (!f.open(QIODevice::WriteOnly) || f.write(pending) != pending.size()) {
+        qDebug() << QStringLiteral("TimeSeriesInfoSender: error spooling") << f.fileName() << f.errorString();
+        return;
+    }
+    f.close();
+    spool.append(name);
+    spoolBytes += pending.size();
+    pending.clear();
+    pendingSamples = 0;
+
+    // bounded: the oldest batches are dropped, but never the one being replayed
+    while (spoolBytes > spoolMaxBytes && spool.count() > 1) {
+        int idx = replayLeft > 0 ? 1 : 0;
+        QFileInfo info(spoolDir + spool.at(idx));
+        spoolBytes -= info.size();
+        QFile::remove(info.filePath());
+        spool.removeAt(idx);
+        qDebug() << QStringLiteral("TimeSeriesInfoSender: spool full, dropped") << info.fileName();
+    }
+}
+
+void TimeSeriesInfoSender::loadSpool() {
+    QDir dir(spoolDir);
+    spool = dir.entryList({QStringLiteral("*.spool")}, QDir::Files, QDir::Name);
+    spoolBytes = 0;
+    for (const QString &name : qAsConst(spool)) {
+        spoolBytes += QFileInfo(spoolDir + name).size();
+    }
+    if (!spool.isEmpty()) {
+        qDebug() << QStringLiteral("TimeSeriesInfoSender:") << spool.count() << QStringLiteral("batches to replay");
+    }
+}
+
+void TimeSeriesInfoSender::replaySpool() {
+    // one batch at a time: a batch is removed only when the socket has written all of it
+    while (replayLeft == 0 && !spool.isEmpty() && isRunning()) {
+        QFile f(spoolDir + spool.constFirst());
+        QByteArray data;
+        if (f.open(QIODevice::ReadOnly)) {
+            data = f.readAll();
+            f.close();
+        }
+        if (data.isEmpty()) {
+            spoolBytes -= f.size();
+            f.remove();
+            spool.removeFirst();
+            continue;
+        }
+        if (tcpSocket->write(data) != data.size()) {
+            return; // retried at the next connection
+        }
+        replayLeft = data.size();
+    }
+}
+
+void TimeSeriesInfoSender::bytesWritten(qint64 bytes) {
+    if (replayLeft <= 0) {
+        return;
+    }
+    replayLeft -= bytes;
+    if (replayLeft <= 0) {
+        replayLeft = 0;
+        QFileInfo info(spoolDir + spool.constFirst());
+        spoolBytes -= info.size();
+        QFile::remove(info.filePath());
+        spool.removeFirst();
+        replaySpool();
+    }
+}
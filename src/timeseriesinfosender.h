@@ -0,0 +1,51 @@
+#ifndef TIMESERIESINFOSENDER_H
+#define TIMESERIESINFOSENDER_H
+
+#include "tcpclientinfosender.h"
+#include <QJsonObject>
+#include <QStringList>
+
+// Native telemetry sink for a time series database (InfluxDB/Telegraf socket listener, QuestDB, ...).
+// Every sample is encoded straight from the workout snapshot as InfluxDB line protocol or NDJSON, with its own
+// timestamp, and the samples are written in batches. While the socket is down the batches go to a bounded spool
+// folder (the oldest are dropped when it's full) and they are replayed in order as soon as the socket is back.
+// The template file holds the defaults as key=value lines: format, measurement, batch and spool_kb.
+class TimeSeriesInfoSender : public TcpClientInfoSender {
+    Q_OBJECT
+  public:
+    enum FORMAT { LINE_PROTOCOL, NDJSON };
+
+    TimeSeriesInfoSender(const QString &id, QObject *parent = nullptr);
+    virtual ~TimeSeriesInfoSender();
+    virtual bool needsScript() const { return false; }
+    virtual bool update(const QJsonObject &workout);
+
+    static QByteArray encode(const QJsonObject &workout, const QString &measurement, FORMAT format, qint64 msecs);
+
+  protected:
+    virtual bool init();
+
+  private:
+    FORMAT format = LINE_PROTOCOL;
+    QString measurement;
+    int batchSize = 10;
+    qint64 spoolMaxBytes = 8 * 1024 * 1024;
+
+    QByteArray pending;
+    int pendingSamples = 0;
+
+    QString spoolDir;
+    QStringList spool;
+    qint64 spoolBytes = 0;
+    qint64 replayLeft = 0;
+    int spoolSeq = 0;
+
+    void flush();
+    void spoolPending();
+    void loadSpool();
+  private slots:
+    void replaySpool();
+    void bytesWritten(qint64 bytes);
+};
+
+#endif // TIMESERIESINFOSENDER_H
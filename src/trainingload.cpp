@@ -0,0 +1,104 @@
+#include "trainingload.h"
+#include <QSettings>
+#include <QtMath>
+
+trainingload::trainingload() { reset(); }
+
+void trainingload::reset() {
+    QSettings settings;
+    m_ftp = settings.value(QStringLiteral("ftp"), 200.0).toDouble();
+    if (m_ftp <= 0) {
+        m_ftp = 200.0;
+    }
+    m_wPrime = settings.value(QStringLiteral("w_prime"), 20000.0).toDouble();
+    if (m_wPrime <= 0) {
+        m_wPrime = 20000.0;
+    }
+    heartRest = settings.value(QStringLiteral("heart_rate_resting"), 60.0).toDouble();
+    heartReserve = heartRateMax() - heartRest;
+
+    for (double &r : ring) {
+        r = 0;
+    }
+    ringPos = 0;
+    ringCount = 0;
+    ringSum = 0;
+    bucketEnergy = 0;
+    bucketTime = 0;
+    sum4 = 0;
+    count4 = 0;
+    elapsed = 0;
+    m_trimp = 0;
+    m_wPrimeBalance = m_wPrime;
+}
+
+double trainingload::heartRateMax() {
+    QSettings settings;
+    double maxHeartRate = 220.0 - settings.value(QStringLiteral("age"), 35).toDouble();
+
+    if (settings.value(QStringLiteral("heart_max_override_enable"), false).toBool())
+        maxHeartRate = settings.value(QStringLiteral("heart_max_override_value"), 195).toDouble();
+    if (maxHeartRate == 0) {
+        maxHeartRate = 190.0;
+    }
+    return maxHeartRate;
+}
+
+void trainingload::push(double watts) {
+    ringSum += watts - ring[ringPos];
+    ring[ringPos] = watts;
+    ringPos = (ringPos + 1) % window;
+    if (ringCount < window) {
+        ringCount++;
+    }
+    if (ringCount == window) {
+        const double average = ringSum / window;
+        sum4 += average * average * average * average;
+        count4++;
+    }
+}
+
+void trainingload::sample(double seconds, double watts, double heart) {
+    if (seconds <= 0) {
+        return;
+    }
+    elapsed += seconds;
+
+    // the samples come at the pace of the device: they are split in buckets of 1 s
+    double left = seconds;
+    while (bucketTime + left >= 1.0) {
+        const double part = 1.0 - bucketTime;
+        push(bucketEnergy + watts * part);
+        bucketEnergy = 0;
+        bucketTime = 0;
+        left -= part;
+    }
+    bucketEnergy += watts * left;
+    bucketTime += left;
+
+    // 1.92 is the coefficient of Banister for men, the most common in the literature
+    if (heart > 0 && heartReserve > 0) {
+        const double hrr = qBound(0.0, (heart - heartRest) / heartReserve, 1.0);
+        m_trimp += (seconds / 60.0) * hrr * 0.64 * qExp(1.92 * hrr);
+    }
+
+    if (watts > m_ftp) {
+        m_wPrimeBalance -= (watts - m_ftp) * seconds;
+    } else {
+        m_wPrimeBalance = m_wPrime - (m_wPrime - m_wPrimeBalance) * qExp(-(m_ftp - watts) * seconds / m_wPrime);
+    }
+}
+
+double trainingload::normalizedPower() const {
+    if (!count4) {
+        return 0;
+    }
+    return qPow(sum4 / count4, 0.25);
+}
+
+double trainingload::intensityFactor() const { return normalizedPower() / m_ftp; }
+
+double trainingload::tss() const {
+    const double np = normalizedPower();
+    return (elapsed * np * np) / (m_ftp * m_ftp * 36.0);
+}
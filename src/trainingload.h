@@ -0,0 +1,54 @@
+#ifndef TRAININGLOAD_H
+#define TRAININGLOAD_H
+
+#include <QtGlobal>
+
+// Training load of the workout, fed by update_metrics at every sample: normalized power, intensity factor and TSS
+// against the FTP, Banister TRIMP on the heart rate reserve and Skiba W' balance with the FTP as critical power.
+// The thresholds are read from the settings when the workout starts, so a sample costs O(1) and nothing has to be
+// recomputed at the end of the workout.
+class trainingload {
+  public:
+    trainingload();
+
+    // new workout, with the thresholds of the current settings
+    void reset();
+    void sample(double seconds, double watts, double heart);
+
+    double normalizedPower() const;
+    double intensityFactor() const;
+    double tss() const;
+    double trimp() const { return m_trimp; }
+    double wPrimeBalance() const { return m_wPrimeBalance; } // J
+    double wPrime() const { return m_wPrime; }
+    double ftp() const { return m_ftp; }
+
+    static double heartRateMax();
+
+    static const int window = 30; // s, rolling average of the normalized power
+
+  private:
+    void push(double watts);
+
+    double m_ftp = 200.0;
+    double m_wPrime = 20000.0;
+    double heartRest = 60.0;
+    double heartReserve = 130.0; // max - rest
+
+    // 1 s averages of the last window seconds
+    double ring[window] = {};
+    int ringPos = 0;
+    int ringCount = 0;
+    double ringSum = 0;
+    double bucketEnergy = 0; // J of the second not completed yet
+    double bucketTime = 0;
+
+    double sum4 = 0; // 4th powers of the rolling average, one per second
+    int count4 = 0;
+    double elapsed = 0;
+
+    double m_trimp = 0;
+    double m_wPrimeBalance = 20000.0;
+};
+
+#endif // TRAININGLOAD_H
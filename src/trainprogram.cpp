@@ -1,4 +1,6 @@
 #include "trainprogram.h"
+#include "qfit.h"
+#include "steadyclock.h"
 #include "zwiftworkout.h"
 #include <QFile>
 #include <QtXml/QtXml>
@@ -10,9 +12,14 @@ trainprogram::trainprogram(const QList<trainrow> &rows, bluetooth *b) {
     this->bluetoothManager = b;
     this->rows = rows;
     this->loadedRows = rows;
+    indexRows();
     connect(&timer, SIGNAL(timeout()), this, SLOT(scheduler()));
     timer.setInterval(1s);
     timer.start();
+    // the ramps move their targets between two ticks of the scheduler too
+    connect(&rampTimer, &QTimer::timeout, this, &trainprogram::rampScheduler);
+    rampTimer.setInterval(250ms);
+    rampTimer.start();
 }
 
 QString trainrow::toString() const {
@@ -49,9 +56,48 @@ QString trainrow::toString() const {
     rv += QStringLiteral(" mets = %1").arg(mets);
     rv += QStringLiteral(" latitude = %1").arg(latitude);
     rv += QStringLiteral(" longitude = %1").arg(longitude);
+    rv += QStringLiteral(" power_end = %1").arg(power_end);
+    rv += QStringLiteral(" speed_end = %1").arg(speed_end);
     return rv;
 }
 
+trainrow trainrow::at(double fraction) const {
+    trainrow row = *this;
+    fraction = qBound(0.0, fraction, 1.0);
+    if (power_end != -1 && power != -1) {
+        row.power = qRound(power + (power_end - power) * fraction);
+    }
+    if (speed_end != -1 && speed != -1) {
+        row.speed = speed + (speed_end - speed) * fraction;
+    }
+    return row;
+}
+
+QList<trainrow> trainprogram::expandRamps(const QList<trainrow> &rows) {
+    QList<trainrow> list;
+    for (const trainrow &r : rows) {
+        if (!r.isRamp()) {
+            list.append(r);
+            continue;
+        }
+        const bool distance = r.distance > 0;
+        const int steps = distance ? qRound(r.distance * 1000.0) : QTime(0, 0, 0).secsTo(r.duration);
+        for (int i = 0; i < steps; i++) {
+            trainrow row = r.at(((double)i) / steps);
+            row.power_end = -1;
+            row.speed_end = -1;
+            if (distance) {
+                row.distance = 0.001;
+            } else {
+                row.duration = QTime(0, 0, 1, 0);
+                row.rampDuration = QTime(0, 0, 0).addSecs(steps - i);
+            }
+            list.append(row);
+        }
+    }
+    return list;
+}
+
 uint32_t trainprogram::calculateTimeForRow(int32_t row) {
     if (row >= rows.length())
         return 0;
@@ -63,6 +109,64 @@ uint32_t trainprogram::calculateTimeForRow(int32_t row) {
         return 0;
 }
 
+void trainprogram::indexRows() {
+    rowStarts.resize(rows.count());
+    uint32_t start = 0;
+    for (int32_t i = 0; i < rows.count(); i++) {
+        rowStarts[i] = start;
+        start += calculateTimeForRow(i);
+    }
+}
+
+double trainprogram::currentStepFraction(double subsecond) {
+    const trainrow &row = rows.at(currentStep);
+    if (row.distance > 0) {
+        double distance = currentStepDistance;
+        if (bluetoothManager && bluetoothManager->device()) {
+            distance += bluetoothManager->device()->odometer() - lastOdometer;
+        }
+        return distance / row.distance;
+    }
+
+    uint32_t len = calculateTimeForRow(currentStep);
+    if (!len) {
+        return 0;
+    }
+    // the list is public: index it again if somebody replaced it
+    if (rowStarts.count() != rows.count()) {
+        indexRows();
+    }
+    return (ticks - (int32_t)rowStarts.at(currentStep) + subsecond) / len;
+}
+
+void trainprogram::rampTargets(double subsecond, bool force) {
+    trainrow row = rows.at(currentStep).at(currentStepFraction(subsecond));
+    if (bluetoothManager->device()->deviceType() == bluetoothdevice::TREADMILL) {
+        if (row.forcespeed && row.speed > 0 && qAbs(row.speed - lastRampSpeed) >= 0.1) {
+            qDebug() << QStringLiteral("trainprogram ramp speed ") + QString::number(row.speed);
+            lastRampSpeed = row.speed;
+            emit changeSpeed(row.speed);
+        }
+    } else if (row.power != -1 && (force || row.power != lastRampPower)) {
+        qDebug() << QStringLiteral("trainprogram ramp power ") + QString::number(row.power);
+        lastRampPower = row.power;
+        emit changePower(row.power);
+    }
+}
+
+void trainprogram::rampScheduler() {
+    if (!started || !enabled || currentStep >= rows.length() || !rows.at(currentStep).isRamp() ||
+        !bluetoothManager || !bluetoothManager->device()) {
+        return;
+    }
+    // the scheduler doesn't tick while the device is paused or stopped, and so the ramp waits for it
+    qint64 sinceTick = steadyclock::now() - lastTick;
+    if (!lastTick || sinceTick >= 1000) {
+        return;
+    }
+    rampTargets(sinceTick / 1000.0, false);
+}
+
 uint32_t trainprogram::calculateTimeForRowMergingRamps(int32_t row) {
     if (row >= rows.length())
         return 0;
@@ -100,10 +204,13 @@ void trainprogram::scheduler() {
     }
 
     ticks++;
+    lastTick = steadyclock::now();
 
     // entry point
     if (ticks == 1 && currentStep == 0) {
         currentStepDistance = 0;
+        lastRampPower = rows.at(0).power;
+        lastRampSpeed = rows.at(0).speed;
         if (bluetoothManager->device()->deviceType() == bluetoothdevice::TREADMILL) {
             if (rows.at(0).forcespeed && rows.at(0).speed) {
                 qDebug() << QStringLiteral("trainprogram change speed") + QString::number(rows.at(0).speed);
@@ -194,6 +301,8 @@ void trainprogram::scheduler() {
                 currentStep++;
 
             currentStepDistance = 0;
+            lastRampPower = rows.at(currentStep).power;
+            lastRampSpeed = rows.at(currentStep).speed;
             if (bluetoothManager->device()->deviceType() == bluetoothdevice::TREADMILL) {
                 if (rows.at(currentStep).forcespeed && rows.at(currentStep).speed) {
                     qDebug() << QStringLiteral("trainprogram change speed ") +
@@ -264,7 +373,9 @@ void trainprogram::scheduler() {
             emit stop();
         }
     } else {
-        if (bluetoothManager->device()->deviceType() == bluetoothdevice::TREADMILL) {
+        if (rows.length() > currentStep && rows.at(currentStep).isRamp()) {
+            rampTargets(0, true);
+        } else if (bluetoothManager->device()->deviceType() == bluetoothdevice::TREADMILL) {
 
         } else {
             if (rows.length() > currentStep && rows.at(currentStep).power != -1) {
@@ -294,6 +405,7 @@ void trainprogram::restart() {
     ticks = 0;
     offset = 0;
     currentStep = 0;
+    lastTick = 0;
     started = true;
 }
 
@@ -358,6 +470,12 @@ bool trainprogram::saveXML(const QString &filename, const QList<trainrow> &rows)
             if (row.power >= 0) {
                 stream.writeAttribute(QStringLiteral("power"), QString::number(row.power));
             }
+            if (row.power_end >= 0) {
+                stream.writeAttribute(QStringLiteral("power_end"), QString::number(row.power_end));
+            }
+            if (row.speed_end >= 0) {
+                stream.writeAttribute(QStringLiteral("speed_end"), QString::number(row.speed_end));
+            }
             stream.writeAttribute(QStringLiteral("forcespeed"),
                                   row.forcespeed ? QStringLiteral("1") : QStringLiteral("0"));
             if (row.fanspeed >= 0) {
@@ -384,14 +502,99 @@ bool trainprogram::saveXML(const QString &filename, const QList<trainrow> &rows)
 
 void trainprogram::save(const QString &filename) { saveXML(filename, rows); }
 
-trainprogram *trainprogram::load(const QString &filename, bluetooth *b) {
+trainprogram *trainprogram::load(const QString &filename, bluetooth *b) { return new trainprogram(loadRows(filename), b); }
+
+QList<trainrow> trainprogram::loadRows(const QString &filename) {
     if (!filename.right(3).toUpper().compare(QStringLiteral("ZWO"))) {
 
-        return new trainprogram(zwiftworkout::load(filename), b);
+        return zwiftworkout::load(filename);
+    } else if (!filename.right(3).toUpper().compare(QStringLiteral("FIT"))) {
+
+        return loadFIT(filename);
     } else {
 
-        return new trainprogram(loadXML(filename), b);
+        return loadXML(filename);
+    }
+}
+
+// replays a past activity: consecutive seconds with about the same targets are merged in a single row.
+// Power is the target when the activity has it, otherwise the speed and the inclination are, because on a bike
+// the inclination would be applied as resistance, fighting against the power target
+QList<trainrow> trainprogram::loadFIT(const QString &filename) {
+    QList<trainrow> list;
+    QVector<qfit_point> points = qfit::open(filename);
+    if (points.count() < 2) {
+        return list;
+    }
+
+    bool hasPower = false;
+    for (const qfit_point &p : qAsConst(points)) {
+        if (p.watt) {
+            hasPower = true;
+            break;
+        }
+    }
+
+    const int minRowSeconds = 5;
+    int rowSeconds = 0;
+    double rowPower = 0, rowSpeed = 0, rowInclination = 0;
+    auto closeRow = [&]() {
+        if (!rowSeconds) {
+            return;
+        }
+        trainrow row;
+        row.duration = QTime(0, 0, 0).addSecs(rowSeconds);
+        row.speed = qRound(rowSpeed / rowSeconds * 10.0) / 10.0;
+        row.forcespeed = true;
+        if (hasPower) {
+            row.power = qRound(rowPower / rowSeconds);
+        } else {
+            row.inclination = qRound(rowInclination / rowSeconds * 2.0) / 2.0;
+        }
+        list.append(row);
+        rowSeconds = 0;
+        rowPower = rowSpeed = rowInclination = 0;
+    };
+
+    int back = 0;
+    double inclination = 0;
+    for (int i = 1; i < points.count(); i++) {
+        const qfit_point &p = points.at(i);
+        const uint32_t dt = p.seconds - points.at(i - 1).seconds;
+        if (dt > 10) {
+            // the activity was paused here: the pause is not replayed
+            closeRow();
+            continue;
+        }
+
+        // the grade is evaluated on the last 20 meters at least, the altitude steps are too coarse otherwise
+        while (back < i - 1 && (p.distance - points.at(back + 1).distance) * 1000.0 >= 20.0) {
+            back++;
+        }
+        const double meters = (p.distance - points.at(back).distance) * 1000.0;
+        if (meters >= 10.0) {
+            inclination = qBound(-15.0, (p.altitude - points.at(back).altitude) / meters * 100.0, 15.0);
+        }
+
+        if (rowSeconds >= minRowSeconds) {
+            const double avgPower = rowPower / rowSeconds;
+            const double avgSpeed = rowSpeed / rowSeconds;
+            const double avgInclination = rowInclination / rowSeconds;
+            if ((hasPower && qAbs(p.watt - avgPower) > qMax(10.0, avgPower * 0.05)) ||
+                qAbs(p.speed - avgSpeed) > 0.5 || (!hasPower && qAbs(inclination - avgInclination) > 0.5)) {
+                closeRow();
+            }
+        }
+        rowSeconds += dt;
+        rowPower += p.watt * dt;
+        rowSpeed += p.speed * dt;
+        rowInclination += inclination * dt;
     }
+    closeRow();
+
+    qDebug() << QStringLiteral("trainprogram::loadFIT") << filename << points.count() << QStringLiteral("points")
+             << list.count() << QStringLiteral("rows");
+    return list;
 }
 
 QList<trainrow> trainprogram::loadXML(const QString &filename) {
@@ -461,6 +664,12 @@ QList<trainrow> trainprogram::loadXML(const QString &filename) {
             if (atts.hasAttribute(QStringLiteral("power"))) {
                 row.power = atts.value(QStringLiteral("power")).toInt();
             }
+            if (atts.hasAttribute(QStringLiteral("power_end"))) {
+                row.power_end = atts.value(QStringLiteral("power_end")).toInt();
+            }
+            if (atts.hasAttribute(QStringLiteral("speed_end"))) {
+                row.speed_end = atts.value(QStringLiteral("speed_end")).toDouble();
+            }
             if (atts.hasAttribute(QStringLiteral("maxspeed"))) {
                 row.maxSpeed = atts.value(QStringLiteral("maxspeed")).toInt();
             }
@@ -485,7 +694,7 @@ QTime trainprogram::totalElapsedTime() { return QTime(0, 0, ticks); }
 trainrow trainprogram::currentRow() {
     if (started && !rows.isEmpty()) {
 
-        return rows.at(currentStep);
+        return rows.at(currentStep).at(currentStepFraction(0));
     }
     return trainrow();
 }
@@ -5,6 +5,7 @@
 #include <QObject>
 #include <QTime>
 #include <QTimer>
+#include <QVector>
 
 class trainrow {
   public:
@@ -37,11 +38,17 @@ class trainrow {
     int8_t maxSpeed = -1;
     int32_t power = -1;
     int32_t mets = -1;
-    QTime rampDuration = QTime(0, 0, 0, 0); // QZ split the ramp in 1 second segments. This field will tell you how long
-                                            // is the ramp from this very moment
+    QTime rampDuration = QTime(0, 0, 0, 0); // only in the rows made by trainprogram::expandRamps: how long is the ramp
+                                            // from this very moment
+    // ramp segment: power and speed go linearly from the values above to these ones along the whole row
+    int32_t power_end = -1;
+    double speed_end = -1;
     double latitude = NAN;
     double longitude = NAN;
     QString toString() const;
+    bool isRamp() const { return power_end != -1 || speed_end != -1; }
+    // the targets of the row at this fraction (0..1) of its duration or distance
+    trainrow at(double fraction) const;
 };
 
 class trainprogram : public QObject {
@@ -51,8 +58,13 @@ class trainprogram : public QObject {
     trainprogram(const QList<trainrow> &, bluetooth *b);
     void save(const QString &filename);
     static trainprogram *load(const QString &filename, bluetooth *b);
+    // only the rows, by the extension of the file; no QObject, so it can run on any thread
+    static QList<trainrow> loadRows(const QString &filename);
     static QList<trainrow> loadXML(const QString &filename);
+    static QList<trainrow> loadFIT(const QString &filename);
     static bool saveXML(const QString &filename, const QList<trainrow> &rows);
+    // the ramp segments as rows of 1 second (or 1 meter), for the consumers that don't know the ramps
+    static QList<trainrow> expandRamps(const QList<trainrow> &rows);
     QTime totalElapsedTime();
     QTime currentRowElapsedTime();
     QTime currentRowRemainingTime();
@@ -77,6 +89,9 @@ class trainprogram : public QObject {
     void onTapeStarted();
     void scheduler();
 
+  private slots:
+    void rampScheduler();
+
   signals:
     void start();
     void stop();
@@ -94,6 +109,11 @@ class trainprogram : public QObject {
     uint32_t calculateTimeForRow(int32_t row);
     uint32_t calculateTimeForRowMergingRamps(int32_t row);
     double calculateDistanceForRow(int32_t row);
+    double currentStepFraction(double subsecond);
+    // the second each row starts at, for currentStepFraction at every tick of the ramps
+    void indexRows();
+    QVector<uint32_t> rowStarts;
+    void rampTargets(double subsecond, bool force);
     bluetooth *bluetoothManager;
     bool started = false;
     int32_t ticks = 0;
@@ -102,6 +122,10 @@ class trainprogram : public QObject {
     double lastOdometer = 0;
     double currentStepDistance = 0;
     QTimer timer;
+    QTimer rampTimer;
+    qint64 lastTick = 0;
+    int32_t lastRampPower = -1;
+    double lastRampSpeed = -1;
 };
 
 #endif // TRAINPROGRAM_H
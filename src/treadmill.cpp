@@ -29,8 +29,8 @@ double treadmill::minStepSpeed() { return 0.5; }
 
 void treadmill::update_metrics(bool watt_calc, const double watts) {
 
-    QDateTime current = QDateTime::currentDateTime();
-    double deltaTime = (((double)_lastTimeUpdate.msecsTo(current)) / ((double)1000.0));
+    qint64 current = steadyclock::now();
+    double deltaTime = (((double)(current - _lastTimeUpdate)) / ((double)1000.0));
     QSettings settings;
     bool power_as_treadmill = settings.value(QStringLiteral("power_sensor_as_treadmill"), false).toBool();
 
@@ -62,11 +62,16 @@ void treadmill::update_metrics(bool watt_calc, const double watts) {
         WattKg = 0;
     }
 
+    if (!_firstUpdate && !paused) {
+        m_load.sample(deltaTime, m_watt.value(), currentHeart().value());
+        recordSample();
+    }
     METS = calculateMETS();
     elevationAcc += (currentSpeed().value() / 3600.0) * 1000.0 * (currentInclination().value() / 100.0) * deltaTime;
 
     _lastTimeUpdate = current;
     _firstUpdate = false;
+    publishTelemetry();
 }
 
 uint16_t treadmill::watts(double weight) {
@@ -99,6 +104,8 @@ void treadmill::clearStats() {
     elevationAcc = 0;
     m_watt.clear(false);
     WeightLoss.clear(false);
+    m_load.reset();
+    m_samples.clear();
     WattKg.clear(false);
 
     Inclination.clear(false);
@@ -107,6 +114,7 @@ void treadmill::clearStats() {
 void treadmill::setPaused(bool p) {
 
     paused = p;
+    m_watchdog->setArmed(!p);
     moving.setPaused(p);
     elapsed.setPaused(p);
     Speed.setPaused(p);
@@ -1,4 +1,5 @@
 #include "ultrasportbike.h"
+#include "driverregistry.h"
 #include "ios/lockscreen.h"
 #include "keepawakehelper.h"
 #include "virtualbike.h"
@@ -16,6 +17,11 @@ using namespace std::chrono_literals;
 extern quint8 QZ_EnableDiscoveryCharsAndDescripttors;
 #endif
 
+DRIVERREGISTRY_ADD_QUIET(ultrasportbike,
+                         new ultrasportbike(p.noWriteResistance, p.noHeartService, p.bikeResistanceOffset,
+                                            p.bikeResistanceGain),
+                         QStringLiteral("X-BIKE"));
+
 ultrasportbike::ultrasportbike(bool noWriteResistance, bool noHeartService, uint8_t bikeResistanceOffset,
                                double bikeResistanceGain) {
 #ifdef Q_OS_IOS
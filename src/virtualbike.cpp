@@ -28,13 +28,15 @@ virtualbike::virtualbike(bluetoothdevice *t, bool noWriteResistance, bool noHear
     bool ifit = settings.value(QStringLiteral("virtual_device_ifit"), false).toBool();
 
     if (settings.value("dircon_yes", false).toBool()) {
-        dirconManager = new DirconManager(Bike, bikeResistanceOffset, bikeResistanceGain, this);
+        dirconManager = DirconManager::create(Bike, bikeResistanceOffset, bikeResistanceGain);
+        connect(this, &QObject::destroyed, dirconManager, &QObject::deleteLater);
         connect(dirconManager, SIGNAL(changeInclination(double, double)), this,
                 SIGNAL(changeInclination(double, double)));
         connect(dirconManager, SIGNAL(ftmsCharacteristicChanged(QLowEnergyCharacteristic, QByteArray)), this,
                 SIGNAL(ftmsCharacteristicChanged(QLowEnergyCharacteristic, QByteArray)));
     }
-    if (!settings.value("virtual_device_bluetooth", true).toBool())
+    // a single adapter can't advertise a different identity for every rider of the studio gateway
+    if (!settings.value("virtual_device_bluetooth", true).toBool() || Bike->gatewaySlot() >= 0)
         return;
     notif2AD2 = new CharacteristicNotifier2AD2(Bike, this);
     notif2A63 = new CharacteristicNotifier2A63(Bike, this);
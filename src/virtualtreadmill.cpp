@@ -13,13 +13,15 @@ virtualtreadmill::virtualtreadmill(bluetoothdevice *t, bool noHeartService) {
 
     this->noHeartService = noHeartService;
     if (settings.value("dircon_yes", false).toBool()) {
-        dirconManager = new DirconManager(t, 0, 0, this);
+        dirconManager = DirconManager::create(t, 0, 0);
+        connect(this, &QObject::destroyed, dirconManager, &QObject::deleteLater);
         connect(dirconManager, SIGNAL(changeInclination(double, double)), this,
                 SIGNAL(changeInclination(double, double)));
         connect(dirconManager, SIGNAL(ftmsCharacteristicChanged(QLowEnergyCharacteristic, QByteArray)), this,
                 SIGNAL(ftmsCharacteristicChanged(QLowEnergyCharacteristic, QByteArray)));
     }
-    if (!settings.value("virtual_device_bluetooth", true).toBool())
+    // a single adapter can't advertise a different identity for every rider of the studio gateway
+    if (!settings.value("virtual_device_bluetooth", true).toBool() || t->gatewaySlot() >= 0)
         return;
     notif2AD2 = new CharacteristicNotifier2AD2(t, this);
     notif2ACD = new CharacteristicNotifier2ACD(t, this);
@@ -1,10 +1,52 @@
 #include "webserverinfosender.h"
+#include "steadyclock.h"
+#include <QCborMap>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDirIterator>
+#include <QFileInfo>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QMimeDatabase>
 #include <QNetworkReply>
+#include <QRegularExpression>
 #include <QtWebSockets/QWebSocket>
 
+// gzip framing around the deflate stream of qCompress, which has a 4 bytes size and the zlib header and trailer
+static QByteArray gzipCompress(const QByteArray &data) {
+    static quint32 table[256] = {0};
+    if (!table[1]) {
+        for (quint32 i = 0; i < 256; i++) {
+            quint32 c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+            }
+            table[i] = c;
+        }
+    }
+    quint32 crc = 0xFFFFFFFF;
+    for (char b : data) {
+        crc = table[(crc ^ quint8(b)) & 0xFF] ^ (crc >> 8);
+    }
+    crc ^= 0xFFFFFFFF;
+
+    const QByteArray z = qCompress(data, 9);
+    if (z.size() < 10) {
+        return QByteArray();
+    }
+    QByteArray out("\x1f\x8b\x08\x00\x00\x00\x00\x00\x02\xff", 10);
+    out.append(z.constData() + 6, z.size() - 10);
+    const quint32 size = quint32(data.size());
+    for (int i = 0; i < 4; i++) {
+        out.append(char((crc >> (8 * i)) & 0xFF));
+    }
+    for (int i = 0; i < 4; i++) {
+        out.append(char((size >> (8 * i)) & 0xFF));
+    }
+    return out;
+}
+
 WebServerInfoSender::WebServerInfoSender(const QString &id, QObject *parent) : TemplateInfoSender(id, parent) {
     fetcher = new QNetworkAccessManager(this);
     fetcher->setCookieJar(new QNoCookieJar());
@@ -53,6 +95,92 @@ bool WebServerInfoSender::send(const QString &data) {
         return false;
 }
 
+bool WebServerInfoSender::sendWorkout(const QString &data) {
+    if (isRunning() && !data.isEmpty()) {
+        bool rv = true;
+        for (QWebSocket *client : qAsConst(sendToClients)) {
+            // the subscribed clients get their fields from publish
+            if (!subscriptions.contains(client)) {
+                rv = client->sendTextMessage(data) > 0;
+            }
+        }
+        return rv;
+    } else
+        return false;
+}
+
+bool WebServerInfoSender::handleSubscription(QWebSocket *client, const QByteArray &data) {
+    if (!client || !data.contains("subscribe")) {
+        return false;
+    }
+    QJsonObject obj = QJsonDocument::fromJson(data).object();
+    const QString msg = obj.value(QStringLiteral("msg")).toString();
+    QJsonObject out;
+    if (msg == QStringLiteral("subscribe")) {
+        const QJsonObject content = obj.value(QStringLiteral("content")).toObject();
+        Subscription sub;
+        for (const QJsonValue &f : content.value(QStringLiteral("fields")).toArray()) {
+            if (f.isString() && f.toString() != QStringLiteral("*")) {
+                sub.fields.append(f.toString());
+            }
+        }
+        const double rate =
+            qBound(0.1, content.value(QStringLiteral("rate")).toDouble(1.0), double(maxSubscriptionRate));
+        sub.minInterval = qRound64(1000.0 / rate);
+        sub.cbor = content.value(QStringLiteral("format")).toString() == QStringLiteral("cbor");
+        subscriptions.insert(client, sub);
+
+        QJsonObject ack;
+        ack[QStringLiteral("fields")] = QJsonArray::fromStringList(sub.fields);
+        ack[QStringLiteral("rate")] = 1000.0 / sub.minInterval;
+        ack[QStringLiteral("format")] = sub.cbor ? QStringLiteral("cbor") : QStringLiteral("json");
+        out[QStringLiteral("content")] = ack;
+        out[QStringLiteral("msg")] = QStringLiteral("R_subscribe");
+        qDebug() << QStringLiteral("WebServer subscription") << client << sub.fields << rate << sub.cbor;
+    } else if (msg == QStringLiteral("unsubscribe")) {
+        subscriptions.remove(client);
+        out[QStringLiteral("msg")] = QStringLiteral("R_unsubscribe");
+    } else {
+        return false;
+    }
+    client->sendTextMessage(QJsonDocument(out).toJson(QJsonDocument::Compact));
+    return true;
+}
+
+void WebServerInfoSender::publish(const QJsonObject &workout) {
+    const qint64 now = steadyclock::now();
+    for (auto it = subscriptions.begin(); it != subscriptions.end(); ++it) {
+        Subscription &sub = it.value();
+        if (sub.lastSent && now - sub.lastSent < sub.minInterval) {
+            continue;
+        }
+        // only what changed since the last frame
+        QJsonObject delta;
+        const QStringList fields = sub.fields.isEmpty() ? workout.keys() : sub.fields;
+        for (const QString &f : fields) {
+            const QJsonValue v = workout.value(f);
+            if (v != sub.last.value(f)) {
+                delta.insert(f, v);
+                sub.last.insert(f, v);
+            }
+        }
+        if (delta.isEmpty()) {
+            continue;
+        }
+        sub.lastSent = now;
+
+        QJsonObject frame;
+        frame[QStringLiteral("t")] = QDateTime::currentMSecsSinceEpoch();
+        frame[QStringLiteral("d")] = delta;
+        if (sub.cbor) {
+            it.key()->sendBinaryMessage(QCborMap::fromJsonObject(frame).toCborValue().toCbor());
+        } else {
+            frame[QStringLiteral("msg")] = QStringLiteral("live");
+            it.key()->sendTextMessage(QJsonDocument(frame).toJson(QJsonDocument::Compact));
+        }
+    }
+}
+
 void WebServerInfoSender::innerStop() {
     if (innerTcpServer) {
         if (isRunning())
@@ -60,6 +188,7 @@ void WebServerInfoSender::innerStop() {
         httpServer->deleteLater();
         clients.clear();
         sendToClients.clear();
+        subscriptions.clear();
         reply2Req.clear();
         innerTcpServer = 0;
         httpServer = 0;
@@ -78,6 +207,7 @@ bool WebServerInfoSender::init() {
         if (!httpServer)
             httpServer = new QHttpServer(this);
         relative2Absolute.clear();
+        assets.clear();
         for (auto fld : folders) {
             idx = fld.lastIndexOf('/');
             qDebug() << QStringLiteral("Folder") << fld;
@@ -92,16 +222,17 @@ bool WebServerInfoSender::init() {
                                       int idxreq = path.indexOf('/');
                                       QString reqId = idxreq < 0 ? path : path.mid(0, idxreq);
                                       qDebug() << QStringLiteral("Path") << path << QStringLiteral("req") << reqId;
-                                      path = relative2Absolute.value(reqId);
-                                      if (path.isEmpty())
+                                      QString folder = relative2Absolute.value(reqId);
+                                      path = QDir::cleanPath(folder + QStringLiteral("/%1").arg(url.path()));
+                                      if (folder.isEmpty() || !path.startsWith(QDir::cleanPath(folder) + '/'))
                                           return QHttpServerResponse("text/plain", "Unautorized",
                                                                      QHttpServerResponder::StatusCode::Forbidden);
                                       else {
-                                          path += QStringLiteral("/%1").arg(url.path());
                                           qDebug() << "File to look at:" << path;
-                                          return QHttpServerResponse::fromFile(path);
+                                          return assetResponse(path, request);
                                       }
                                   });
+                cacheFolder(fld);
             }
         }
         if (listen()) {
@@ -116,6 +247,111 @@ bool WebServerInfoSender::init() {
     return false;
 }
 
+void WebServerInfoSender::cacheFolder(const QString &folder) {
+    int count = 0;
+    qint64 bytes = 0;
+    QDirIterator it(folder, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        const Asset *a = cachedAsset(QDir::cleanPath(it.next()));
+        if (a) {
+            count++;
+            bytes += a->data.size() + a->gzip.size() + a->brotli.size();
+        }
+    }
+    qDebug() << QStringLiteral("WebServer cached") << count << QStringLiteral("files of") << folder << bytes
+             << QStringLiteral("bytes");
+}
+
+const WebServerInfoSender::Asset *WebServerInfoSender::cachedAsset(const QString &path) {
+    // a stat for every request: the templates can be changed on the disk while the server runs
+    QFileInfo info(path);
+    if (!info.isFile() || info.size() > maxAssetSize || path.endsWith(QStringLiteral(".br"))) {
+        assets.remove(path);
+        return nullptr;
+    }
+    const qint64 mtime = info.lastModified().toMSecsSinceEpoch();
+    auto i = assets.constFind(path);
+    if (i != assets.constEnd() && i->mtime == mtime && i->size == info.size()) {
+        return &i.value();
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return nullptr;
+    }
+    Asset a;
+    a.data = file.readAll();
+    a.mtime = mtime;
+    a.size = info.size();
+    static QMimeDatabase mimeDb;
+    const QMimeType mime = mimeDb.mimeTypeForFileNameAndData(path, a.data);
+    a.mime = mime.name().toUtf8();
+    a.etag = '"' + QCryptographicHash::hash(a.data, QCryptographicHash::Sha1).toHex().left(32) + '"';
+    if (mime.inherits(QStringLiteral("text/plain")) || mime.name().contains(QStringLiteral("javascript")) ||
+        mime.name().contains(QStringLiteral("json")) || mime.name().contains(QStringLiteral("xml")) ||
+        mime.name() == QStringLiteral("image/svg+xml")) {
+        a.gzip = gzipCompress(a.data);
+        if (a.gzip.size() > a.data.size() * 9 / 10) {
+            a.gzip.clear();
+        }
+    }
+    QFile br(path + QStringLiteral(".br"));
+    if (br.open(QIODevice::ReadOnly)) {
+        a.brotli = br.readAll();
+    }
+    // the libraries bundled in the resources have the version or .min in the name and never change. The rest,
+    // and everything in a user folder (a file there can be replaced keeping its name), is revalidated every time,
+    // which costs a 304 thanks to the etag
+    static const QRegularExpression versioned(QStringLiteral("(\\.min\\.|[-.]\\d+\\.\\d+)"));
+    a.cacheControl = path.startsWith(QStringLiteral(":/")) && versioned.match(info.fileName()).hasMatch()
+                         ? QByteArrayLiteral("public, max-age=31536000, immutable")
+                         : QByteArrayLiteral("no-cache");
+    return &assets.insert(path, a).value();
+}
+
+QHttpServerResponse WebServerInfoSender::assetResponse(const QString &path, const QHttpServerRequest &request) {
+    const Asset *a = cachedAsset(path);
+    if (!a) {
+        return QHttpServerResponse(QHttpServerResponder::StatusCode::NotFound);
+    }
+
+    QByteArray ifNoneMatch, acceptEncoding;
+    const QVariantMap headers = request.headers();
+    for (auto i = headers.constBegin(); i != headers.constEnd(); ++i) {
+        if (!i.key().compare(QStringLiteral("If-None-Match"), Qt::CaseInsensitive)) {
+            ifNoneMatch = i.value().toByteArray();
+        } else if (!i.key().compare(QStringLiteral("Accept-Encoding"), Qt::CaseInsensitive)) {
+            acceptEncoding = i.value().toByteArray();
+        }
+    }
+
+    if (!ifNoneMatch.isEmpty() && (ifNoneMatch.contains(a->etag) || ifNoneMatch.trimmed() == "*")) {
+        QHttpServerResponse notModified(QHttpServerResponder::StatusCode::NotModified);
+        notModified.addHeader(QByteArrayLiteral("ETag"), a->etag);
+        notModified.addHeader(QByteArrayLiteral("Cache-Control"), a->cacheControl);
+        notModified.addHeader(QByteArrayLiteral("Vary"), QByteArrayLiteral("Accept-Encoding"));
+        return notModified;
+    }
+
+    QByteArray encoding;
+    const QByteArray *body = &a->data;
+    if (!a->brotli.isEmpty() && acceptEncoding.contains("br")) {
+        encoding = QByteArrayLiteral("br");
+        body = &a->brotli;
+    } else if (!a->gzip.isEmpty() && acceptEncoding.contains("gzip")) {
+        encoding = QByteArrayLiteral("gzip");
+        body = &a->gzip;
+    }
+    QHttpServerResponse response(a->mime, *body);
+    response.addHeader(QByteArrayLiteral("ETag"), a->etag);
+    response.addHeader(QByteArrayLiteral("Cache-Control"), a->cacheControl);
+    response.addHeader(QByteArrayLiteral("Vary"), QByteArrayLiteral("Accept-Encoding"));
+    if (!encoding.isEmpty()) {
+        response.addHeader(QByteArrayLiteral("Content-Encoding"), encoding);
+    }
+    return response;
+}
+
 void WebServerInfoSender::watchdogEvent() {
     if(innerTcpServer && !innerTcpServer->isListening()) {
         qDebug() << QStringLiteral("innerTcpServer is not LISTENING!");
@@ -167,6 +403,9 @@ void WebServerInfoSender::processTextMessage(QString message) {
         pClient->sendTextMessage(message);
     }*/
     qDebug() << QStringLiteral("Message received:") << message;
+    if (handleSubscription(qobject_cast<QWebSocket *>(sender()), message.toUtf8())) {
+        return;
+    }
     emit onDataReceived(message.toUtf8());
 }
 
@@ -236,6 +475,7 @@ void WebServerInfoSender::socketDisconnected() {
     qDebug() << QStringLiteral("socketDisconnected:") << pClient;
     if (pClient) {
         clients.removeAll(pClient);
+        subscriptions.remove(pClient);
         if (!sendToClients.removeAll(pClient)) {
             QMutableHashIterator<QNetworkReply *, QPair<QJsonObject, QWebSocket *>> i(reply2Req);
             while (i.hasNext()) {
@@ -256,5 +496,8 @@ void WebServerInfoSender::processBinaryMessage(QByteArray message) {
         pClient->sendBinaryMessage(message);
     }*/
     qDebug() << QStringLiteral("Binary Message received:") << message.toHex();
+    if (handleSubscription(qobject_cast<QWebSocket *>(sender()), message)) {
+        return;
+    }
     emit onDataReceived(message);
 }
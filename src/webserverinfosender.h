@@ -23,16 +23,49 @@ class WebServerInfoSender : public TemplateInfoSender {
     virtual ~WebServerInfoSender();
     virtual bool isRunning() const;
     virtual bool send(const QString &data);
+    virtual bool hasSubscribers() const { return !subscriptions.isEmpty(); }
+    virtual void publish(const QJsonObject &workout);
+
+    static const int maxSubscriptionRate = 10; // Hz, the rate of the live snapshot
 
   private:
+    // a client asking only some fields of the workout, and only when they change
+    struct Subscription {
+        QStringList fields; // empty: all of them
+        qint64 minInterval = 1000;
+        bool cbor = false;
+        qint64 lastSent = 0;
+        QJsonObject last;
+    };
+    QHash<QWebSocket *, Subscription> subscriptions;
+    bool handleSubscription(QWebSocket *client, const QByteArray &data);
+
+    // a file of the template folders, kept in memory with its compressed variants
+    struct Asset {
+        QByteArray mime;
+        QByteArray data;
+        QByteArray gzip;   // empty if it doesn't compress
+        QByteArray brotli; // only if a .br file is next to it
+        QByteArray etag;
+        QByteArray cacheControl;
+        qint64 mtime = 0;
+        qint64 size = 0;
+    };
+    static const qint64 maxAssetSize = 4 * 1024 * 1024;
+
     QHttpServer *httpServer = 0;
     QStringList folders;
+    QHash<QString, Asset> assets;
     bool listen();
+    void cacheFolder(const QString &folder);
+    const Asset *cachedAsset(const QString &path);
+    QHttpServerResponse assetResponse(const QString &path, const QHttpServerRequest &request);
     void processFetcher(QWebSocket *sender, const QByteArray &data);
     QTimer watchdogTimer;
 
   protected:
     virtual void innerStop();
+    virtual bool sendWorkout(const QString &data);
     int port;
     QTcpServer *innerTcpServer = 0;
     virtual bool init();
@@ -0,0 +1,76 @@
+#include "workoutchart.h"
+
+workoutchart::CHANNEL workoutchart::channelFromName(const QString &name) {
+    if (name == QStringLiteral("heart"))
+        return HEART;
+    if (name == QStringLiteral("cadence"))
+        return CADENCE;
+    if (name == QStringLiteral("resistance"))
+        return RESISTANCE;
+    if (name == QStringLiteral("peloton_resistance"))
+        return PELOTON_RESISTANCE;
+    if (name == QStringLiteral("speed"))
+        return SPEED;
+    return WATT;
+}
+
+double workoutchart::value(const SessionLine &s, CHANNEL channel) {
+    switch (channel) {
+    case HEART:
+        return s.heart;
+    case CADENCE:
+        return s.cadence;
+    case RESISTANCE:
+        return s.resistance;
+    case PELOTON_RESISTANCE:
+        return s.peloton_resistance;
+    case SPEED:
+        return s.speed;
+    default:
+        return s.watt;
+    }
+}
+
+QVector<QPointF> workoutchart::points(const QList<SessionLine> &session, CHANNEL channel, int buckets) {
+    QVector<QPointF> out;
+    const int n = session.count();
+    if (!n) {
+        return out;
+    }
+    if (buckets <= 0 || n <= buckets * 2) {
+        out.reserve(n);
+        for (int i = 0; i < n; i++) {
+            out.append(QPointF(i * 1000.0, value(session.at(i), channel)));
+        }
+        return out;
+    }
+
+    out.reserve(buckets * 2);
+    for (int b = 0; b < buckets; b++) {
+        const int start = int(qint64(b) * n / buckets);
+        const int end = int(qint64(b + 1) * n / buckets);
+        int minI = start, maxI = start;
+        double minV = value(session.at(start), channel);
+        double maxV = minV;
+        for (int i = start + 1; i < end; i++) {
+            const double v = value(session.at(i), channel);
+            if (v < minV) {
+                minV = v;
+                minI = i;
+            } else if (v > maxV) {
+                maxV = v;
+                maxI = i;
+            }
+        }
+        if (minI == maxI) {
+            out.append(QPointF(minI * 1000.0, minV));
+        } else if (minI < maxI) {
+            out.append(QPointF(minI * 1000.0, minV));
+            out.append(QPointF(maxI * 1000.0, maxV));
+        } else {
+            out.append(QPointF(maxI * 1000.0, maxV));
+            out.append(QPointF(minI * 1000.0, minV));
+        }
+    }
+    return out;
+}
@@ -0,0 +1,25 @@
+#ifndef WORKOUTCHART_H
+#define WORKOUTCHART_H
+
+#include "sessionline.h"
+#include <QList>
+#include <QPointF>
+#include <QString>
+#include <QVector>
+
+// Builds the end of workout chart series straight from the session, in a single pass per channel.
+// The series is decimated to the chart width keeping, for every bucket, its minimum and its maximum in time order,
+// so the peaks of a long session are still visible while the chart gets at most 2 points per pixel.
+class workoutchart {
+  public:
+    enum CHANNEL { WATT, HEART, CADENCE, RESISTANCE, PELOTON_RESISTANCE, SPEED };
+
+    static CHANNEL channelFromName(const QString &name);
+    // x is the elapsed time in milliseconds, as the DateTimeAxis of the charts expects
+    static QVector<QPointF> points(const QList<SessionLine> &session, CHANNEL channel, int buckets);
+
+  private:
+    static double value(const SessionLine &s, CHANNEL channel);
+};
+
+#endif // WORKOUTCHART_H
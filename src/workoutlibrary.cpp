@@ -0,0 +1,322 @@
+#include "workoutlibrary.h"
+#include "appdir.h"
+#include "qdebugfixup.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QSet>
+#include <QSettings>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QUrl>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+workoutlibrary *workoutlibrary::instance() {
+    static workoutlibrary *library = nullptr;
+    if (!library) {
+        library = new workoutlibrary(appdir::getWritableAppDir() + QStringLiteral("training/"),
+                                     appdir::getWritableAppDir() + QStringLiteral("workoutlibrary.sqlite"),
+                                     QCoreApplication::instance());
+    }
+    return library;
+}
+
+workoutlibrary::workoutlibrary(const QString &folder, const QString &filename, QObject *parent)
+    : QObject(parent), m_folder(folder), m_filename(filename) {
+    m_connection = QStringLiteral("workoutlibrary");
+    worker = new QObject();
+    worker->moveToThread(&thread);
+    connect(&thread, &QThread::finished, worker, &QObject::deleteLater);
+    thread.setObjectName(QStringLiteral("workoutlibrary"));
+    thread.start(QThread::LowPriority);
+    runOnWorker([this]() { open(); });
+
+    connect(&watcher, &QFileSystemWatcher::directoryChanged, this, &workoutlibrary::refresh);
+    watchFolders();
+    refresh();
+}
+
+workoutlibrary::~workoutlibrary() {
+    QMetaObject::invokeMethod(
+        worker,
+        [this]() {
+            QSqlDatabase::database(m_connection, false).close();
+            QSqlDatabase::removeDatabase(m_connection);
+        },
+        Qt::BlockingQueuedConnection);
+    thread.quit();
+    thread.wait();
+}
+
+void workoutlibrary::runOnWorker(const std::function<void()> &f) {
+    QMetaObject::invokeMethod(worker, f, Qt::QueuedConnection);
+}
+
+bool workoutlibrary::open() {
+    QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), m_connection);
+    db.setDatabaseName(m_filename);
+    if (!db.open()) {
+        qDebug() << QStringLiteral("workoutlibrary: unable to open") << m_filename << db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery q(db);
+    q.exec(QStringLiteral("PRAGMA journal_mode=WAL"));
+    q.exec(QStringLiteral("PRAGMA synchronous=NORMAL"));
+    if (!q.exec(QStringLiteral("CREATE TABLE IF NOT EXISTS workouts (path TEXT PRIMARY KEY, mtime INTEGER, "
+                               "size INTEGER, ftp REAL, duration INTEGER, distance REAL, tss REAL, intensity REAL, "
+                               "power INTEGER, profile BLOB)"))) {
+        qDebug() << QStringLiteral("workoutlibrary: schema error") << q.lastError().text();
+        return false;
+    }
+
+    if (q.exec(QStringLiteral("SELECT path, mtime, size, ftp, duration, distance, tss, intensity, power, profile "
+                              "FROM workouts"))) {
+        while (q.next()) {
+            workout w;
+            w.path = q.value(0).toString();
+            w.mtime = q.value(1).toLongLong();
+            w.size = q.value(2).toLongLong();
+            w.ftp = q.value(3).toDouble();
+            w.duration = q.value(4).toInt();
+            w.distance = q.value(5).toDouble();
+            w.tss = q.value(6).toDouble();
+            w.intensity = q.value(7).toDouble();
+            w.power = q.value(8).toBool();
+            const QByteArray profile = q.value(9).toByteArray();
+            w.profile.resize(profile.size() / sizeof(float));
+            memcpy(w.profile.data(), profile.constData(), w.profile.size() * sizeof(float));
+            index.insert(w.path, w);
+        }
+    }
+    qDebug() << QStringLiteral("workoutlibrary: cached workouts") << index.count();
+    return true;
+}
+
+void workoutlibrary::refresh() {
+    if (m_indexing) {
+        m_pending = true;
+        return;
+    }
+    m_indexing = true;
+    emit indexingChanged(true);
+
+    QSettings settings;
+    double ftp = settings.value(QStringLiteral("ftp"), 200.0).toDouble();
+    if (ftp <= 0) {
+        ftp = 200.0;
+    }
+    runOnWorker([this, ftp]() { scan(ftp); });
+}
+
+void workoutlibrary::scan(double ftp) {
+    QSqlDatabase db = QSqlDatabase::database(m_connection, false);
+    const QDir root(m_folder);
+    QSet<QString> seen;
+    int parsed = 0;
+
+    db.transaction();
+    QSqlQuery q(db);
+    QDirIterator it(m_folder, {QStringLiteral("*.xml"), QStringLiteral("*.zwo"), QStringLiteral("*.fit")},
+                    QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        const QString path = it.next();
+        const QFileInfo info = it.fileInfo();
+        seen.insert(path);
+
+        auto cached = index.constFind(path);
+        const qint64 mtime = info.lastModified().toMSecsSinceEpoch();
+        if (cached != index.constEnd() && cached->mtime == mtime && cached->size == info.size() &&
+            cached->ftp == ftp) {
+            continue;
+        }
+
+        workout w = describe(trainprogram::loadRows(path), ftp);
+        w.path = path;
+        w.mtime = mtime;
+        w.size = info.size();
+        w.ftp = ftp;
+        index.insert(path, w);
+        parsed++;
+
+        q.prepare(QStringLiteral("INSERT OR REPLACE INTO workouts (path, mtime, size, ftp, duration, distance, tss, "
+                                 "intensity, power, profile) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"));
+        q.addBindValue(w.path);
+        q.addBindValue(w.mtime);
+        q.addBindValue(w.size);
+        q.addBindValue(w.ftp);
+        q.addBindValue(w.duration);
+        q.addBindValue(w.distance);
+        q.addBindValue(w.tss);
+        q.addBindValue(w.intensity);
+        q.addBindValue(w.power);
+        q.addBindValue(QByteArray(reinterpret_cast<const char *>(w.profile.constData()),
+                                  w.profile.size() * sizeof(float)));
+        q.exec();
+    }
+
+    for (auto i = index.begin(); i != index.end();) {
+        if (seen.contains(i.key())) {
+            ++i;
+            continue;
+        }
+        q.prepare(QStringLiteral("DELETE FROM workouts WHERE path = ?"));
+        q.addBindValue(i.key());
+        q.exec();
+        i = index.erase(i);
+    }
+    db.commit();
+
+    QVector<workout> list;
+    list.reserve(index.count());
+    for (const workout &w : qAsConst(index)) {
+        list.append(w);
+        list.last().name = root.relativeFilePath(w.path);
+        list.last().name.chop(QFileInfo(w.path).suffix().length() + 1);
+    }
+    qDebug() << QStringLiteral("workoutlibrary: indexed") << list.count() << QStringLiteral("workouts, parsed")
+             << parsed;
+    QMetaObject::invokeMethod(
+        this, [this, list]() { onScanned(list); }, Qt::QueuedConnection);
+}
+
+void workoutlibrary::onScanned(const QVector<workout> &list) {
+    m_workouts = list;
+    m_indexing = false;
+    watchFolders();
+    emit indexingChanged(false);
+    emit workoutsChanged();
+    if (m_pending) {
+        m_pending = false;
+        refresh();
+    }
+}
+
+void workoutlibrary::watchFolders() {
+    QDir().mkpath(m_folder);
+    QStringList folders = {QDir::cleanPath(m_folder)};
+    QDirIterator it(m_folder, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        folders.append(it.next());
+    }
+    const QStringList watched = watcher.directories();
+    for (const QString &f : qAsConst(folders)) {
+        if (!watched.contains(f)) {
+            watcher.addPath(f);
+        }
+    }
+}
+
+workoutlibrary::workout workoutlibrary::describe(const QList<trainrow> &rows, double ftp) {
+    if (ftp <= 0) {
+        ftp = 200.0;
+    }
+    workout w;
+    QVector<double> watts;
+    QVector<double> speeds;
+    for (const trainrow &row : rows) {
+        int secs = QTime(0, 0, 0).secsTo(row.duration);
+        const double speed = (row.speed > 0 && row.speed_end > 0) ? (row.speed + row.speed_end) / 2.0 : row.speed;
+        if (row.distance > 0) {
+            // the time of the distance rows is known only with a speed target
+            w.distance += row.distance;
+            secs = speed > 0 ? qRound(row.distance / speed * 3600.0) : 0;
+        } else if (speed > 0) {
+            w.distance += secs * speed / 3600.0;
+        }
+        for (int i = 0; i < secs; i++) {
+            const trainrow t = row.at(((double)i) / secs);
+            watts.append(qMax(0, t.power));
+            speeds.append(qMax(0.0, t.speed));
+            if (t.power > 0) {
+                w.power = true;
+            }
+        }
+    }
+    w.duration = watts.count();
+    if (!w.duration) {
+        return w;
+    }
+
+    if (w.power) {
+        // normalized power on the 30 seconds rolling average
+        double rolling = 0, sum4 = 0, sum = 0;
+        int n = 0;
+        for (int i = 0; i < watts.count(); i++) {
+            sum += watts.at(i);
+            rolling += watts.at(i);
+            if (i >= 30) {
+                rolling -= watts.at(i - 30);
+            }
+            if (i >= 29) {
+                sum4 += pow(rolling / 30.0, 4);
+                n++;
+            }
+        }
+        const double np = n ? pow(sum4 / n, 0.25) : sum / watts.count();
+        w.intensity = np / ftp;
+        w.tss = w.duration * np * w.intensity / (ftp * 3600.0) * 100.0;
+    }
+
+    const QVector<double> &series = w.power ? watts : speeds;
+    const int count = series.count();
+    w.profile.resize(profileSize);
+    for (int b = 0; b < profileSize; b++) {
+        const int from = b * count / profileSize;
+        const int to = qMax(from + 1, (b + 1) * count / profileSize);
+        double sum = 0;
+        for (int i = from; i < to; i++) {
+            sum += series.at(i);
+        }
+        w.profile[b] = (sum / (to - from)) / (w.power ? ftp : 1.0);
+    }
+    return w;
+}
+
+QVariantList workoutlibrary::workouts(const QString &sortBy, bool descending) const {
+    QVector<const workout *> sorted;
+    sorted.reserve(m_workouts.count());
+    for (const workout &w : m_workouts) {
+        sorted.append(&w);
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [&sortBy, descending](const workout *a, const workout *b) {
+        if (descending) {
+            std::swap(a, b);
+        }
+        if (sortBy == QStringLiteral("duration")) {
+            return a->duration < b->duration;
+        } else if (sortBy == QStringLiteral("distance")) {
+            return a->distance < b->distance;
+        } else if (sortBy == QStringLiteral("tss")) {
+            return a->tss < b->tss;
+        } else if (sortBy == QStringLiteral("intensity")) {
+            return a->intensity < b->intensity;
+        }
+        return a->name.compare(b->name, Qt::CaseInsensitive) < 0;
+    });
+
+    QVariantList list;
+    list.reserve(sorted.count());
+    for (const workout *w : qAsConst(sorted)) {
+        QVariantMap m;
+        m[QStringLiteral("path")] = w->path;
+        m[QStringLiteral("url")] = QUrl::fromLocalFile(w->path);
+        m[QStringLiteral("name")] = w->name;
+        m[QStringLiteral("duration")] = w->duration;
+        m[QStringLiteral("distance")] = w->distance;
+        m[QStringLiteral("tss")] = w->tss;
+        m[QStringLiteral("intensity")] = w->intensity;
+        m[QStringLiteral("power")] = w->power;
+        QVariantList profile;
+        for (float v : w->profile) {
+            profile.append(v);
+        }
+        m[QStringLiteral("profile")] = profile;
+        list.append(m);
+    }
+    return list;
+}
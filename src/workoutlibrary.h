@@ -0,0 +1,75 @@
+#ifndef WORKOUTLIBRARY_H
+#define WORKOUTLIBRARY_H
+
+#include "trainprogram.h"
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QObject>
+#include <QThread>
+#include <QVariantList>
+#include <QVector>
+#include <functional>
+
+// Index of the workouts in the training folder and in its subfolders.
+// Every file is parsed once on a dedicated thread: its duration, distance, TSS, intensity and a downsampled target
+// profile are cached in a SQLite database with the modification time and the size of the file, so browsing the
+// library never loads a workout. A QFileSystemWatcher keeps the index updated: only the new or changed files are
+// parsed again. The power targets depend on the ftp, so the cache is rebuilt when it changes.
+class workoutlibrary : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(bool indexing READ indexing NOTIFY indexingChanged)
+  public:
+    struct workout {
+        QString path;
+        QString name;
+        qint64 mtime = 0;
+        qint64 size = 0;
+        double ftp = 0;         // used for the power targets
+        int duration = 0;       // seconds
+        double distance = 0;    // km
+        double tss = -1;        // -1 without power targets
+        double intensity = -1;  // -1 without power targets
+        QVector<float> profile; // profileSize power targets relative to the ftp, or speeds without power
+        bool power = false;
+    };
+
+    static workoutlibrary *instance();
+    // the library of the app is instance(), the tests index their own folder
+    explicit workoutlibrary(const QString &folder, const QString &filename, QObject *parent = nullptr);
+    ~workoutlibrary();
+
+    // maps with path, url, name, duration, distance, tss, intensity, power and profile, sorted by name, duration,
+    // distance, tss or intensity
+    Q_INVOKABLE QVariantList workouts(const QString &sortBy = QStringLiteral("name"), bool descending = false) const;
+    Q_INVOKABLE void refresh();
+    bool indexing() const { return m_indexing; }
+
+    // ftp <= 0 is replaced by 200, like in trainingload
+    static workout describe(const QList<trainrow> &rows, double ftp);
+    static const int profileSize = 48;
+
+  signals:
+    void workoutsChanged();
+    void indexingChanged(bool indexing);
+
+  private:
+    QThread thread;
+    QObject *worker = nullptr;
+    QString m_folder;
+    QString m_filename;
+    QString m_connection;
+    QFileSystemWatcher watcher;
+    bool m_indexing = false;
+    bool m_pending = false;
+
+    QVector<workout> m_workouts;   // owned by the main thread
+    QHash<QString, workout> index; // owned by the worker
+
+    void runOnWorker(const std::function<void()> &f);
+    bool open();
+    void scan(double ftp);
+    void watchFolders();
+    void onScanned(const QVector<workout> &list);
+};
+
+#endif // WORKOUTLIBRARY_H
@@ -1,4 +1,5 @@
 #include "yesoulbike.h"
+#include "driverregistry.h"
 #include "ios/lockscreen.h"
 #include "keepawakehelper.h"
 #include "virtualbike.h"
@@ -12,6 +13,8 @@
 
 using namespace std::chrono_literals;
 
+DRIVERREGISTRY_ADD(yesoulbike, new yesoulbike(p.noWriteResistance, p.noHeartService), QStringLiteral("YESOUL"));
+
 yesoulbike::yesoulbike(bool noWriteResistance, bool noHeartService) {
     m_watt.setType(metric::METRIC_WATT);
     Speed.setType(metric::METRIC_SPEED);
@@ -112,32 +112,22 @@ void zwiftworkout::convertTag(double thresholdSecPerKm, const QString &sportType
         PowerLow = va_arg(args, double);
         PowerHigh = va_arg(args, double);
         Pace = va_arg(args, int);
-        for (uint32_t i = 0; i < Duration; i++) {
+        // a single segment: trainprogram interpolates the targets along it
+        if (Duration) {
             trainrow row;
             if (!durationAsDistance(sportType, durationType)) {
-                row.duration = QTime(0, 0, 1, 0);
-                row.rampDuration = QTime((Duration - i) / 3600, (Duration - i) / 60, (Duration - i) % 60, 0);
+                row.duration = QTime(Duration / 3600, (Duration / 60) % 60, Duration % 60, 0);
             } else {
-                row.distance = 0.001;
+                row.distance = Duration / 1000.0;
             }
-            if (PowerHigh > PowerLow) {
-                if (sportType.toLower().contains(QStringLiteral("run"))) {
-                    row.forcespeed = 1;
-                    double speed = speedFromPace(Pace);
-                    row.speed = ((60.0 / speed) * 60.0) * (PowerLow + (((PowerHigh - PowerLow) / Duration) * i));
-                } else {
-                    row.power = (PowerLow + (((PowerHigh - PowerLow) / Duration) * i)) *
-                                settings.value(QStringLiteral("ftp"), 200.0).toDouble();
-                }
+            if (sportType.toLower().contains(QStringLiteral("run"))) {
+                row.forcespeed = 1;
+                double speed = speedFromPace(Pace);
+                row.speed = ((60.0 / speed) * 60.0) * PowerLow;
+                row.speed_end = ((60.0 / speed) * 60.0) * PowerHigh;
             } else {
-                if (sportType.toLower().contains(QStringLiteral("run"))) {
-                    row.forcespeed = 1;
-                    double speed = speedFromPace(Pace);
-                    row.speed = ((60.0 / speed) * 60.0) * (PowerLow + (((PowerHigh - PowerLow) / Duration) * i));
-                } else {
-                    row.power = (PowerLow - (((PowerLow - PowerHigh) / Duration) * i)) *
-                                settings.value(QStringLiteral("ftp"), 200.0).toDouble();
-                }
+                row.power = PowerLow * settings.value(QStringLiteral("ftp"), 200.0).toDouble();
+                row.power_end = PowerHigh * settings.value(QStringLiteral("ftp"), 200.0).toDouble();
             }
             qDebug() << "TrainRow" << row.toString();
             list.append(row);